@@ -0,0 +1,20 @@
+# If ON, the small BRDFs LUTs (GGX conductor directional albedo) are converted
+# from their .hdr files to constant arrays at build time and compiled in the
+# executable instead of being read from disk when the renderers are created
+option(EMBED_BRDFS_LUTS "Compiles the small BRDFs LUTs in the executable instead of reading them from disk at runtime" OFF)
+
+if (EMBED_BRDFS_LUTS)
+	set(EMBEDDED_BRDFS_LUTS_DIRECTORY ${CMAKE_BINARY_DIR}/generated)
+	set(EMBEDDED_BRDFS_LUTS_HEADER ${EMBEDDED_BRDFS_LUTS_DIRECTORY}/EmbeddedBRDFsLUTs.h)
+	set(GGX_CONDUCTOR_ESS_LUT ${CMAKE_SOURCE_DIR}/data/BRDFsData/GGX/GGX_Conductor_128x128.hdr)
+
+	add_executable(EmbedBRDFsLUTs tools/EmbedBRDFsLUTs/EmbedBRDFsLUTs.cpp)
+	target_include_directories(EmbedBRDFsLUTs PRIVATE "thirdparties/stbi/")
+
+	add_custom_command(OUTPUT ${EMBEDDED_BRDFS_LUTS_HEADER}
+		COMMAND ${CMAKE_COMMAND} -E make_directory ${EMBEDDED_BRDFS_LUTS_DIRECTORY}
+		COMMAND EmbedBRDFsLUTs ${EMBEDDED_BRDFS_LUTS_HEADER} GGX_conductor_Ess_embedded ${GGX_CONDUCTOR_ESS_LUT}
+		DEPENDS EmbedBRDFsLUTs ${GGX_CONDUCTOR_ESS_LUT}
+		COMMENT "Generating embedded BRDFs LUTs...")
+	add_custom_target(EmbeddedBRDFsLUTs DEPENDS ${EMBEDDED_BRDFS_LUTS_HEADER})
+endif()
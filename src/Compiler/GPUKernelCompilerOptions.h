@@ -34,6 +34,7 @@ public:
 	static const std::string RIS_USE_VISIBILITY_TARGET_FUNCTION;
 	static const std::string ENVMAP_SAMPLING_STRATEGY;
 	static const std::string ENVMAP_SAMPLING_DO_BSDF_MIS;
+	static const std::string DIRECT_LIGHT_UNIFIED_SELECTION;
 
 	static const std::string RESTIR_DI_INITIAL_TARGET_FUNCTION_VISIBILITY;
 	static const std::string RESTIR_DI_SPATIAL_TARGET_FUNCTION_VISIBILITY;
@@ -33,7 +33,12 @@ HIPRT_DEVICE HIPRT_INLINE bool filter_function(const hiprtRay&, const void*, voi
 		return false;
 
 	int material_index = payload->render_data->buffers.material_indices[hit.primID];
-	RendererMaterial material = payload->render_data->buffers.materials_buffer[material_index];
+	// Only the hot block of the material, that's all we need for alpha testing
+	const MaterialHotData& material = payload->render_data->buffers.materials_buffer.hot[material_index];
+	if (!material.has_flag(MaterialHotData::MAY_BE_TRANSPARENT))
+		// Fully opaque material, this is the case of most hits so
+		// not going further than the flags of the material
+		return false;
 
 	// Composition both the alpha of the base color texture and the material
 	float base_color_alpha = get_hit_base_color_alpha(*payload->render_data, material, hit);
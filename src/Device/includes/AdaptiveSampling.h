@@ -6,36 +6,132 @@
 #ifndef DEVICE_ADAPTIVE_SAMPLING_H
 #define DEVICE_ADAPTIVE_SAMPLING_H
 
+#include "Device/includes/Hash.h"
 #include "HostDeviceCommon/RenderData.h"
+#include "HostDeviceCommon/Xorshift.h"
 
 HIPRT_HOST_DEVICE HIPRT_INLINE float get_pixel_confidence_interval(const HIPRTRenderData& render_data, int pixel_index, int pixel_sample_count, float& average_luminance)
 {
-    float luminance = render_data.buffers.pixels[pixel_index].luminance();
-    average_luminance = luminance / (pixel_sample_count + 1);
+    if (pixel_sample_count == 0)
+    {
+        average_luminance = 0.0f;
+
+        return 0.0f;
+    }
+
+    float luminance = render_data.aux_buffers.pixel_color_sum[pixel_index].luminance();
+    average_luminance = luminance / pixel_sample_count;
 
     float squared_luminance = render_data.aux_buffers.pixel_squared_luminance[pixel_index];
-    float pixel_variance = (squared_luminance - luminance * average_luminance) / (pixel_sample_count + 1);
+    float pixel_variance = hippt::max(0.0f, (squared_luminance - luminance * average_luminance) / pixel_sample_count);
+
+    return 1.96f * sqrtf(pixel_variance) / sqrtf(pixel_sample_count);
+}
+
+/**
+ * Writes the average of the samples of the pixel in the framebuffer, scaled by the number of
+ * passes (sample_number + 1 for the pass being rendered) so that the framebuffer can be divided
+ * by 'sample_number' by its readers whatever the number of samples the pixel actually got
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE void resolve_adaptive_sampling_pixel(const HIPRTRenderData& render_data, int pixel_index)
+{
+    int pixel_sample_count = render_data.aux_buffers.pixel_sample_count[pixel_index];
+    if (pixel_sample_count == 0)
+        return;
+
+    float pass_count = render_data.render_settings.sample_number + 1.0f;
+    render_data.buffers.pixels[pixel_index] = render_data.aux_buffers.pixel_color_sum[pixel_index] / static_cast<float>(pixel_sample_count) * pass_count;
+}
+
+/**
+ * Returns true if the pixel belongs to a tile that has converged according
+ * to TileConvergence and that doesn't need samples anymore.
+ * 
+ * Always false on the pass that resets the render, the tiles that
+ * converged were for the previous render
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE bool is_pixel_tile_converged(const HIPRTRenderData& render_data, int x, int y, int2 res)
+{
+    const HIPRTRenderSettings& render_settings = render_data.render_settings;
+
+    if (!render_settings.use_tile_convergence || !render_settings.has_access_to_adaptive_sampling_buffers())
+        return false;
+
+    if (render_settings.sample_number == 0 || render_settings.need_to_reset || render_settings.do_render_low_resolution())
+        return false;
+
+    int2 tile_count = render_settings.get_convergence_tile_count(res);
+    int tile_index = x / render_settings.convergence_tile_size + y / render_settings.convergence_tile_size * tile_count.x;
 
-    return 1.96f * sqrtf(pixel_variance) / sqrtf(pixel_sample_count + 1);
+    return render_data.aux_buffers.tile_converged[tile_index];
+}
+
+/**
+ * Returns how many samples a pixel that hasn't converged gets in this pass.
+ * 
+ * Each pass has a budget of one sample per pixel of the image. That budget is shared by
+ * the pixels proportionally to their 'pixel_error': the confidence interval of the pixel relative
+ * to the noise threshold (1 for the pixels that don't have enough samples to estimate it yet).
+ * The sum of the errors of the previous pass normalizes the share of each pixel. The fractional
+ * part of the share is rounded stochastically so that the budget is respected on average.
+ * 
+ * The errors are summed in render_data.aux_buffers.adaptive_sampling_error_sums: pass N
+ * accumulates in slot N % 3 and reads the complete sum of pass N - 1 in slot (N + 2) % 3.
+ * Slot (N + 1) % 3 is cleared during pass N for pass N + 1 (see CameraRays)
+ * 
+ * With ReSTIR DI, the samples aren't redistributed: each pixel that
+ * hasn't converged gets exactly one sample per pass
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE int redistributed_sample_count(const HIPRTRenderData& render_data, int pixel_index, float pixel_error, int2 res)
+{
+#if DirectLightSamplingStrategy == LSS_RESTIR_DI
+    // The reservoir of the pixel is only resampled for the first hit of the camera ray of the pass.
+    // Additional samples would all shade that same first hit with that same reservoir: they
+    // would be correlated. No redistribution, one sample per pixel that hasn't converged
+    return 1;
+#else
+    const HIPRTRenderSettings& render_settings = render_data.render_settings;
+    int pass = render_settings.sample_number;
+
+    hippt::atomic_add(&render_data.aux_buffers.adaptive_sampling_error_sums[pass % 3], pixel_error);
+
+    if (!render_settings.adaptive_sampling_redistribute_samples || pass < 2)
+        // Pass 0 accumulates in a slot that may hold the errors of a previous render
+        // so the first pass that can read a complete sum is pass 2
+        return 1;
+
+    float previous_error_sum = render_data.aux_buffers.adaptive_sampling_error_sums[(pass + 2) % 3];
+    if (previous_error_sum <= 0.0f)
+        return 1;
+
+    float sample_share = pixel_error * res.x * res.y / previous_error_sum;
+    int sample_count = static_cast<int>(sample_share);
+
+    Xorshift32Generator random_number_generator(wang_hash((pixel_index + 1) * (pass + 1) * render_data.random_seed + 1));
+    if (random_number_generator() < sample_share - sample_count)
+        sample_count++;
+
+    return hippt::min(sample_count, hippt::min(render_settings.adaptive_sampling_max_samples_per_pass, 255));
+#endif
 }
 
 /**
  * pixel_converged is set to true if the given pixel has reached the noise
- * threshold given in render_data.render_settings.stop_pixel_percentage_converged. It 
- * is set to false otherwise.
+ * threshold of adaptive sampling or the one given in render_data.render_settings.stop_pixel_noise_threshold.
+ * It is set to false otherwise.
  * 
- * Returns true if the pixel needs more sample according to adaptive sampling (or if adaptive sampling is disabled).
- * Returns false otherwise
+ * Returns how many samples the pixel needs in this pass according to adaptive sampling
+ * (always 1 if adaptive sampling is disabled). 0 if the pixel doesn't need samples
  */
-HIPRT_HOST_DEVICE HIPRT_INLINE bool adaptive_sampling(const HIPRTRenderData& render_data, int pixel_index, bool& pixel_converged)
+HIPRT_HOST_DEVICE HIPRT_INLINE int adaptive_sampling(const HIPRTRenderData& render_data, int pixel_index, int2 res, bool& pixel_converged)
 {
     const HIPRTRenderSettings& render_settings = render_data.render_settings;
     const AuxiliaryBuffers& aux_buffers = render_data.aux_buffers;
 
     if (!render_settings.has_access_to_adaptive_sampling_buffers())
-        // Adaptive sampling is not on so returning true to indicate
+        // Adaptive sampling is not on so returning 1 to indicate
         // that this pixel is going to need sampling
-        return true;
+        return 1;
 
     if (render_settings.enable_adaptive_sampling)
     {
@@ -43,31 +139,38 @@ HIPRT_HOST_DEVICE HIPRT_INLINE bool adaptive_sampling(const HIPRTRenderData& ren
         // know whether to keep sampling that pixel or not
 
         if (aux_buffers.pixel_converged_sample_count[pixel_index] != -1)
+        {
             // Pixel is already converged because we have a value != -1 in the
             // pixels converged sample count buffer
-            return false;
+            pixel_converged = true;
 
+            return 0;
+        }
+
+        float pixel_error = 1.0f;
         int pixel_sample_count = aux_buffers.pixel_sample_count[pixel_index];
         if (pixel_sample_count > render_settings.adaptive_sampling_min_samples)
         {
-            bool pixel_needs_sampling;
             float average_luminance;
-            float confidence_interval;
-            confidence_interval = get_pixel_confidence_interval(render_data, pixel_index, pixel_sample_count, average_luminance);
+            float confidence_interval = get_pixel_confidence_interval(render_data, pixel_index, pixel_sample_count, average_luminance);
 
-            pixel_needs_sampling = confidence_interval > render_settings.adaptive_sampling_noise_threshold * average_luminance;
-            if (!pixel_needs_sampling)
+            float noise_threshold = render_settings.adaptive_sampling_noise_threshold * average_luminance;
+            if (confidence_interval <= noise_threshold)
             {
-                if (aux_buffers.pixel_converged_sample_count[pixel_index] == -1)
-                    // Indicates no need to sample anymore by indicating that this pixel has converged
-                    // only if we hadn't indicated the convergence before already
-                    aux_buffers.pixel_converged_sample_count[pixel_index] = pixel_sample_count;
+                // Indicates no need to sample anymore by indicating that this pixel has converged
+                aux_buffers.pixel_converged_sample_count[pixel_index] = pixel_sample_count;
+                pixel_converged = true;
 
-                return false;
+                return 0;
             }
+
+            if (noise_threshold > 0.0f)
+                // Capped so that a few outliers (almost black pixels with a firefly) don't
+                // take the whole budget away from the rest of the image
+                pixel_error = hippt::min(confidence_interval / noise_threshold, 64.0f);
         }
 
-        return true;
+        return redistributed_sample_count(render_data, pixel_index, pixel_error, res);
     }
     // Only counting the convergence of pixels according to
     // the pixel stop noise threshold if adaptive sampling is not enabled
@@ -100,7 +203,7 @@ HIPRT_HOST_DEVICE HIPRT_INLINE bool adaptive_sampling(const HIPRTRenderData& ren
             aux_buffers.pixel_converged_sample_count[pixel_index] = -1;
     }
 
-    return true;
+    return 1;
 }
 
 #endif
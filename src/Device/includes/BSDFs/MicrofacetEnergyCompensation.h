@@ -33,7 +33,8 @@ HIPRT_HOST_DEVICE HIPRT_INLINE ColorRGB32F get_GGX_energy_compensation_conductor
 
     // Reading the precomputed directional albedo from the texture
     int2 dims = make_int2(GPUBakerConstants::GGX_CONDUCTOR_ESS_TEXTURE_SIZE_COS_THETA_O, GPUBakerConstants::GGX_CONDUCTOR_ESS_TEXTURE_SIZE_ROUGHNESS);
-    float Ess = sample_texture_rgb_32bits(GGX_Ess_texture_pointer, 0, dims, false, make_float2(hippt::max(0.0f, local_view_direction.z), material_roughness)).r;
+    // (through a view on the CPU, see CPURenderer::setup_brdfs_data())
+    float Ess = sample_texture_view_rgb_32bits(GGX_Ess_texture_pointer, 0, dims, false, make_float2(hippt::max(0.0f, local_view_direction.z), material_roughness)).r;
 
     // Computing kms, [Practical multiple scattering compensation for microfacet models, Turquin, 2019], Eq. 10
     float kms = (1.0f - Ess) / Ess;
@@ -646,7 +647,7 @@ HIPRT_HOST_DEVICE HIPRT_INLINE float get_GGX_energy_compensation_dielectrics(con
     bool bsdf_already_compensated = material.enforce_strong_energy_conservation && PrincipledBSDFEnforceStrongEnergyConservation == KERNEL_OPTION_TRUE;
     if (material.thin_film < 1.0f && !bsdf_already_compensated)
     {
-        bool inside_object = ray_volume_state.inside_material;
+        bool inside_object = ray_volume_state.interior_stack.inside_material;
         float relative_eta_for_correction = inside_object ? 1.0f / relative_eta : relative_eta;
 		float exponent_correction = 2.5f;
 		if (!material.thin_walled)
@@ -219,8 +219,8 @@ HIPRT_HOST_DEVICE HIPRT_INLINE ColorRGB32F principled_glass_eval(const HIPRTRend
     bool reflecting = NoL * NoV > 0;
 
     // Relative eta = eta_t / eta_i
-    float eta_i = ray_volume_state.incident_mat_index == InteriorStackImpl<InteriorStackStrategy>::MAX_MATERIAL_INDEX ? 1.0 : render_data.buffers.materials_buffer[ray_volume_state.incident_mat_index].ior;
-    float eta_t = ray_volume_state.outgoing_mat_index == InteriorStackImpl<InteriorStackStrategy>::MAX_MATERIAL_INDEX ? 1.0 : render_data.buffers.materials_buffer[ray_volume_state.outgoing_mat_index].ior;
+    float eta_i = ray_volume_state.interior_stack.incident_mat_index == InteriorStackBase::MAX_MATERIAL_INDEX ? 1.0 : render_data.buffers.materials_buffer.get_ior(ray_volume_state.interior_stack.incident_mat_index);
+    float eta_t = ray_volume_state.interior_stack.outgoing_mat_index == InteriorStackBase::MAX_MATERIAL_INDEX ? 1.0 : render_data.buffers.materials_buffer.get_ior(ray_volume_state.interior_stack.outgoing_mat_index);
 
     eta_i = compute_dispersion_ior(material.dispersion_abbe_number, material.dispersion_scale, eta_i, hippt::abs(ray_volume_state.sampled_wavelength));
     eta_t = compute_dispersion_ior(material.dispersion_abbe_number, material.dispersion_scale, eta_t, hippt::abs(ray_volume_state.sampled_wavelength));
@@ -355,8 +355,8 @@ HIPRT_HOST_DEVICE HIPRT_INLINE ColorRGB32F principled_glass_eval(const HIPRTRend
 
         if (material.thin_walled)
             // For thin materials, refracting in equals refracting out so we're poping the stack
-            ray_volume_state.interior_stack.pop(ray_volume_state.inside_material);
-        else if (ray_volume_state.incident_mat_index != InteriorStackImpl<InteriorStackStrategy>::MAX_MATERIAL_INDEX)
+            ray_volume_state.interior_stack.pop(ray_volume_state.interior_stack.inside_material);
+        else if (ray_volume_state.interior_stack.incident_mat_index != InteriorStackBase::MAX_MATERIAL_INDEX)
         {
             // If we're not coming from the air, this means that we were in a volume and we're currently
             // refracting out of the volume or into another volume.
@@ -366,7 +366,7 @@ HIPRT_HOST_DEVICE HIPRT_INLINE ColorRGB32F principled_glass_eval(const HIPRTRend
             // by this material that the ray has been absorbed. The ray has been absorded by the volume
             // it was in before refracting here, so it's the incident mat index
 
-            const SimplifiedRendererMaterial& incident_material = render_data.buffers.materials_buffer[ray_volume_state.incident_mat_index];
+            const MaterialColdData& incident_material = render_data.buffers.materials_buffer.cold[ray_volume_state.interior_stack.incident_mat_index];
             if (!incident_material.absorption_color.is_white())
             {
                 // Remapping the absorption coefficient so that it is more intuitive to manipulate
@@ -378,9 +378,9 @@ HIPRT_HOST_DEVICE HIPRT_INLINE ColorRGB32F principled_glass_eval(const HIPRTRend
 
             // We changed volume so we're resetting the distance
             ray_volume_state.distance_in_volume = 0.0f;
-            if (ray_volume_state.inside_material)
+            if (ray_volume_state.interior_stack.inside_material)
                 // We refracting out of a volume so we're poping the stack
-                ray_volume_state.interior_stack.pop(ray_volume_state.inside_material);
+                ray_volume_state.interior_stack.pop(ray_volume_state.interior_stack.inside_material);
         }
     }
 
@@ -390,10 +390,10 @@ HIPRT_HOST_DEVICE HIPRT_INLINE ColorRGB32F principled_glass_eval(const HIPRTRend
 /**
  * The sampled direction is returned in the local shading frame of the basis used for 'local_view_direction'
  */
-HIPRT_HOST_DEVICE HIPRT_INLINE float3 principled_glass_sample(const RendererMaterial* materials_buffer, const SimplifiedRendererMaterial& material, RayVolumeState& ray_volume_state, const float3& local_view_direction, Xorshift32Generator& random_number_generator)
+HIPRT_HOST_DEVICE HIPRT_INLINE float3 principled_glass_sample(const MaterialsSoA& materials_buffer, const SimplifiedRendererMaterial& material, RayVolumeState& ray_volume_state, const float3& local_view_direction, Xorshift32Generator& random_number_generator)
 {
-    float eta_i = ray_volume_state.incident_mat_index == InteriorStackImpl<InteriorStackStrategy>::MAX_MATERIAL_INDEX ? 1.0f : materials_buffer[ray_volume_state.incident_mat_index].ior;
-    float eta_t = ray_volume_state.outgoing_mat_index == InteriorStackImpl<InteriorStackStrategy>::MAX_MATERIAL_INDEX ? 1.0f : materials_buffer[ray_volume_state.outgoing_mat_index].ior;
+    float eta_i = ray_volume_state.interior_stack.incident_mat_index == InteriorStackBase::MAX_MATERIAL_INDEX ? 1.0f : materials_buffer.get_ior(ray_volume_state.interior_stack.incident_mat_index);
+    float eta_t = ray_volume_state.interior_stack.outgoing_mat_index == InteriorStackBase::MAX_MATERIAL_INDEX ? 1.0f : materials_buffer.get_ior(ray_volume_state.interior_stack.outgoing_mat_index);
 
     eta_i = compute_dispersion_ior(material.dispersion_abbe_number, material.dispersion_scale, eta_i, hippt::abs(ray_volume_state.sampled_wavelength));
     eta_t = compute_dispersion_ior(material.dispersion_abbe_number, material.dispersion_scale, eta_t, hippt::abs(ray_volume_state.sampled_wavelength));
@@ -1012,7 +1012,7 @@ HIPRT_HOST_DEVICE HIPRT_INLINE ColorRGB32F principled_bsdf_eval(const HIPRTRende
                                       coat_weight, sheen_weight, metal_1_weight, metal_2_weight,
                                       specular_weight, diffuse_weight, glass_weight);
 
-    float incident_medium_ior = ray_volume_state.incident_mat_index == /* air */ InteriorStackImpl<InteriorStackStrategy>::MAX_MATERIAL_INDEX ? 1.0f : render_data.buffers.materials_buffer[ray_volume_state.incident_mat_index].ior;
+    float incident_medium_ior = ray_volume_state.interior_stack.incident_mat_index == /* air */ InteriorStackBase::MAX_MATERIAL_INDEX ? 1.0f : render_data.buffers.materials_buffer.get_ior(ray_volume_state.interior_stack.incident_mat_index);
     // For the given to_light_direction, normal, view_direction etc..., what's the probability
     // that the 'principled_bsdf_sample()' function would have sampled the lobe?
     float coat_proba, sheen_proba, metal_1_proba, metal_2_proba;
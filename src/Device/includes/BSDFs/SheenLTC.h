@@ -56,7 +56,8 @@ HIPRT_HOST_DEVICE HIPRT_INLINE ColorRGB32F read_LTC_parameters(const HIPRTRender
 #endif
 
 	float2 parameters_uv = make_float2(cos_theta, 1.0f - roughness);
-	return sample_texture_rgb_32bits(ltc_parameters_texture_pointer, 0, make_int2(32, 32), false, parameters_uv);
+	// The CPU reads the parameters directly from 'ltc_parameters_table_approximation' through a view
+	return sample_texture_view_rgb_32bits(ltc_parameters_texture_pointer, 0, make_int2(32, 32), false, parameters_uv);
 }
 
 /**
@@ -27,9 +27,12 @@
    * Sampled as [y][x] = float3(Ai, Bi, Ri) with:
    *  y = cos(theta)
    *  x = alpha
+   *
+   * The CPU renderer samples this table in place (through an Image32BitView)
+   * so this is read-only and aligned on a cache line
    */
 
-static std::array<float3, 32*32> ltc_parameters_table_approximation = {
+alignas(64) static const std::array<float3, 32*32> ltc_parameters_table_approximation = {
 
         make_float3(0.10027f, -0.00000f, 0.33971f), make_float3(0.10760f, -0.00000f, 0.35542f), make_float3(0.11991f, 0.00001f, 0.30888f),
         make_float3(0.13148f, 0.00001f, 0.23195f), make_float3(0.14227f, 0.00001f, 0.15949f), make_float3(0.15231f, -0.00000f, 0.10356f),
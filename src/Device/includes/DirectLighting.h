@@ -0,0 +1,152 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef DEVICE_DIRECT_LIGHTING_H
+#define DEVICE_DIRECT_LIGHTING_H
+
+#include "Device/includes/Envmap.h"
+#include "Device/includes/FixIntellisense.h"
+#include "Device/includes/Lights.h"
+#include "Device/includes/RayPayload.h"
+#include "HostDeviceCommon/Color.h"
+#include "HostDeviceCommon/HitInfo.h"
+#include "HostDeviceCommon/RenderData.h"
+#include "HostDeviceCommon/Xorshift.h"
+
+/**
+ * Irradiance received by an unoccluded surface if the envmap had a
+ * constant radiance equal to the average radiance of its texels
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE float envmap_irradiance_estimate(const WorldSettings& world_settings)
+{
+    // 'envmap_total_sum' is the integral of the luminance over the sphere
+    float average_luminance = world_settings.envmap_total_sum / (4.0f * M_PI);
+
+    return M_PI * average_luminance * world_settings.envmap_intensity;
+}
+
+/**
+ * Unoccluded irradiance estimate of the emissive geometry at the shading point,
+ * from a single emissive triangle picked uniformly and seen from its centroid.
+ *
+ * No shadow ray is traced, this is only used to choose between the emissive
+ * geometry and the envmap
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE float emissive_irradiance_estimate_at_hit(const HIPRTRenderData& render_data, const HitInfo& closest_hit_info, Xorshift32Generator& random_number_generator)
+{
+    int random_index = random_number_generator.random_index(render_data.buffers.emissive_triangles_count);
+    int triangle_index = render_data.buffers.emissive_triangles_indices[random_index];
+
+    float3 vertex_A = render_data.buffers.vertices_positions[render_data.buffers.triangles_indices[triangle_index * 3 + 0]];
+    float3 vertex_B = render_data.buffers.vertices_positions[render_data.buffers.triangles_indices[triangle_index * 3 + 1]];
+    float3 vertex_C = render_data.buffers.vertices_positions[render_data.buffers.triangles_indices[triangle_index * 3 + 2]];
+
+    float3 light_normal = hippt::cross(vertex_B - vertex_A, vertex_C - vertex_A);
+    float length_normal = hippt::length(light_normal);
+
+    float3 to_light = (vertex_A + vertex_B + vertex_C) / 3.0f - closest_hit_info.inter_point;
+    float distance_squared = hippt::dot(to_light, to_light);
+    if (length_normal <= 1.0e-6f || distance_squared <= 1.0e-6f)
+        return 0.0f;
+
+    float3 to_light_direction = to_light / sqrt(distance_squared);
+    float cosine_at_surface = hippt::max(0.0f, hippt::dot(closest_hit_info.shading_normal, to_light_direction));
+    float cosine_at_light = hippt::abs(hippt::dot(light_normal / length_normal, to_light_direction));
+    float light_area = length_normal * 0.5f;
+
+    float emission_luminance = render_data.buffers.materials_buffer.get_emission(render_data.buffers.material_indices[triangle_index]).luminance();
+
+    // Divided by the probability 1 / emissive_triangles_count of having picked that triangle
+    return emission_luminance * light_area * cosine_at_surface * cosine_at_light / distance_squared * render_data.buffers.emissive_triangles_count;
+}
+
+/**
+ * Probability of choosing the envmap over the emissive geometry for the
+ * direct lighting of that path vertex (see DirectLightUnifiedSelection)
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE float envmap_selection_probability(const HIPRTRenderData& render_data, const HitInfo& closest_hit_info, Xorshift32Generator& random_number_generator)
+{
+    // Never completely giving up on one of the two: the estimates ignore occlusion
+    // and the contribution of a source that is rarely chosen would be fireflies
+    const float min_selection_probability = 0.1f;
+
+#if DirectLightUnifiedSelection == DLUS_PER_HIT_ESTIMATE
+    float emissive_estimate = emissive_irradiance_estimate_at_hit(render_data, closest_hit_info, random_number_generator);
+#else
+    float emissive_estimate = render_data.buffers.emissive_irradiance_estimate;
+#endif
+    float envmap_estimate = envmap_irradiance_estimate(render_data.world_settings);
+
+    float estimates_sum = emissive_estimate + envmap_estimate;
+    if (estimates_sum <= 0.0f)
+        return 0.5f;
+
+    return hippt::clamp(min_selection_probability, 1.0f - min_selection_probability, envmap_estimate / estimates_sum);
+}
+
+/**
+ * Whether or not both the emissive geometry and the envmap would be sampled
+ * at that vertex by sample_one_light() and sample_environment_map()
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE bool direct_lighting_can_choose_source(const HIPRTRenderData& render_data, const RayPayload& ray_payload, int bounce)
+{
+    if (render_data.buffers.emissive_triangles_count == 0)
+        return false;
+
+    if (render_data.world_settings.ambient_light_type != AmbientLightType::ENVMAP || render_data.world_settings.envmap_intensity <= 0.0f)
+        return false;
+
+    if (render_data.bsdfs_data.white_furnace_mode)
+        return false;
+
+    if (ray_payload.material.is_emissive())
+        // sample_one_light() may return the emission of the surface itself, not choosing
+        return false;
+
+    if (bounce == 0 && DirectLightSamplingStrategy == LSS_RESTIR_DI)
+        // ReSTIR DI already samples the envmap and the emissive geometry together
+        return false;
+
+    return true;
+}
+
+/**
+ * Samples the direct lighting of the emissive geometry and of the envmap at a path vertex.
+ *
+ * The two contributions are returned separately because they are not clamped with
+ * the same values.
+ *
+ * If DirectLightUnifiedSelection isn't DLUS_NONE, only one of the two sources is sampled
+ * (and only its shadow rays are traced), the other contribution is black.
+ * The MIS weights computed by each sampling routine between its light and BSDF samples
+ * are unchanged: the selection probability scales both techniques of the chosen routine
+ * the same way and is folded in by dividing the contribution of the routine by it
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE void sample_direct_lighting(const HIPRTRenderData& render_data, const RayPayload& ray_payload, HitInfo& closest_hit_info, const float3& view_direction, Xorshift32Generator& random_number_generator, int2 pixel_coords, int2 resolution, int bounce, ColorRGB32F& out_light_contribution, ColorRGB32F& out_envmap_contribution)
+{
+#if DirectLightUnifiedSelection != DLUS_NONE && DirectLightSamplingStrategy != LSS_NO_DIRECT_LIGHT_SAMPLING && EnvmapSamplingStrategy != ESS_NO_SAMPLING
+    if (direct_lighting_can_choose_source(render_data, ray_payload, bounce))
+    {
+        float envmap_probability = envmap_selection_probability(render_data, closest_hit_info, random_number_generator);
+        if (random_number_generator() < envmap_probability)
+        {
+            out_light_contribution = ColorRGB32F(0.0f);
+            out_envmap_contribution = sample_environment_map(render_data, ray_payload, closest_hit_info, view_direction, bounce, random_number_generator) / envmap_probability;
+        }
+        else
+        {
+            out_light_contribution = sample_one_light(render_data, ray_payload, closest_hit_info, view_direction, random_number_generator, pixel_coords, resolution, bounce) / (1.0f - envmap_probability);
+            out_envmap_contribution = ColorRGB32F(0.0f);
+        }
+
+        return;
+    }
+#endif
+
+    out_light_contribution = sample_one_light(render_data, ray_payload, closest_hit_info, view_direction, random_number_generator, pixel_coords, resolution, bounce);
+    out_envmap_contribution = sample_environment_map(render_data, ray_payload, closest_hit_info, view_direction, bounce, random_number_generator);
+}
+
+#endif
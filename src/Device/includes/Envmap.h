@@ -74,38 +74,43 @@ HIPRT_HOST_DEVICE HIPRT_INLINE void envmap_cdf_search(const WorldSettings& world
     x = hippt::max(hippt::min(lower, world_settings.envmap_width), 0u);
 }
 
+/**
+ * Importance samples a direction proportionally to the luminance of the envmap
+ * times the solid angle of its texels. The returned PDF is in solid angle measure
+ */
 HIPRT_HOST_DEVICE HIPRT_INLINE ColorRGB32F envmap_sample(const WorldSettings& world_settings, float3& sampled_direction, float& envmap_pdf, Xorshift32Generator& random_number_generator)
 {
     int x, y;
-    float env_map_total_sum = world_settings.envmap_total_sum;
 
 #if EnvmapSamplingStrategy == ESS_BINARY_SEARCH
     // Importance sampling a texel of the envmap with a binary search on the CDF
-    envmap_cdf_search(world_settings, random_number_generator() * env_map_total_sum, x, y);
+    envmap_cdf_search(world_settings, random_number_generator() * world_settings.envmap_total_sum, x, y);
 #else
     int random_index = random_number_generator.random_index(world_settings.envmap_height * world_settings.envmap_width);
-    float probability = world_settings.alias_table_probas[random_index];
-    if (random_number_generator() > probability)
+    // Single fetch, the PDF of the alias is stored in the entry too
+    EnvmapAliasTableEntry alias_table_entry = world_settings.alias_table[random_index];
+    if (random_number_generator() > alias_table_entry.probability)
+    {
         // Picking the alias
-        random_index = world_settings.alias_table_alias[random_index];
+        random_index = alias_table_entry.alias;
+        envmap_pdf = alias_table_entry.alias_pdf;
+    }
+    else
+        envmap_pdf = alias_table_entry.pdf;
 
     y = static_cast<int>(random_index / world_settings.envmap_width);
     x = static_cast<int>(random_index - y * world_settings.envmap_width);
 #endif
 
-    // Converting to UV coordinates
-    float u = static_cast<float>(x) / world_settings.envmap_width;
-    float v = static_cast<float>(y) / world_settings.envmap_height;
+    // Sampling a direction uniformly in the solid angle covered by the texel:
+    // uniform in phi and uniform in cos(theta) between the two rows of the texel
+    float phi = (x + random_number_generator()) / world_settings.envmap_width * M_TWO_PI;
+    float cos_theta_top = cos(y * M_PI / world_settings.envmap_height);
+    float cos_theta_bottom = cos((y + 1) * M_PI / world_settings.envmap_height);
 
-    // Converting to polar coordinates
-    float phi = u * M_TWO_PI;
-    // Clamping because a theta of 0.0f would mean straight up which means singularity
-    // which means not good for numerical stability
-    float theta = hippt::max(1.0e-5f, v * M_PI);
+    float cos_theta = cos_theta_top + (cos_theta_bottom - cos_theta_top) * random_number_generator();
+    float sin_theta = sqrt(hippt::max(0.0f, 1.0f - cos_theta * cos_theta));
 
-    // Convert to cartesian coordinates
-    float cos_theta = cos(theta);
-    float sin_theta = sin(theta);
     // Using this formula here instead of the usual (sin_theta * cos(phi), sin_theta * sin(phi), cos_theta)
     // because we want our envmap to be Y-up
     sampled_direction = make_float3(-sin_theta * cos(phi), -cos_theta, -sin_theta * sin(phi));
@@ -113,12 +118,16 @@ HIPRT_HOST_DEVICE HIPRT_INLINE ColorRGB32F envmap_sample(const WorldSettings& wo
     // Taking envmap rotation into account to bring the direction in world space
     sampled_direction = matrix_X_vec(world_settings.envmap_to_world_matrix, sampled_direction);
 
+    // Radiance of the center of the texel, the whole texel was sampled with that radiance
+    float u = (x + 0.5f) / world_settings.envmap_width;
+    float v = (y + 0.5f) / world_settings.envmap_height;
     ColorRGB32F env_map_radiance = sample_environment_map_texture(world_settings, make_float2(u, 1.0f - v));
-    // Computing envmap PDF
-    envmap_pdf = env_map_radiance.luminance() / (env_map_total_sum * world_settings.envmap_intensity);
-    envmap_pdf *= world_settings.envmap_width * world_settings.envmap_height;
-    // Converting the PDF from area measure on the envmap to solid angle measure
-    envmap_pdf /= (M_TWO_PIPI * sin_theta);
+
+#if EnvmapSamplingStrategy == ESS_BINARY_SEARCH
+    // No conversion from the area measure of the envmap to solid angle
+    // measure needed, the texels were weighted by their solid angle
+    envmap_pdf = env_map_radiance.luminance() / (world_settings.envmap_total_sum * world_settings.envmap_intensity);
+#endif
 
     return env_map_radiance;
 }
@@ -133,17 +142,9 @@ HIPRT_HOST_DEVICE HIPRT_INLINE ColorRGB32F envmap_eval(const HIPRTRenderData& re
 
     ColorRGB32F envmap_radiance = eval_envmap_no_pdf(world_settings, direction);
 
-    float envmap_total_sum = world_settings.envmap_total_sum;
-
-    float theta_bsdf_dir = acos(-direction.y);
-    float sin_theta = sin(theta_bsdf_dir);
-
-    // Probability of sampling that texel on the envmap
-    pdf = envmap_radiance.luminance() / (envmap_total_sum * render_data.world_settings.envmap_intensity);
-    pdf *= world_settings.envmap_width * world_settings.envmap_height;
-
-    // Converting from "texel on envmap measure" to solid angle
-    pdf /= (M_TWO_PIPI * sin_theta);
+    // Probability in solid angle measure of sampling that direction, the solid
+    // angle of the texel is already accounted for in 'envmap_total_sum'
+    pdf = envmap_radiance.luminance() / (world_settings.envmap_total_sum * world_settings.envmap_intensity);
 
     return envmap_radiance;
 }
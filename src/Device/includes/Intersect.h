@@ -64,7 +64,7 @@ HIPRT_HOST_DEVICE HIPRT_INLINE float3 normal_mapping(const HIPRTRenderData& rend
 HIPRT_HOST_DEVICE HIPRT_INLINE float3 get_shading_normal(const HIPRTRenderData& render_data, const float3& geometric_normal, int primitive_index, const float2& uv, const float2& interpolated_texcoords)
 {
     int mat_index = render_data.buffers.material_indices[primitive_index];
-    RendererMaterial& material = render_data.buffers.materials_buffer[mat_index];
+    const MaterialShadingData& material = render_data.buffers.materials_buffer.shading[mat_index];
 
     // Do smooth shading first if we have vertex normals
     float3 surface_normal;
@@ -191,7 +191,7 @@ HIPRT_HOST_DEVICE HIPRT_INLINE bool trace_ray(const HIPRTRenderData& render_data
             out_hit_info.shading_normal += (2.0f * hippt::clamp(0.0f, 1.0f, -NdotV)) * -ray.direction;
         }
 
-        skipping_volume_boundary = in_out_ray_payload.volume_state.interior_stack.push(in_out_ray_payload.volume_state.incident_mat_index, in_out_ray_payload.volume_state.outgoing_mat_index, in_out_ray_payload.volume_state.inside_material, material_index, in_out_ray_payload.material.dielectric_priority);
+        skipping_volume_boundary = in_out_ray_payload.volume_state.interior_stack.push(material_index, in_out_ray_payload.material.dielectric_priority);
 
         if (skipping_volume_boundary)
         {
@@ -254,34 +254,11 @@ HIPRT_HOST_DEVICE HIPRT_INLINE bool evaluate_shadow_ray(const HIPRTRenderData& r
 
     return true;
 #else
-    float alpha = 1.0f;
-    // The total distance of our ray. Incremented after each hit
-    // (we may find multiple hits if we hit transparent texture
-    // and keep intersecting the scene)
-    float cumulative_t = 0.0f;
-
-    hiprtHit hit;
-    do
-    {
-        // We should use ray tracing fitler functions here instead of re-tracing new rays
-        hit = intersect_scene_cpu(render_data, ray, last_hit_primitive_index, random_number_generator);
-        if (!hit.hasHit())
-            return false;
-
-        if (render_data.render_settings.do_alpha_testing)
-            alpha = get_hit_base_color_alpha(render_data, hit);
-        else
-            alpha = 1.0f;
-
-        // Next ray origin
-        ray.origin = ray.origin + ray.direction * hit.t;
-        cumulative_t += hit.t;
-
-        // We keep going as long as the alpha is < 1.0f meaning that we hit texture transparency
-    } while (alpha < 1.0f && cumulative_t < t_max - 1.0e-4f);
+    // Alpha testing is done by the filter function during the traversal
+    hiprtHit hit = intersect_scene_cpu(render_data, ray, last_hit_primitive_index, random_number_generator);
 
     // If we found a hit and that it is close enough
-    return hit.hasHit() && cumulative_t < t_max - 1.0e-4f;
+    return hit.hasHit() && hit.t < t_max - 1.0e-4f;
 #endif // __KERNELCC__
 }
 
@@ -325,7 +302,7 @@ HIPRT_HOST_DEVICE HIPRT_INLINE bool evaluate_shadow_light_ray(const HIPRTRenderD
 
     // Reading the emission of the material
     int material_index = render_data.buffers.material_indices[shadow_ray_hit.primID];
-    int emission_texture_index = render_data.buffers.materials_buffer[material_index].emission_texture_index;
+    int emission_texture_index = render_data.buffers.materials_buffer.hot[material_index].emission_texture_index;
 
     if (emission_texture_index != RendererMaterial::NO_TEXTURE)
     {
@@ -337,7 +314,7 @@ HIPRT_HOST_DEVICE HIPRT_INLINE bool evaluate_shadow_light_ray(const HIPRTRenderD
     }
     else
     {
-        out_light_hit_info.hit_emission = render_data.buffers.materials_buffer[material_index].get_emission();
+        out_light_hit_info.hit_emission = render_data.buffers.materials_buffer.get_emission(material_index);
 
         float2 texcoords = uv_interpolate(render_data.buffers.triangles_indices, shadow_ray_hit.primID, render_data.buffers.texcoords, shadow_ray_hit.uv);
         out_light_hit_info.hit_shading_normal = get_shading_normal(render_data, hippt::normalize(shadow_ray_hit.normal), shadow_ray_hit.primID, shadow_ray_hit.uv, texcoords);
@@ -348,40 +325,17 @@ HIPRT_HOST_DEVICE HIPRT_INLINE bool evaluate_shadow_light_ray(const HIPRTRenderD
 
     return true;
 #else
-    float alpha = 1.0f;
-    // The total distance of our ray. Incremented after each hit
-    // (we may find multiple hits if we hit transparent texture
-    // and keep intersecting the scene)
-    float cumulative_t = 0.0f;
-
-    hiprtHit shadow_ray_hit;
-    do
-    {
-        // We should use ray tracing fitler functions here instead of re-tracing new rays
-        shadow_ray_hit = intersect_scene_cpu(render_data, ray, last_hit_primitive_index, random_number_generator);
-        if (!shadow_ray_hit.hasHit())
-            return false;
-
-        if (render_data.render_settings.do_alpha_testing)
-            alpha = get_hit_base_color_alpha(render_data, shadow_ray_hit);
-        else
-            alpha = 1.0f;
-
-        // Next ray origin
-        ray.origin = ray.origin + ray.direction * shadow_ray_hit.t;
-        cumulative_t += shadow_ray_hit.t;
-
-        // We keep going as long as the alpha is < 1.0f meaning that we hit texture transparency
-    } while (alpha < 1.0f && cumulative_t < t_max - 1.0e-4f);
+    // Alpha testing is done by the filter function during the traversal
+    hiprtHit shadow_ray_hit = intersect_scene_cpu(render_data, ray, last_hit_primitive_index, random_number_generator);
 
-    bool hit_found = shadow_ray_hit.hasHit() && cumulative_t < t_max - 1.0e-4f;
+    bool hit_found = shadow_ray_hit.hasHit() && shadow_ray_hit.t < t_max - 1.0e-4f;
 
     if (hit_found)
     {
         // If we found a hit and that it is close enough (hit_found conditions)
 
         int material_index = render_data.buffers.material_indices[shadow_ray_hit.primID];
-        int emission_texture_index = render_data.buffers.materials_buffer[material_index].emission_texture_index;
+        int emission_texture_index = render_data.buffers.materials_buffer.hot[material_index].emission_texture_index;
 
         if (emission_texture_index != RendererMaterial::NO_TEXTURE)
         {
@@ -393,14 +347,14 @@ HIPRT_HOST_DEVICE HIPRT_INLINE bool evaluate_shadow_light_ray(const HIPRTRenderD
         }
         else
         {
-            out_light_hit_info.hit_emission = render_data.buffers.materials_buffer[material_index].get_emission();
+            out_light_hit_info.hit_emission = render_data.buffers.materials_buffer.get_emission(material_index);
 
             float2 texcoords = uv_interpolate(render_data.buffers.triangles_indices, shadow_ray_hit.primID, render_data.buffers.texcoords, shadow_ray_hit.uv);
             out_light_hit_info.hit_shading_normal = get_shading_normal(render_data, hippt::normalize(shadow_ray_hit.normal), shadow_ray_hit.primID, shadow_ray_hit.uv, texcoords);
         }
 
         out_light_hit_info.hit_prim_index = shadow_ray_hit.primID;
-        out_light_hit_info.hit_distance = cumulative_t;
+        out_light_hit_info.hit_distance = shadow_ray_hit.t;
 
         return true;
     }
@@ -20,7 +20,22 @@ HIPRT_HOST_DEVICE HIPRT_INLINE void get_material_property(const HIPRTRenderData&
 HIPRT_HOST_DEVICE HIPRT_INLINE void get_metallic_roughness(const HIPRTRenderData& render_data, float& metallic, float& roughness, const float2& texcoords, int metallic_texture_index, int roughness_texture_index, int metallic_roughness_texture_index);
 HIPRT_HOST_DEVICE HIPRT_INLINE void get_base_color(const HIPRTRenderData& render_data, ColorRGB32F& base_color, float& out_alpha, const float2& texcoords, int base_color_texture_index);
 
-HIPRT_HOST_DEVICE HIPRT_INLINE float get_hit_base_color_alpha(const HIPRTRenderData& render_data, const RendererMaterial& material, hiprtHit hit)
+/**
+ * Last texture fetched when reading the scalar properties of a material so that
+ * the properties packed in the same texture don't fetch it again
+ */
+struct ScalarTextureFetch
+{
+    int texture_index = RendererMaterial::NO_TEXTURE;
+    ColorRGBA32F rgba;
+};
+
+HIPRT_HOST_DEVICE HIPRT_INLINE void get_scalar_material_property(const HIPRTRenderData& render_data, float& output_data, const float2& texcoords, const RendererMaterial& material, RendererMaterial::ScalarTextureProperty property, int texture_index, ScalarTextureFetch& last_fetch);
+
+/**
+ * Only the hot block of the material is needed for alpha testing
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE float get_hit_base_color_alpha(const HIPRTRenderData& render_data, const MaterialHotData& material, hiprtHit hit)
 {
     if (material.base_color_texture_index == -1)
         // Quick exit if no texture
@@ -36,61 +51,88 @@ HIPRT_HOST_DEVICE HIPRT_INLINE float get_hit_base_color_alpha(const HIPRTRenderD
     return alpha;
 }
 
-HIPRT_HOST_DEVICE HIPRT_INLINE float get_hit_base_color_alpha(const HIPRTRenderData& render_data, hiprtHit hit)
-{
-    int material_index = render_data.buffers.material_indices[hit.primID];
-    RendererMaterial material = render_data.buffers.materials_buffer[material_index];
-
-    return get_hit_base_color_alpha(render_data, material, hit);
-}
-
 HIPRT_HOST_DEVICE HIPRT_INLINE SimplifiedRendererMaterial get_intersection_material(const HIPRTRenderData& render_data, int material_index, float2 texcoords)
 {
-	RendererMaterial material = render_data.buffers.materials_buffer[material_index];
+    const MaterialsSoA& materials_buffer = render_data.buffers.materials_buffer;
 
-    ColorRGB32F emission = material.get_emission() / material.emission_strength;
-    get_material_property(render_data, emission, false, texcoords, material.emission_texture_index);
-    material.set_emission(emission);
+    // Only the textures that the material uses, see MaterialsSoAHost::pack()
+    unsigned int texture_usage_mask = materials_buffer.shading[material_index].texture_usage_mask;
+    if (texture_usage_mask == 0)
+    {
+        // Nothing to read at the hit, the coat roughening is already precomputed too
+        SimplifiedRendererMaterial material = materials_buffer.get_simplified_material(material_index);
+        if (render_data.bsdfs_data.white_furnace_mode)
+            material.base_color = ColorRGB32F(1.0f);
 
-    float trash_alpha;
+        return material;
+    }
+
+    RendererMaterial material = materials_buffer.get_material(material_index);
     if (render_data.bsdfs_data.white_furnace_mode)
+    {
         material.base_color = ColorRGB32F(1.0f);
-    else
-        get_base_color(render_data, material.base_color, trash_alpha, texcoords, material.base_color_texture_index);
-
-    get_metallic_roughness(render_data, material.metallic, material.roughness, texcoords, material.metallic_texture_index, material.roughness_texture_index, material.roughness_metallic_texture_index);
-    get_material_property(render_data, material.oren_nayar_sigma, false, texcoords, material.oren_sigma_texture_index);
-    
-    get_material_property(render_data, material.specular, false, texcoords, material.specular_texture_index);
-    get_material_property(render_data, material.specular_tint, false, texcoords, material.specular_tint_texture_index);
-    get_material_property(render_data, material.specular_color, false, texcoords, material.specular_color_texture_index);
-    
-    get_material_property(render_data, material.anisotropy, false, texcoords, material.anisotropic_texture_index);
-    get_material_property(render_data, material.anisotropy_rotation, false, texcoords, material.anisotropic_rotation_texture_index);
-    
-    get_material_property(render_data, material.coat, false, texcoords, material.coat_texture_index);
-    get_material_property(render_data, material.coat_roughness, false, texcoords, material.coat_roughness_texture_index);
-    get_material_property(render_data, material.coat_ior, false, texcoords, material.coat_ior_texture_index);
-    
-    get_material_property(render_data, material.sheen, false, texcoords, material.sheen_texture_index);
-    get_material_property(render_data, material.sheen_roughness, false, texcoords, material.sheen_roughness_texture_index);
-    get_material_property(render_data, material.sheen_color, false, texcoords, material.sheen_color_texture_index);
-    
-    get_material_property(render_data, material.specular_transmission, false, texcoords, material.specular_transmission_texture_index);
+        texture_usage_mask &= ~RendererMaterial::BASE_COLOR_TEXTURE_USED;
+    }
+
+    bool do_coat_roughening = texture_usage_mask & RendererMaterial::COAT_ROUGHENING_TEXTURES_USED;
+    bool emissive_texture_used = texture_usage_mask & RendererMaterial::EMISSION_TEXTURE_USED;
+
+    // Iterating over the set bits only. The scalar properties come first, in
+    // the order of RendererMaterial::ScalarTextureProperty so that consecutive
+    // properties packed in the same texture are read with a single fetch
+    ScalarTextureFetch last_fetch;
+    while (texture_usage_mask != 0)
+    {
+        int bit = hippt::count_trailing_zeros(texture_usage_mask);
+        texture_usage_mask &= texture_usage_mask - 1;
+
+        if (bit < RendererMaterial::SCALAR_TEXTURE_PROPERTY_COUNT)
+        {
+            RendererMaterial::ScalarTextureProperty property = static_cast<RendererMaterial::ScalarTextureProperty>(bit);
+            get_scalar_material_property(render_data, material.get_scalar_property(property), texcoords, material, property, material.get_scalar_texture_index(property), last_fetch);
+
+            continue;
+        }
+
+        switch (1u << bit)
+        {
+        case RendererMaterial::BASE_COLOR_TEXTURE_USED:
+        {
+            float trash_alpha;
+            get_base_color(render_data, material.base_color, trash_alpha, texcoords, material.base_color_texture_index);
+            break;
+        }
+
+        case RendererMaterial::EMISSION_TEXTURE_USED:
+        {
+            ColorRGB32F emission = material.get_original_emission();
+            get_material_property(render_data, emission, false, texcoords, material.emission_texture_index);
+            material.set_emission(emission);
+            break;
+        }
+
+        case RendererMaterial::ROUGHNESS_METALLIC_TEXTURE_USED:
+            get_metallic_roughness(render_data, material.metallic, material.roughness, texcoords, material.metallic_texture_index, material.roughness_texture_index, material.roughness_metallic_texture_index);
+            break;
+
+        case RendererMaterial::SPECULAR_COLOR_TEXTURE_USED:
+            get_material_property(render_data, material.specular_color, false, texcoords, material.specular_color_texture_index);
+            break;
+
+        case RendererMaterial::SHEEN_COLOR_TEXTURE_USED:
+            get_material_property(render_data, material.sheen_color, false, texcoords, material.sheen_color_texture_index);
+            break;
+
+        default:
+            break;
+        }
+    }
 
     SimplifiedRendererMaterial simplified_material(material);
-    simplified_material.emissive_texture_used = material.emission_texture_index > 0;
-    // Roughening of the base roughness and second metallic roughness based
-    // on the coat roughness. This should be precomputed instead of being done here
-    //
-    // Reference: [OpenPBR Surface 2024 Specification] https://academysoftwarefoundation.github.io/OpenPBR/#model/coat/roughening
-    float target_base_roughness = hippt::pow_1_4(hippt::min(1.0f, hippt::pow_4(simplified_material.roughness) + 2.0f * hippt::pow_4(simplified_material.coat_roughness)));
-    float roughened_base_roughness = hippt::lerp(simplified_material.roughness, target_base_roughness, material.coat);
-    simplified_material.roughness = hippt::lerp(simplified_material.roughness, roughened_base_roughness, simplified_material.coat_roughening);
-
-    float target_second_metal_roughness = hippt::pow_1_4(hippt::min(1.0f, hippt::pow_4(simplified_material.second_roughness) + 2.0f * hippt::pow_4(simplified_material.coat_roughness)));
-    float roughened_second_metal_roughness = hippt::lerp(simplified_material.second_roughness, target_second_metal_roughness, material.coat);
-    simplified_material.second_roughness = hippt::lerp(simplified_material.second_roughness, roughened_second_metal_roughness, simplified_material.coat_roughening);
+    simplified_material.emissive_texture_used = emissive_texture_used;
+    if (do_coat_roughening)
+        // Depends on values read from the textures, couldn't be precomputed
+        simplified_material.apply_coat_roughening();
 
     return simplified_material;
 }
@@ -125,6 +167,24 @@ HIPRT_HOST_DEVICE HIPRT_INLINE void get_base_color(const HIPRTRenderData& render
     }
 }
 
+/**
+ * Reads a scalar property from its channel of its texture (see RendererMaterial::ScalarTextureProperty),
+ * reusing the texture fetched for the previous scalar property if it's the same texture
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE void get_scalar_material_property(const HIPRTRenderData& render_data, float& output_data, const float2& texcoords, const RendererMaterial& material, RendererMaterial::ScalarTextureProperty property, int texture_index, ScalarTextureFetch& last_fetch)
+{
+    if (texture_index == RendererMaterial::NO_TEXTURE)
+        return;
+
+    if (texture_index != last_fetch.texture_index)
+    {
+        last_fetch.rgba = sample_texture_rgba(render_data.buffers.material_textures, texture_index, render_data.buffers.textures_dims[texture_index], false, texcoords);
+        last_fetch.texture_index = texture_index;
+    }
+
+    output_data = last_fetch.rgba[material.get_scalar_texture_channel(property)];
+}
+
 template <typename T>
 HIPRT_HOST_DEVICE HIPRT_INLINE void read_data(const ColorRGBA32F& rgba, T& data) {}
 
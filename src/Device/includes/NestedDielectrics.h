@@ -17,24 +17,133 @@
   * [2] [Simple Nested Dielectrics in Ray Traced Images, Schmidt, 2002]
   */
 
-template <int Strategy>
-struct InteriorStackImpl {};
-
+/**
+ * Entry of the interior stack, packed in a single 32 bits word.
+ *
+ * The priority is only used by the ISS_WITH_PRIORITIES strategy
+ */
 struct StackEntry
 {
-	// TODO do packing in there
-	bool topmost = true;
-	bool odd_parity = true;
+	// How many bits for encoding the packed priority
+	static constexpr unsigned int PRIORITY_BITS = 4;
+	static constexpr unsigned int PRIORITY_MAXIMUM = (1 << PRIORITY_BITS) - 1;
+	// How many bits for encoding the topmost flag
+	static constexpr unsigned int TOPMOST_BITS = 1;
+	// How many bits for encoding the odd_parity flag
+	static constexpr unsigned int ODD_PARITY_BITS = 1;
+
+	// How many bits for encoding the material_index flag
+	// 
+	// This is the rest of the bits after we've added the other 
+	// flags
+	static constexpr unsigned int MATERIAL_INDEX_BITS = 32 - PRIORITY_BITS - TOPMOST_BITS - ODD_PARITY_BITS;
+	static constexpr unsigned int MATERIAL_INDEX_MAXIMUM = (1 << MATERIAL_INDEX_BITS) - 1;
+
+	HIPRT_HOST_DEVICE StackEntry()
+	{
+		priority = 0;
+		odd_parity = true;
+		topmost = true;
+		// Setting the material index to the maximum
+		material_index = MATERIAL_INDEX_MAXIMUM;
+	}
+
+	// Using bitfields to pack the data in a single 32 bits variable and still keep a nice syntax.
+	// All the bitfields are 'unsigned int' because MSVC doesn't pack bitfields of different types together
+	unsigned int priority : PRIORITY_BITS;
+	unsigned int odd_parity : ODD_PARITY_BITS;
+	unsigned int topmost : TOPMOST_BITS;
+	unsigned int material_index : MATERIAL_INDEX_BITS;
+};
+
+/**
+ * Stack and state of the nested dielectrics shared by the two strategies.
+ *
+ * The state (stack position, incident and outgoing material indices, inside flag)
+ * is packed in two 32 bits words after the stack so that the whole structure is
+ * (NestedDielectricsStackSize + 2) * 4 bytes. This structure is copied around a lot
+ * (ray payloads, G-buffer, BSDF samples of the RIS candidates) so its size matters
+ */
+struct InteriorStackBase
+{
+	// How many bits for encoding the stack position.
+	// This limits NestedDielectricsStackSize to 32
+	static constexpr unsigned int STACK_POSITION_BITS = 5;
+	static constexpr unsigned int INSIDE_MATERIAL_BITS = 1;
+
+	// Index used for the air (the stack[0] entry)
+	static constexpr unsigned int MAX_MATERIAL_INDEX = StackEntry::MATERIAL_INDEX_MAXIMUM;
+
+	HIPRT_HOST_DEVICE InteriorStackBase()
+	{
+		incident_mat_index = MAX_MATERIAL_INDEX;
+		stack_position = 0;
+		inside_material = false;
+		outgoing_mat_index = MAX_MATERIAL_INDEX;
+	}
+
+	HIPRT_HOST_DEVICE void pop(const bool inside_material)
+	{
+		int stack_top_mat_index = stack[stack_position].material_index;
+		if (stack_position > 0)
+			// Checking that we have room to pop.
+			// For a very small stack (size of 2) that overflown 
+			// (we couldn't push all the material we needed to because of 
+			// stack size constraint), it can happen that the stack position
+			// at this point is already 0 and we cannot pop.
+			stack_position--;
+
+		if (inside_material)
+		{
+			int previous_same_mat_index;
+			for (previous_same_mat_index = stack_position; previous_same_mat_index >= 0; previous_same_mat_index--)
+				if (stack[previous_same_mat_index].material_index == stack_top_mat_index)
+					break;
+
+			if (previous_same_mat_index >= 0)
+				for (int i = previous_same_mat_index + 1; i <= stack_position; i++)
+					stack[i - 1] = stack[i];
+
+			// For very small stacks (2 for example), we may not be able to pop twice
+			// at all so we check the position on the stack first
+			if (stack_position > 0)
+				stack_position--;
+		}
+
+		for (int i = stack_position; i >= 0; i--)
+		{
+			if (stack[i].material_index == stack_top_mat_index)
+			{
+				stack[i].topmost = true;
+				break;
+			}
+		}
+	}
+
+	StackEntry stack[NestedDielectricsStackSize];
+
+	// Indices of the material we were in before hitting the current dielectric surface
+	// and of the material we're refracting into. MAX_MATERIAL_INDEX is the air
+	unsigned int incident_mat_index : StackEntry::MATERIAL_INDEX_BITS;
+	// Stack position is pointing at the last valid entry.
+	// Entry 0 is always present and represent air basically
+	unsigned int stack_position : STACK_POSITION_BITS;
+	// Whether or not we're exiting a material
+	unsigned int inside_material : INSIDE_MATERIAL_BITS;
 
-	int material_index = -1;
+	unsigned int outgoing_mat_index : StackEntry::MATERIAL_INDEX_BITS;
 };
 
+static_assert(NestedDielectricsStackSize <= (1 << InteriorStackBase::STACK_POSITION_BITS), "The stack position of the nested dielectrics doesn't have enough bits for that stack size");
+
+template <int Strategy>
+struct InteriorStackImpl {};
+
 template <>
-struct InteriorStackImpl<ISS_AUTOMATIC>
+struct InteriorStackImpl<ISS_AUTOMATIC> : public InteriorStackBase
 {
-	// TODO leaving material never used ? Or used only where we already know its value so not needed
 	// Unused parameter at the end here to have the same signature as InteriorStackPriority
-	HIPRT_HOST_DEVICE bool push(int& incident_material_index, int& outgoing_material_index, bool& inside_material, int material_index, int)
+	HIPRT_HOST_DEVICE bool push(int material_index, int)
 	{
 		// Parity of the material we're inserting in the stack
 		bool odd_parity = true;
@@ -71,104 +180,38 @@ struct InteriorStackImpl<ISS_AUTOMATIC>
 		stack[stack_position].odd_parity = odd_parity;
 		stack[stack_position].topmost = true;
 
+		inside_material = !odd_parity;
+
 		if (odd_parity)
 		{
 			// We are entering the material
-			incident_material_index = stack[last_entered_mat_index].material_index;
-			outgoing_material_index = material_index;
+			incident_mat_index = stack[last_entered_mat_index].material_index;
+			outgoing_mat_index = material_index;
 		}
 		else
 		{
 			// Exiting material
-			outgoing_material_index = stack[last_entered_mat_index].material_index;
+			outgoing_mat_index = stack[last_entered_mat_index].material_index;
 
 			if (last_entered_mat_index < previous_same_mat_index)
-				incident_material_index = material_index;
+				incident_mat_index = material_index;
 			else
 			{
-				incident_material_index = outgoing_material_index;
+				incident_mat_index = outgoing_mat_index;
 
 				// Return true because we are skipping the boundary we just hit
 				return true;
 			}
 		}
 
-		inside_material = !odd_parity;
-
 		return false;
 	}
-
-	HIPRT_HOST_DEVICE void pop(bool inside_material)
-	{
-		int stack_top_mat_index = stack[stack_position].material_index;
-		stack_position--;
-
-		if (inside_material)
-		{
-			int previous_same_mat_index;
-			for (previous_same_mat_index = stack_position; previous_same_mat_index >= 0; previous_same_mat_index--)
-				if (stack[previous_same_mat_index].material_index == stack_top_mat_index)
-					break;
-
-			if (previous_same_mat_index >= 0)
-				for (int i = previous_same_mat_index + 1; i <= stack_position; i++)
-					stack[i - 1] = stack[i];
-
-			stack_position--;
-		}
-
-		for (int i = stack_position; i >= 0; i--)
-		{
-			if (stack[i].material_index == stack_top_mat_index)
-			{
-				stack[i].topmost = true;
-				break;
-			}
-		}
-	}
-
-	StackEntry stack[NestedDielectricsStackSize];
-
-	int stack_position = 0;
-};
-
-struct StackPriorityEntry
-{
-	// How many bits for encoding the packed priority
-	static constexpr unsigned int PRIORITY_BITS = 4;
-	static constexpr unsigned int PRIORITY_MAXIMUM = (1 << PRIORITY_BITS) - 1;
-	// How many bits for encoding the topmost flag
-	static constexpr unsigned int TOPMOST_BITS = 1;
-	// How many bits for encoding the odd_parity flag
-	static constexpr unsigned int ODD_PARTIY_BITS = 1;
-
-	// How many bits for encoding the material_index flag
-	// 
-	// This is the rest of the bits after we've added the other 
-	// flags
-	static constexpr unsigned int MATERIAL_INDEX_BITS = 32 - PRIORITY_BITS - TOPMOST_BITS - ODD_PARTIY_BITS;
-	static constexpr unsigned int MATERIAL_INDEX_MAXIMUM = (1 << MATERIAL_INDEX_BITS) - 1;
-
-	HIPRT_HOST_DEVICE StackPriorityEntry()
-	{
-		priority = 0;
-		odd_parity = true;
-		topmost = true;
-		// Setting the material index to the maximum
-		material_index = MATERIAL_INDEX_MAXIMUM;
-	}
-
-	// Using bitfields to pack the data in a single 32 bits variable and still keep a nice syntax
-	unsigned int priority : ODD_PARTIY_BITS;
-	bool odd_parity : PRIORITY_BITS;
-	bool topmost : TOPMOST_BITS;
-	unsigned int material_index : MATERIAL_INDEX_BITS;
 };
 
 template <>
-struct InteriorStackImpl<ISS_WITH_PRIORITIES>
+struct InteriorStackImpl<ISS_WITH_PRIORITIES> : public InteriorStackBase
 {
-	HIPRT_HOST_DEVICE bool push(int& incident_material_index, int& outgoing_material_index, bool& inside_material, int material_index, int material_priority)
+	HIPRT_HOST_DEVICE bool push(int material_index, int material_priority)
 	{
 		// Index of the material we last entered before intersecting the
 		// material we're currently inserting in the stack
@@ -223,68 +266,20 @@ struct InteriorStackImpl<ISS_WITH_PRIORITIES>
 			if (odd_parity)
 			{
 				// We are entering the material
-				incident_material_index = stack[last_entered_mat_index].material_index;
-				outgoing_material_index = material_index;
+				incident_mat_index = stack[last_entered_mat_index].material_index;
+				outgoing_mat_index = material_index;
 			}
 			else
 			{
 				// Exiting material
-				incident_material_index = material_index;
-				outgoing_material_index = stack[last_entered_mat_index].material_index;
+				incident_mat_index = material_index;
+				outgoing_mat_index = stack[last_entered_mat_index].material_index;
 			}
 
 			// Not skipping the boundary
 			return false;
 		}
 	}
-
-	HIPRT_HOST_DEVICE void pop(const bool inside_material)
-	{
-		int stack_top_mat_index = stack[stack_position].material_index;
-		if (stack_position > 0)
-			// Checking that we have room to pop.
-			// For a very small stack (size of 2) that overflown 
-			// (we couldn't push all the material we needed to because of 
-			// stack size constraint), it can happen that the stack position
-			// at this point is already 0 and we cannot pop.
-			stack_position--;
-
-		if (inside_material)
-		{
-			int previous_same_mat_index;
-			for (previous_same_mat_index = stack_position; previous_same_mat_index >= 0; previous_same_mat_index--)
-				if (stack[previous_same_mat_index].material_index == stack_top_mat_index)
-					break;
-
-			if (previous_same_mat_index >= 0)
-				for (int i = previous_same_mat_index + 1; i <= stack_position; i++)
-					stack[i - 1] = stack[i];
-
-			// For very small stacks (2 for example), we may not be able to pop twice
-			// at all so we check the position on the stack first
-			if (stack_position > 0)
-				stack_position--;
-		}
-
-		for (int i = stack_position; i >= 0; i--)
-		{
-			if (stack[i].material_index == stack_top_mat_index)
-			{
-				stack[i].topmost = true;
-				break;
-			}
-		}
-	}
-
-	// We only need all of this if the stack size is actually > 0,
-	// otherwise, we're just not going to do the nested dielectrics handling at all
-
-	StackPriorityEntry stack[NestedDielectricsStackSize];
-	static constexpr unsigned int MAX_MATERIAL_INDEX = StackPriorityEntry::MATERIAL_INDEX_MAXIMUM;
-
-	// Stack position is pointing at the last valid entry.
-	// Entry 0 is always present and represent air basically
-	int stack_position = 0;
 };
 
 #endif
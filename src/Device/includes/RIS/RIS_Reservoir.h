@@ -12,9 +12,9 @@
 #ifndef __KERNELCC__
 #include "Utils/Utils.h"
 
- // For multithreaded console error logging on the CPU if NaNs are detected
-#include <mutex>
-static std::mutex ris_log_mutex;
+#include "UI/ImGui/ImGuiLogger.h"
+
+extern ImGuiLogger g_imgui_logger;
 #endif
 
 struct RISSample
@@ -54,50 +54,42 @@ struct RISReservoir
 #ifndef __KERNELCC__
         if (M < 0)
         {
-            std::lock_guard<std::mutex> lock(ris_log_mutex);
-            std::cerr << "Negative reservoir M value at pixel (" << pixel_coords.x << ", " << pixel_coords.y << "): " << M << std::endl;
+            g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "Negative reservoir M value at pixel (%d, %d): %u", pixel_coords.x, pixel_coords.y, M);
             Utils::debugbreak();
         }
         else if (std::isnan(weight_sum) || std::isinf(weight_sum))
         {
-            std::lock_guard<std::mutex> lock(ris_log_mutex);
-            std::cerr << "NaN or inf reservoir weight_sum at pixel (" << pixel_coords.x << ", " << pixel_coords.y << ")" << std::endl;
+            g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "NaN or inf reservoir weight_sum at pixel (%d, %d)", pixel_coords.x, pixel_coords.y);
             Utils::debugbreak();
         }
         else if (weight_sum < 0)
         {
-            std::lock_guard<std::mutex> lock(ris_log_mutex);
-            std::cerr << "Negative reservoir weight_sum at pixel (" << pixel_coords.x << ", " << pixel_coords.y << "): " << weight_sum << std::endl;
+            g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "Negative reservoir weight_sum at pixel (%d, %d): %f", pixel_coords.x, pixel_coords.y, weight_sum);
             Utils::debugbreak();
         }
         else if (std::abs(weight_sum) < std::numeric_limits<float>::min() && weight_sum != 0.0f)
         {
-            std::lock_guard<std::mutex> lock(ris_log_mutex);
-            std::cerr << "Denormalized weight_sum at pixel (" << pixel_coords.x << ", " << pixel_coords.y << "): " << weight_sum << std::endl;
+            g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "Denormalized weight_sum at pixel (%d, %d): %e", pixel_coords.x, pixel_coords.y, weight_sum);
             Utils::debugbreak();
         }
         else if (std::isnan(UCW) || std::isinf(UCW))
         {
-            std::lock_guard<std::mutex> lock(ris_log_mutex);
-            std::cerr << "NaN or inf reservoir UCW at pixel (" << pixel_coords.x << ", " << pixel_coords.y << ")" << std::endl;
+            g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "NaN or inf reservoir UCW at pixel (%d, %d)", pixel_coords.x, pixel_coords.y);
             Utils::debugbreak();
         }
         else if (UCW < 0)
         {
-            std::lock_guard<std::mutex> lock(ris_log_mutex);
-            std::cerr << "Negative reservoir UCW at pixel (" << pixel_coords.x << ", " << pixel_coords.y << "): " << UCW << std::endl;
+            g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "Negative reservoir UCW at pixel (%d, %d): %f", pixel_coords.x, pixel_coords.y, UCW);
             Utils::debugbreak();
         }
         else if (std::isnan(sample.target_function) || std::isinf(sample.target_function))
         {
-            std::lock_guard<std::mutex> lock(ris_log_mutex);
-            std::cerr << "NaN or inf reservoir sample.target_function at pixel (" << pixel_coords.x << ", " << pixel_coords.y << ")" << std::endl;
+            g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "NaN or inf reservoir sample.target_function at pixel (%d, %d)", pixel_coords.x, pixel_coords.y);
             Utils::debugbreak();
         }
         else if (sample.target_function < 0)
         {
-            std::lock_guard<std::mutex> lock(ris_log_mutex);
-            std::cerr << "Negative reservoir sample.target_function at pixel (" << pixel_coords.x << ", " << pixel_coords.y << "): " << sample.target_function << std::endl;
+            g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "Negative reservoir sample.target_function at pixel (%d, %d): %f", pixel_coords.x, pixel_coords.y, sample.target_function);
             Utils::debugbreak();
         }
 #else
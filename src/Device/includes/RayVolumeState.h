@@ -8,16 +8,14 @@
 
 #include "Device/includes/NestedDielectrics.h"
 
+/**
+ * Everything here is 4 bytes aligned and packed: the size of the structure is
+ * (NestedDielectricsStackSize + 4) * 4 bytes. See the RayVolumeStateSize kernel
+ */
 struct RayVolumeState
 {
 	// How far has the ray traveled in the current volume.
 	float distance_in_volume = 0.0f;
-	// The stack of materials being traversed. Used for nested dielectrics handling
-	InteriorStackImpl<InteriorStackStrategy> interior_stack;
-	// Indices of the material we were in before hitting the current dielectric surface
-	int incident_mat_index = -1, outgoing_mat_index = -1;
-	// Whether or not we're exiting a material
-	bool inside_material = false;
 
 	// For spectral dispersion. A random wavelength is sampled and replaces this value
 	// when a glass object is hit. This wavelength can then be used to determine the IOR
@@ -29,6 +27,11 @@ struct RayVolumeState
 	// If this value is negative, this is because the ray throughput filter hasn't been applied
 	// yet. If the value is positive, the filter has been applied
 	float sampled_wavelength = 0.0f;
+
+	// The stack of materials being traversed. Used for nested dielectrics handling.
+	// Also holds the incident and outgoing material indices of the last dielectric
+	// surface hit and whether or not we're exiting a material
+	InteriorStackImpl<InteriorStackStrategy> interior_stack;
 };
 
 #endif
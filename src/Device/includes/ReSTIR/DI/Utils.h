@@ -60,7 +60,7 @@ HIPRT_HOST_DEVICE HIPRT_INLINE float ReSTIR_DI_evaluate_target_function<KERNEL_O
 	else
 	{
 		int material_index = render_data.buffers.material_indices[sample.emissive_triangle_index];
-		sample_emission = render_data.buffers.materials_buffer[material_index].get_emission();
+		sample_emission = render_data.buffers.materials_buffer.get_emission(material_index);
 	}
 
 	float target_function = (bsdf_color * sample_emission * cosine_term).luminance();
@@ -111,7 +111,7 @@ HIPRT_HOST_DEVICE HIPRT_INLINE float ReSTIR_DI_evaluate_target_function<KERNEL_O
 	else
 	{
 		int material_index = render_data.buffers.material_indices[sample.emissive_triangle_index];
-		sample_emission = render_data.buffers.materials_buffer[material_index].get_emission();
+		sample_emission = render_data.buffers.materials_buffer.get_emission(material_index);
 	}
 
 	float target_function = (bsdf_color * sample_emission * cosine_term).luminance();
@@ -217,7 +217,7 @@ HIPRT_HOST_DEVICE HIPRT_INLINE bool plane_distance_heuristic(const ReSTIRDISetti
 
 HIPRT_HOST_DEVICE HIPRT_INLINE bool normal_similarity_heuristic(const ReSTIRDISettings& restir_di_settings, const float3& current_normal, const float3& neighbor_normal, float threshold)
 {
-	if (restir_di_settings.use_normal_similarity_heuristic)
+	if (!restir_di_settings.use_normal_similarity_heuristic)
 		return true;
 
 	return hippt::dot(current_normal, neighbor_normal) > threshold;
@@ -243,6 +243,7 @@ HIPRT_HOST_DEVICE HIPRT_INLINE bool roughness_similarity_heuristic(const ReSTIRD
 HIPRT_HOST_DEVICE HIPRT_INLINE bool check_neighbor_similarity_heuristics(const HIPRTRenderData& render_data, int neighbor_pixel_index, int center_pixel_index, const float3& current_shading_point, const float3& current_normal, bool previous_frame = false)
 {
 	float3 neighbor_world_space_point;
+	float3 neighbor_normal;
 	float neighbor_roughness = 0.0f;
 	float current_material_roughness = 0.0f;
 
@@ -255,10 +256,13 @@ HIPRT_HOST_DEVICE HIPRT_INLINE bool check_neighbor_similarity_heuristics(const H
 		if (render_data.render_settings.restir_di_settings.use_roughness_similarity_heuristic)
 			// Only getting the roughness for the roughness heuristic otherwise it's not going to be used
 			neighbor_roughness = render_data.g_buffer_prev_frame.materials[neighbor_pixel_index].roughness;
+
+		neighbor_normal = render_data.g_buffer_prev_frame.shading_normals[neighbor_pixel_index];
 	}
 	else
 	{
 		neighbor_world_space_point = render_data.g_buffer.first_hits[neighbor_pixel_index];
+		neighbor_normal = render_data.g_buffer.shading_normals[neighbor_pixel_index];
 		neighbor_roughness = render_data.g_buffer.materials[neighbor_pixel_index].roughness;
 	}
 
@@ -267,7 +271,7 @@ HIPRT_HOST_DEVICE HIPRT_INLINE bool check_neighbor_similarity_heuristics(const H
 		current_material_roughness = render_data.g_buffer.materials[center_pixel_index].roughness;
 
 	bool plane_distance_passed = plane_distance_heuristic(render_data.render_settings.restir_di_settings, neighbor_world_space_point, current_shading_point, current_normal, render_data.render_settings.restir_di_settings.plane_distance_threshold);
-	bool normal_similarity_passed = normal_similarity_heuristic(render_data.render_settings.restir_di_settings, current_normal, render_data.g_buffer.shading_normals[neighbor_pixel_index], render_data.render_settings.restir_di_settings.normal_similarity_angle_precomp);
+	bool normal_similarity_passed = normal_similarity_heuristic(render_data.render_settings.restir_di_settings, current_normal, neighbor_normal, render_data.render_settings.restir_di_settings.normal_similarity_angle_precomp);
 	bool roughness_similarity_passed = roughness_similarity_heuristic(render_data.render_settings.restir_di_settings, neighbor_roughness, current_material_roughness, render_data.render_settings.restir_di_settings.roughness_similarity_threshold);
 	bool neighbor_is_emissive = previous_frame ? render_data.g_buffer_prev_frame.materials[neighbor_pixel_index].is_emissive() : render_data.g_buffer.materials[neighbor_pixel_index].is_emissive();
 
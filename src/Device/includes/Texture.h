@@ -21,6 +21,7 @@
 // purely for the compiler to be happy
 using Image8Bit = int;
 using Image32Bit = int;
+using Image32BitView = int;
 #endif
 
 // Templated here so that the CPU can cast the texture_buffer into Image8Bit or Image32Bit
@@ -99,6 +100,20 @@ HIPRT_HOST_DEVICE HIPRT_INLINE ColorRGB32F sample_texture_rgb_32bits(const void*
     return ColorRGB32F(rgba.r, rgba.g, rgba.b);
 }
 
+/**
+ * Same as 'sample_texture_rgb_32bits' but on the CPU, 'texture_buffer' is expected
+ * to point to Image32BitView(s) instead of Image32Bit(s).
+ * 
+ * This is used for the LUTs that are read directly from constant arrays
+ * on the CPU (no copy into an Image32Bit)
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE ColorRGB32F sample_texture_view_rgb_32bits(const void* texture_buffer, int texture_index, int2 texture_dims, bool is_srgb, float2 uv)
+{
+    ColorRGBA32F rgba = sample_texture_rgba<Image32BitView>(texture_buffer, texture_index, texture_dims, is_srgb, uv);
+
+    return ColorRGB32F(rgba.r, rgba.g, rgba.b);
+}
+
 #ifdef __KERNELCC__
 /**
  * Bilinearly samples around x & y on the layer z of a 3D texture configured for
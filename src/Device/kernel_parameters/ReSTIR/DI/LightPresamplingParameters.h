@@ -11,7 +11,7 @@
 
 #include "HostDeviceCommon/WorldSettings.h"
 
-struct RendererMaterial;
+struct MaterialHotData;
 
 struct LightPresamplingParameters
 {
@@ -34,7 +34,8 @@ struct LightPresamplingParameters
 	int* triangles_indices = nullptr;
 	float3* vertices_positions = nullptr;
 	int* material_indices = nullptr;
-	RendererMaterial* materials = nullptr;
+	// Hot block of the materials, only the emission is needed
+	MaterialHotData* materials = nullptr;
 
 	// World settings for sampling the envmap
 	WorldSettings world_settings;
@@ -38,8 +38,25 @@ HIPRT_HOST_DEVICE HIPRT_INLINE void reset_render(const HIPRTRenderData& render_d
         // These buffers are only available when either the adaptive sampling or the stop noise threshold is enabled
         render_data.aux_buffers.pixel_sample_count[pixel_index] = 0;
         render_data.aux_buffers.pixel_squared_luminance[pixel_index] = 0;
+        render_data.aux_buffers.pixel_color_sum[pixel_index] = ColorRGB32F(0.0f);
+        render_data.aux_buffers.pixel_odd_color_sum[pixel_index] = ColorRGB32F(0.0f);
         render_data.aux_buffers.pixel_converged_sample_count[pixel_index] = -1;
     }
+
+    if (render_data.render_settings.use_partial_material_reset)
+        render_data.aux_buffers.pixel_material_filter[pixel_index] = 0;
+}
+
+/**
+ * Returns true if the paths of the pixel may have hit one of the materials
+ * edited since the last pass (see HIPRTRenderSettings::material_reset_filter)
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE bool pixel_needs_material_reset(const HIPRTRenderData& render_data, uint32_t pixel_index)
+{
+    if (render_data.render_settings.material_reset_filter == 0 || !render_data.render_settings.can_partially_reset_render())
+        return false;
+
+    return render_data.aux_buffers.pixel_material_filter[pixel_index] & render_data.render_settings.material_reset_filter;
 }
 
 #ifdef __KERNELCC__
@@ -57,23 +74,10 @@ GLOBAL_KERNEL_SIGNATURE(void) inline CameraRays(HIPRTRenderData render_data, int
 
     uint32_t pixel_index = x + y * res.x;
 
-    // 'Render low resolution' means that the user is moving the camera for example
-    // so we're going to reduce the quality of the render for increased framerates
-    // while moving
-    if (render_data.render_settings.do_render_low_resolution())
-    {
-        int res_scaling = render_data.render_settings.render_low_resolution_scaling;
-
-        // If rendering at low resolution, only one pixel out of res_scaling^2 will be rendered
-        if (x % res_scaling != 0 || y % res_scaling != 0)
-        {
-            render_data.aux_buffers.pixel_active[pixel_index] = false;
-
-            return;
-        }
-
-        pixel_index /= res_scaling;
-    }
+    if (pixel_index == 0 && render_data.render_settings.has_access_to_adaptive_sampling_buffers())
+        // Nobody reads or accumulates into that slot during this pass. This is the slot
+        // of the next pass, see redistributed_sample_count()
+        render_data.aux_buffers.adaptive_sampling_error_sums[(render_data.render_settings.sample_number + 1) % 3] = 0.0f;
 
     if (render_data.render_settings.use_prev_frame_g_buffer())
     {
@@ -89,12 +93,36 @@ GLOBAL_KERNEL_SIGNATURE(void) inline CameraRays(HIPRTRenderData render_data, int
 
     if (render_data.render_settings.sample_number == 0 || render_data.render_settings.need_to_reset)
         reset_render(render_data, pixel_index);
+    else if (pixel_needs_material_reset(render_data, pixel_index))
+    {
+        reset_render(render_data, pixel_index);
+
+        if (render_data.render_settings.use_tile_convergence)
+        {
+            // The tile of the pixel has to converge again. The other pixels of the tile may
+            // have read the flag before this write and skip this pass, that's fine
+            int2 tile_count = render_data.render_settings.get_convergence_tile_count(res);
+            int tile_index = x / render_data.render_settings.convergence_tile_size + y / render_data.render_settings.convergence_tile_size * tile_count.x;
+
+            render_data.aux_buffers.tile_converged[tile_index] = 0;
+        }
+    }
+
+    if (is_pixel_tile_converged(render_data, x, y, res))
+    {
+        // The whole tile of the pixel has converged. On the GPU, the tiles are made of whole
+        // blocks of threads so all the threads of the block exit here together
+        if (!render_data.render_settings.temporal_accumulation.do_temporal_reprojection)
+            resolve_adaptive_sampling_pixel(render_data, pixel_index);
+        render_data.aux_buffers.pixel_active[pixel_index] = 0;
+
+        return;
+    }
 
-    bool sampling_needed = true;
     bool pixel_converged = false;
-    sampling_needed = adaptive_sampling(render_data, pixel_index, pixel_converged);
+    int pass_sample_count = adaptive_sampling(render_data, pixel_index, res, pixel_converged);
     
-    if (pixel_converged || !sampling_needed)
+    if (pixel_converged)
     {
         if (render_data.render_settings.do_update_status_buffers)
             // Updating if we have the right to (when do_update_status_buffers is true).
@@ -106,22 +134,18 @@ GLOBAL_KERNEL_SIGNATURE(void) inline CameraRays(HIPRTRenderData render_data, int
 
     if (render_data.render_settings.has_access_to_adaptive_sampling_buffers())
     {
-        if (!sampling_needed)
+        if (pass_sample_count == 0)
         {
-            // Because when displaying the framebuffer, we're dividing by the number of samples to 
-            // rescale the color of a pixel, we're going to have a problem if some pixels stopped samping
-            // at 10 samples while the other pixels are still being sampled and have 100 samples for example. 
-            // The pixels that only received 10 samples are going to be divided by 100 at display time, making them
-            // appear too dark.
-            // We're rescaling the color of the pixels that stopped sampling here for correct display
-
-            render_data.buffers.pixels[pixel_index] = render_data.buffers.pixels[pixel_index] / render_data.render_settings.sample_number * (render_data.render_settings.sample_number + 1);
-            render_data.aux_buffers.pixel_active[pixel_index] = false;
+            // Converged or skipped for this pass by the redistribution of the samples.
+            // The framebuffer still has to follow the number of passes for display
+            if (!render_data.render_settings.temporal_accumulation.do_temporal_reprojection)
+                resolve_adaptive_sampling_pixel(render_data, pixel_index);
+            render_data.aux_buffers.pixel_active[pixel_index] = 0;
 
             return;
         }
         else
-            render_data.aux_buffers.pixel_sample_count[pixel_index]++;
+            render_data.aux_buffers.pixel_sample_count[pixel_index] += pass_sample_count;
     }
 
     unsigned int seed;
@@ -167,7 +191,7 @@ GLOBAL_KERNEL_SIGNATURE(void) inline CameraRays(HIPRTRenderData render_data, int
 
     render_data.g_buffer.view_directions[pixel_index] = -ray.direction;
     render_data.g_buffer.camera_ray_hit[pixel_index] = intersection_found;
-    render_data.aux_buffers.pixel_active[pixel_index] = true;
+    render_data.aux_buffers.pixel_active[pixel_index] = pass_sample_count;
 
     // If we got here, this means that we still have at least one ray active
     if (render_data.render_settings.do_update_status_buffers)
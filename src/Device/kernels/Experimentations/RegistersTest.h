@@ -415,15 +415,21 @@ GLOBAL_KERNEL_SIGNATURE(void) inline TestFunction(HIPRTRenderData render_data, i
 
     float pdf;
     int mat_index = (int)(threadId * randomGenerator() * 50);
-    RendererMaterial mat = render_data.buffers.materials_buffer[(int)(threadId * randomGenerator() * 50) % 10];
+    RendererMaterial mat = render_data.buffers.materials_buffer.get_material((int)(threadId * randomGenerator() * 50) % 10);
     ColorRGB32F eval_out = bsdf_dispatcher_eval(render_data.buffers.materials_buffer, mat, render_data.g_buffer.ray_volume_states[threadId], make_float3(0.5, 1.0, 2), make_float3(0.5, 1.0, 2), make_float3(0.5, 1.0, 2), pdf);
 
-    int incident, outgoing;
-    bool leaving;
-    render_data.g_buffer.ray_volume_states[threadId].interior_stack.push(incident, outgoing, leaving, mat_index, render_data.buffers.materials_buffer[mat_index].dielectric_priority);
-    render_data.g_buffer.ray_volume_states[threadId].interior_stack.push(incident, outgoing, leaving, mat_index + 5, render_data.buffers.materials_buffer[mat_index + 5].dielectric_priority);
-    render_data.g_buffer.ray_volume_states[threadId].interior_stack.push(incident, outgoing, leaving, mat_index * 5, render_data.buffers.materials_buffer[mat_index * 5].dielectric_priority);
-    render_data.g_buffer.ray_volume_states[threadId].interior_stack.push(incident, outgoing, leaving, mat_index * 25, render_data.buffers.materials_buffer[mat_index * 25].dielectric_priority);
+    bool skipping = false;
+    skipping |= render_data.g_buffer.ray_volume_states[threadId].interior_stack.push(mat_index, render_data.buffers.materials_buffer.hot[mat_index].dielectric_priority);
+    skipping |= render_data.g_buffer.ray_volume_states[threadId].interior_stack.push(mat_index + 5, render_data.buffers.materials_buffer.hot[mat_index + 5].dielectric_priority);
+    skipping |= render_data.g_buffer.ray_volume_states[threadId].interior_stack.push(mat_index * 5, render_data.buffers.materials_buffer.hot[mat_index * 5].dielectric_priority);
+    skipping |= render_data.g_buffer.ray_volume_states[threadId].interior_stack.push(mat_index * 25, render_data.buffers.materials_buffer.hot[mat_index * 25].dielectric_priority);
+
+    // The incident / outgoing materials and the leaving flag are read back from the stack
+    int incident = render_data.g_buffer.ray_volume_states[threadId].interior_stack.incident_mat_index;
+    int outgoing = render_data.g_buffer.ray_volume_states[threadId].interior_stack.outgoing_mat_index;
+    bool leaving = render_data.g_buffer.ray_volume_states[threadId].interior_stack.inside_material;
 
     render_data.buffers.pixels[threadId] = ColorRGB32F(render_data.g_buffer.ray_volume_states[threadId].interior_stack.stack[1].odd_parity) * eval_out;
+    if (skipping || leaving)
+        render_data.buffers.pixels[threadId] *= static_cast<float>(incident + outgoing);
 }
@@ -7,6 +7,7 @@
 #define KERNELS_FULL_PATH_TRACER_H
 
 #include "Device/includes/AdaptiveSampling.h"
+#include "Device/includes/DirectLighting.h"
 #include "Device/includes/FixIntellisense.h"
 #include "Device/includes/Lights.h"
 #include "Device/includes/Envmap.h"
@@ -15,15 +16,14 @@
 #include "Device/includes/RayPayload.h"
 #include "Device/includes/RussianRoulette.h"
 #include "Device/includes/Sampling.h"
+#include "HostDeviceCommon/PackedAOVs.h"
 #include "HostDeviceCommon/Xorshift.h"
 
 #ifndef __KERNELCC__
+#include "UI/ImGui/ImGuiLogger.h"
 #include "Utils/Utils.h" // For debugbreak in sanity_check()
 
-// For logging stuff on the CPU and avoid everything being mixed
-// up in the terminal because of multithreading
-#include <mutex>
-std::mutex g_mutex;
+extern ImGuiLogger g_imgui_logger;
 #endif
 
 HIPRT_HOST_DEVICE HIPRT_INLINE void debug_set_final_color(const HIPRTRenderData& render_data, int x, int y, int res_x, ColorRGB32F final_color)
@@ -43,7 +43,7 @@ HIPRT_HOST_DEVICE HIPRT_INLINE bool check_for_negative_color(ColorRGB32F ray_col
     if (ray_color.r < 0 || ray_color.g < 0 || ray_color.b < 0)
     {
 #ifndef __KERNELCC__
-        std::cout << "Negative color at [" << x << ", " << y << "], sample " << sample << std::endl;
+        g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "Negative color at [%d, %d], sample %d", x, y, sample);
 #endif
 
         return true;
@@ -62,8 +62,7 @@ HIPRT_HOST_DEVICE HIPRT_INLINE bool check_for_nan(ColorRGB32F ray_color, int x,
     if (hippt::is_NaN(ray_color.r) || hippt::is_NaN(ray_color.g) || hippt::is_NaN(ray_color.b))
     {
 #ifndef __KERNELCC__
-        std::lock_guard<std::mutex> logging_lock(g_mutex);
-        std::cout << "NaN at [" << x << ", " << y << "], sample" << sample << std::endl;
+        g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "NaN at [%d, %d], sample %d", x, y, sample);
 #endif
         return true;
     }
@@ -96,60 +95,95 @@ HIPRT_HOST_DEVICE HIPRT_INLINE bool sanity_check(const HIPRTRenderData& render_d
     return !invalid;
 }
 
-#ifdef __KERNELCC__
-GLOBAL_KERNEL_SIGNATURE(void) __launch_bounds__(64) FullPathTracer(HIPRTRenderData render_data, int2 res)
-#else
-GLOBAL_KERNEL_SIGNATURE(void) inline FullPathTracer(HIPRTRenderData render_data, int2 res, int x, int y)
-#endif
+/**
+ * Accumulates the albedo and normal of this pass in the running averages
+ * of the denoiser AOVs, packed or not depending on render_settings.use_compact_AOVs.
+ * 
+ * 'accumulated_weight' is the weight of what the AOVs of the pixel already hold and
+ * 'pass_weight' the weight of the AOVs of this pass. If 'accumulated_weight' is 0, the AOVs
+ * of the pixel are overwritten by this pass
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE void accumulate_denoiser_AOVs(const HIPRTRenderData& render_data, uint32_t pixel_index, const ColorRGB32F& denoiser_albedo, const float3& denoiser_normal, float accumulated_weight, float pass_weight)
 {
-#ifdef __KERNELCC__
-    const uint32_t x = blockIdx.x * blockDim.x + threadIdx.x;
-    const uint32_t y = blockIdx.y * blockDim.y + threadIdx.y;
-#endif
-    if (x >= res.x || y >= res.y)
-        return;
+    const AuxiliaryBuffers& aux_buffers = render_data.aux_buffers;
+    bool restart_accumulation = accumulated_weight == 0.0f;
+    float total_weight = accumulated_weight + pass_weight;
 
-    uint32_t pixel_index = x + y * res.x;
+    if (render_data.render_settings.use_compact_AOVs)
+    {
+        if (restart_accumulation)
+        {
+            aux_buffers.packed_denoiser_albedo[pixel_index] = pack_RGB9E5(denoiser_albedo);
+            if (!hippt::is_zero(hippt::length(denoiser_normal)))
+                aux_buffers.packed_denoiser_normals[pixel_index] = pack_octahedral_normal(denoiser_normal);
+            else
+                // Any unit vector, the octahedral encoding can't represent the zero vector
+                aux_buffers.packed_denoiser_normals[pixel_index] = pack_octahedral_normal(make_float3(0.0f, 0.0f, 1.0f));
+        }
+        else
+        {
+            ColorRGB32F accumulated_albedo = (unpack_RGB9E5(aux_buffers.packed_denoiser_albedo[pixel_index]) * accumulated_weight + denoiser_albedo * pass_weight) / total_weight;
+            aux_buffers.packed_denoiser_albedo[pixel_index] = pack_RGB9E5(accumulated_albedo);
 
-    if (!render_data.aux_buffers.pixel_active[pixel_index])
-        return;
+            float3 accumulated_normal = (unpack_octahedral_normal(aux_buffers.packed_denoiser_normals[pixel_index]) * accumulated_weight + denoiser_normal * pass_weight) / total_weight;
+            float normal_length = hippt::length(accumulated_normal);
+            if (!hippt::is_zero(normal_length))
+                aux_buffers.packed_denoiser_normals[pixel_index] = pack_octahedral_normal(accumulated_normal / normal_length);
+        }
 
-    if (render_data.render_settings.do_render_low_resolution())
-    {
-        // Reducing the number of bounces to 3 if rendering at low resolution
-        // for better interactivity
-        render_data.render_settings.nb_bounces = hippt::min(3, render_data.render_settings.nb_bounces);
+        return;
     }
 
-    unsigned int seed;
-    if (render_data.render_settings.freeze_random)
-        seed = wang_hash(pixel_index + 1);
+    if (restart_accumulation)
+        aux_buffers.denoiser_albedo[pixel_index] = denoiser_albedo;
     else
-        seed = wang_hash((pixel_index + 1) * (render_data.render_settings.sample_number + 1) * render_data.random_seed);
-    Xorshift32Generator random_number_generator(seed);
+        aux_buffers.denoiser_albedo[pixel_index] = (aux_buffers.denoiser_albedo[pixel_index] * accumulated_weight + denoiser_albedo * pass_weight) / total_weight;
 
-    float squared_luminance_of_samples = 0.0f;
-    ColorRGB32F denoiser_albedo = ColorRGB32F(0.0f, 0.0f, 0.0f);
-    float3 denoiser_normal = make_float3(0.0f, 0.0f, 0.0f);
-
-    // Initializing the closest hit info the information from the camera ray pass
-    HitInfo closest_hit_info;
-    closest_hit_info.inter_point = render_data.g_buffer.first_hits[pixel_index];
-    closest_hit_info.geometric_normal = hippt::normalize(render_data.g_buffer.geometric_normals[pixel_index]);
-    closest_hit_info.shading_normal = hippt::normalize(render_data.g_buffer.shading_normals[pixel_index]);
-    closest_hit_info.primitive_index = render_data.g_buffer.first_hit_prim_index[pixel_index];
-
-    // Initializing the ray with the information from the camera ray pass
-    hiprtRay ray;
-    ray.direction = hippt::normalize(-render_data.g_buffer.view_directions[pixel_index]);
+    if (restart_accumulation)
+        aux_buffers.denoiser_normals[pixel_index] = denoiser_normal;
+    else
+    {
+        float3 accumulated_normal = (aux_buffers.denoiser_normals[pixel_index] * accumulated_weight + denoiser_normal * pass_weight) / total_weight;
+        float normal_length = hippt::length(accumulated_normal);
+        if (!hippt::is_zero(normal_length))
+            // Checking that it is non-zero otherwise we would accumulate a persistent NaN in the buffer when normalizing by the 0-length
+            aux_buffers.denoiser_normals[pixel_index] = accumulated_normal / normal_length;
+    }
+}
 
-    bool intersection_found = render_data.g_buffer.camera_ray_hit[pixel_index] == 1;
+/**
+ * Traces a new camera ray through the pixel for the samples of a pass after the first one
+ * (adaptive sampling may give several samples to a pixel in one pass). The first sample
+ * of the pass starts from the camera ray traced by the camera ray pass, in the G-buffer
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE bool trace_additional_camera_ray(const HIPRTRenderData& render_data, int x, int y, int2 res, hiprtRay& ray, RayPayload& ray_payload, HitInfo& closest_hit_info, Xorshift32Generator& random_number_generator)
+{
+    // Direction to the center of the pixel
+    float x_ray_point_direction = (x + 0.5f);
+    float y_ray_point_direction = (y + 0.5f);
+    if (render_data.current_camera.do_jittering)
+    {
+        // Jitter randomly around the center
+        x_ray_point_direction += random_number_generator() - 0.5f;
+        y_ray_point_direction += random_number_generator() - 0.5f;
+    }
 
-    RayPayload ray_payload;
+    ray = render_data.current_camera.get_camera_ray(x_ray_point_direction, y_ray_point_direction, res);
     ray_payload.next_ray_state = RayState::BOUNCE;
-    ray_payload.material = render_data.g_buffer.materials[pixel_index];
-    ray_payload.volume_state = render_data.g_buffer.ray_volume_states[pixel_index];
 
+    return trace_ray(render_data, ray, ray_payload, closest_hit_info, /* camera ray = no previous primitive hit */ -1, random_number_generator);
+}
+
+/**
+ * Follows the path of one sample from its first hit: 'ray', 'ray_payload', 'closest_hit_info'
+ * and 'intersection_found' describe the camera ray, already traced.
+ * 
+ * The color of the sample is in ray_payload.ray_color. The shading normal and base color
+ * of the first hit are added to 'denoiser_normal' and 'denoiser_albedo'. The materials hit by the
+ * first render_settings.partial_material_reset_bounces bounces are added to 'material_filter'
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE void trace_path(const HIPRTRenderData& render_data, hiprtRay& ray, RayPayload& ray_payload, HitInfo& closest_hit_info, bool intersection_found, int x, int y, int2 res, Xorshift32Generator& random_number_generator, ColorRGB32F& denoiser_albedo, float3& denoiser_normal, unsigned int& material_filter)
+{
     // + 1 to nb_bounces here because we want "0" bounces to still act as one
     // hit and to return some color
     for (int bounce = 0; bounce < render_data.render_settings.nb_bounces + 1; bounce++)
@@ -171,6 +205,9 @@ GLOBAL_KERNEL_SIGNATURE(void) inline FullPathTracer(HIPRTRenderData render_data,
                     denoiser_albedo += ray_payload.material.base_color;
                 }
 
+                if (render_data.render_settings.use_partial_material_reset && bounce < render_data.render_settings.partial_material_reset_bounces)
+                    material_filter |= HIPRTRenderSettings::get_material_filter_bit(render_data.buffers.material_indices[closest_hit_info.primitive_index]);
+
                 // For the BRDF calculations, bounces, ... to be correct, we need the normal to be in the same hemisphere as
                 // the view direction. One thing that can go wrong is when we have an emissive triangle (typical area light)
                 // and a ray hits the back of the triangle. The normal will not be facing the view direction in this
@@ -188,8 +225,9 @@ GLOBAL_KERNEL_SIGNATURE(void) inline FullPathTracer(HIPRTRenderData render_data,
                 // ----------------- Direct lighting ----------------- //
                 // --------------------------------------------------- //
 
-                ColorRGB32F light_direct_contribution = sample_one_light(render_data, ray_payload, closest_hit_info, -ray.direction, random_number_generator, make_int2(x, y), res, bounce);
-                ColorRGB32F envmap_direct_contribution = sample_environment_map(render_data, ray_payload, closest_hit_info, -ray.direction, bounce, random_number_generator);
+                ColorRGB32F light_direct_contribution;
+                ColorRGB32F envmap_direct_contribution;
+                sample_direct_lighting(render_data, ray_payload, closest_hit_info, -ray.direction, random_number_generator, make_int2(x, y), res, bounce, light_direct_contribution, envmap_direct_contribution);
 
                 // Clamping direct lighting
                 light_direct_contribution = clamp_light_contribution(light_direct_contribution, render_data.render_settings.direct_contribution_clamp, bounce == 0);
@@ -288,41 +326,163 @@ GLOBAL_KERNEL_SIGNATURE(void) inline FullPathTracer(HIPRTRenderData render_data,
         else if (ray_payload.next_ray_state == RayState::MISSED)
             break;
     }
+}
 
-    // Checking for NaNs / negative value samples. Output 
-    if (!sanity_check(render_data, ray_payload, x, y, res))
+#ifdef __KERNELCC__
+GLOBAL_KERNEL_SIGNATURE(void) __launch_bounds__(64) FullPathTracer(HIPRTRenderData render_data, int2 res)
+#else
+GLOBAL_KERNEL_SIGNATURE(void) inline FullPathTracer(HIPRTRenderData render_data, int2 res, int x, int y)
+#endif
+{
+#ifdef __KERNELCC__
+    const uint32_t x = blockIdx.x * blockDim.x + threadIdx.x;
+    const uint32_t y = blockIdx.y * blockDim.y + threadIdx.y;
+#endif
+    if (x >= res.x || y >= res.y)
+        return;
+
+    uint32_t pixel_index = x + y * res.x;
+
+    // Number of samples that this pixel gets in this pass
+    int pass_sample_count = render_data.aux_buffers.pixel_active[pixel_index];
+    if (pass_sample_count == 0)
         return;
 
-    squared_luminance_of_samples += ray_payload.ray_color.luminance() * ray_payload.ray_color.luminance();
+    unsigned int seed;
+    if (render_data.render_settings.freeze_random)
+        seed = wang_hash(pixel_index + 1);
+    else
+        seed = wang_hash((pixel_index + 1) * (render_data.render_settings.sample_number + 1) * render_data.random_seed);
+    Xorshift32Generator random_number_generator(seed);
+
+    float squared_luminance_of_samples = 0.0f;
+    ColorRGB32F pass_color_sum;
+    ColorRGB32F pass_odd_color_sum;
+    // Index of the first sample of this pass among all the samples of the pixel. The pixel
+    // sample count was already incremented by the camera rays pass
+    int first_sample_index = 0;
+    // Samples of the pass that passed the sanity check, the others aren't accumulated
+    int accumulated_sample_count = 0;
+    if (render_data.render_settings.has_access_to_adaptive_sampling_buffers())
+        first_sample_index = render_data.aux_buffers.pixel_sample_count[pixel_index] - pass_sample_count;
+    ColorRGB32F denoiser_albedo = ColorRGB32F(0.0f, 0.0f, 0.0f);
+    float3 denoiser_normal = make_float3(0.0f, 0.0f, 0.0f);
+    unsigned int pass_material_filter = 0;
+
+    for (int pass_sample = 0; pass_sample < pass_sample_count; pass_sample++)
+    {
+        HitInfo closest_hit_info;
+        hiprtRay ray;
+        RayPayload ray_payload;
+        bool intersection_found;
+
+        // With ReSTIR DI, there is only one sample per pass, see redistributed_sample_count()
+        if (pass_sample == 0)
+        {
+            // Initializing the closest hit info the information from the camera ray pass
+            closest_hit_info.inter_point = render_data.g_buffer.first_hits[pixel_index];
+            closest_hit_info.geometric_normal = hippt::normalize(render_data.g_buffer.geometric_normals[pixel_index]);
+            closest_hit_info.shading_normal = hippt::normalize(render_data.g_buffer.shading_normals[pixel_index]);
+            closest_hit_info.primitive_index = render_data.g_buffer.first_hit_prim_index[pixel_index];
+
+            // Initializing the ray with the information from the camera ray pass
+            ray.direction = hippt::normalize(-render_data.g_buffer.view_directions[pixel_index]);
+
+            intersection_found = render_data.g_buffer.camera_ray_hit[pixel_index] == 1;
+
+            ray_payload.next_ray_state = RayState::BOUNCE;
+            ray_payload.material = render_data.g_buffer.materials[pixel_index];
+            ray_payload.volume_state = render_data.g_buffer.ray_volume_states[pixel_index];
+        }
+        else
+            intersection_found = trace_additional_camera_ray(render_data, x, y, res, ray, ray_payload, closest_hit_info, random_number_generator);
+
+        // Only the first sample of the pass goes in the denoiser AOVs, they are accumulated once per pass
+        ColorRGB32F sample_albedo = ColorRGB32F(0.0f, 0.0f, 0.0f);
+        float3 sample_normal = make_float3(0.0f, 0.0f, 0.0f);
+        trace_path(render_data, ray, ray_payload, closest_hit_info, intersection_found, x, y, res, random_number_generator, sample_albedo, sample_normal, pass_material_filter);
+        if (pass_sample == 0)
+        {
+            denoiser_albedo = sample_albedo;
+            denoiser_normal = sample_normal;
+        }
+
+        // Checking for NaNs / negative value samples. Output 
+        if (!sanity_check(render_data, ray_payload, x, y, res))
+            continue;
+
+        pass_color_sum += ray_payload.ray_color;
+        if ((first_sample_index + accumulated_sample_count) & 1)
+            pass_odd_color_sum += ray_payload.ray_color;
+        squared_luminance_of_samples += ray_payload.ray_color.luminance() * ray_payload.ray_color.luminance();
+        accumulated_sample_count++;
+    }
+
+    if (accumulated_sample_count < pass_sample_count)
+    {
+        // Some samples didn't pass the sanity check. With display_NaNs, the pixel keeps the
+        // debug color of sanity_check() and nothing of this pass is accumulated
+        if (render_data.render_settings.display_NaNs)
+            accumulated_sample_count = 0;
+
+        if (render_data.render_settings.has_access_to_adaptive_sampling_buffers())
+            // The camera rays pass counted all the samples of the pass
+            render_data.aux_buffers.pixel_sample_count[pixel_index] -= pass_sample_count - accumulated_sample_count;
+
+        if (render_data.render_settings.temporal_accumulation.do_temporal_reprojection)
+            // The TemporalAccumulation pass weights the average of the pass by its sample
+            // count and keeps the history as is if no sample was accumulated
+            render_data.aux_buffers.pixel_active[pixel_index] = accumulated_sample_count;
+
+        if (render_data.render_settings.display_NaNs)
+            return;
+    }
 
     // If we got here, this means that we still have at least one ray active
     render_data.aux_buffers.still_one_ray_active[0] = 1;
 
     if (render_data.render_settings.has_access_to_adaptive_sampling_buffers())
+    {
         // We can only use these buffers if the adaptive sampling or the stop noise threshold is enabled.
         // Otherwise, the buffers are destroyed to save some VRAM so they are not accessible
         render_data.aux_buffers.pixel_squared_luminance[pixel_index] += squared_luminance_of_samples;
+        render_data.aux_buffers.pixel_color_sum[pixel_index] += pass_color_sum;
+        render_data.aux_buffers.pixel_odd_color_sum[pixel_index] += pass_odd_color_sum;
+    }
 
-    if (render_data.render_settings.sample_number == 0)
-        render_data.buffers.pixels[pixel_index] = ray_payload.ray_color;
+    if (render_data.render_settings.use_partial_material_reset)
+        render_data.aux_buffers.pixel_material_filter[pixel_index] |= pass_material_filter;
+
+    if (render_data.render_settings.temporal_accumulation.do_temporal_reprojection)
+        // With temporal reprojection, the TemporalAccumulation pass
+        // reads the sample of this frame alone and does the accumulation
+        render_data.buffers.pixels[pixel_index] = pass_color_sum / static_cast<float>(hippt::max(1, accumulated_sample_count));
+    else if (render_data.render_settings.has_access_to_adaptive_sampling_buffers())
+        // The pixels may not have the same number of samples, the framebuffer
+        // is resolved from the sum and the sample count of the pixel
+        resolve_adaptive_sampling_pixel(render_data, pixel_index);
+    else if (render_data.render_settings.sample_number == 0)
+        render_data.buffers.pixels[pixel_index] = pass_color_sum;
     else
         // If we are at a sample that is not 0, this means that we are accumulating
-        render_data.buffers.pixels[pixel_index] += ray_payload.ray_color;
+        render_data.buffers.pixels[pixel_index] += pass_color_sum;
 
-    if (render_data.render_settings.sample_number == 0)
-        render_data.aux_buffers.denoiser_albedo[pixel_index] = denoiser_albedo;
-    else
-        render_data.aux_buffers.denoiser_albedo[pixel_index] = (render_data.aux_buffers.denoiser_albedo[pixel_index] * render_data.render_settings.denoiser_AOV_accumulation_counter + denoiser_albedo) / (render_data.render_settings.denoiser_AOV_accumulation_counter + 1.0f);
-
-    if (render_data.render_settings.sample_number == 0)
-        render_data.aux_buffers.denoiser_normals[pixel_index] = denoiser_normal;
-    else
+    if (!render_data.render_settings.do_render_low_resolution())
     {
-        float3 accumulated_normal = (render_data.aux_buffers.denoiser_normals[pixel_index] * render_data.render_settings.denoiser_AOV_accumulation_counter + denoiser_normal) / (render_data.render_settings.denoiser_AOV_accumulation_counter + 1.0f);
-        float normal_length = hippt::length(accumulated_normal);
-        if (!hippt::is_zero(normal_length))
-            // Checking that it is non-zero otherwise we would accumulate a persistent NaN in the buffer when normalizing by the 0-length
-            render_data.aux_buffers.denoiser_normals[pixel_index] = accumulated_normal / normal_length;
+        // One AOV sample per pass, the AOVs start over with the render
+        float AOV_accumulated_weight = render_data.render_settings.sample_number == 0 ? 0.0f : render_data.render_settings.denoiser_AOV_accumulation_counter;
+        float AOV_pass_weight = 1.0f;
+        if (render_data.render_settings.can_partially_reset_render())
+        {
+            // The pixels reset on their own by a material edit (whose albedo may have changed) don't
+            // have as many samples as the others, the AOVs are weighted by the samples of the pixel
+            AOV_accumulated_weight = first_sample_index;
+            AOV_pass_weight = accumulated_sample_count;
+        }
+
+        // In low resolution, the AOVs are written by the upsampling pass
+        // and accumulated again from the first frame at full resolution
+        accumulate_denoiser_AOVs(render_data, pixel_index, denoiser_albedo, denoiser_normal, AOV_accumulated_weight, AOV_pass_weight);
     }
 }
 
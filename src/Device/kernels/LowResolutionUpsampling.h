@@ -0,0 +1,149 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef KERNELS_LOW_RESOLUTION_UPSAMPLING_H
+#define KERNELS_LOW_RESOLUTION_UPSAMPLING_H
+
+#include "Device/includes/FixIntellisense.h"
+#include "HostDeviceCommon/PackedAOVs.h"
+#include "HostDeviceCommon/RenderData.h"
+
+/**
+ * Whether or not the low resolution pixel 'neighbor_index' saw the same surface as
+ * the low resolution pixel 'center_index', according to the depth and the normal of
+ * the G-buffer
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE bool upsampling_same_surface(const HIPRTRenderData& render_data, int neighbor_index, int center_index, const float3& camera_position)
+{
+    // Thresholds on the relative depth difference and on the cosine between the normals
+    const float depth_threshold = 0.05f;
+    const float normal_threshold = 0.9f;
+
+    bool center_hit = render_data.g_buffer.camera_ray_hit[center_index];
+    if (center_hit != render_data.g_buffer.camera_ray_hit[neighbor_index])
+        return false;
+    else if (!center_hit)
+        // Both are the background
+        return true;
+
+    float center_depth = hippt::length(render_data.g_buffer.first_hits[center_index] - camera_position);
+    float neighbor_depth = hippt::length(render_data.g_buffer.first_hits[neighbor_index] - camera_position);
+    if (hippt::abs(neighbor_depth - center_depth) > depth_threshold * center_depth)
+        return false;
+
+    float3 center_normal = hippt::normalize(render_data.g_buffer.shading_normals[center_index]);
+    float3 neighbor_normal = hippt::normalize(render_data.g_buffer.shading_normals[neighbor_index]);
+
+    return hippt::dot(center_normal, neighbor_normal) > normal_threshold;
+}
+
+/**
+ * Writes the denoiser AOVs of the full resolution pixel 'pixel_index' from the G-buffer of
+ * its closest low resolution pixel 'center_index'. These are the AOVs that the path tracer
+ * would have accumulated at the first hit of the pixel: its albedo and its shading normal,
+ * or zero for the background.
+ *
+ * The AOVs aren't interpolated so that the albedo and the normals stay sharp at the edges
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE void upsample_denoiser_AOVs(const HIPRTRenderData& render_data, uint32_t pixel_index, int center_index)
+{
+    ColorRGB32F albedo = ColorRGB32F(0.0f, 0.0f, 0.0f);
+    float3 normal = make_float3(0.0f, 0.0f, 0.0f);
+    if (render_data.g_buffer.camera_ray_hit[center_index])
+    {
+        albedo = render_data.g_buffer.materials[center_index].base_color;
+        normal = render_data.g_buffer.shading_normals[center_index];
+    }
+
+    if (render_data.render_settings.use_compact_AOVs)
+    {
+        render_data.aux_buffers.packed_denoiser_albedo[pixel_index] = pack_RGB9E5(albedo);
+        if (!hippt::is_zero(hippt::length(normal)))
+            render_data.aux_buffers.packed_denoiser_normals[pixel_index] = pack_octahedral_normal(hippt::normalize(normal));
+        else
+            // Any unit vector, the octahedral encoding can't represent the zero vector
+            render_data.aux_buffers.packed_denoiser_normals[pixel_index] = pack_octahedral_normal(make_float3(0.0f, 0.0f, 1.0f));
+    }
+    else
+    {
+        render_data.aux_buffers.denoiser_albedo[pixel_index] = albedo;
+        render_data.aux_buffers.denoiser_normals[pixel_index] = normal;
+    }
+}
+
+/**
+ * Reconstructs the full resolution framebuffer from the one rendered in
+ * render_data.aux_buffers.low_resolution_pixels when rendering at low resolution
+ * (see HIPRTRenderSettings::get_render_grid_resolution()).
+ *
+ * Each pixel bilinearly interpolates the 4 closest low resolution pixels but the ones
+ * that didn't see the same surface as the closest of the 4 are left out so that the edges
+ * of the objects aren't blurred. The G-buffer used for that is the one of the low resolution grid.
+ * The denoiser AOVs are upsampled too, see upsample_denoiser_AOVs().
+ *
+ * 'res' is the full resolution, one thread per pixel of the full resolution framebuffer
+ */
+#ifdef __KERNELCC__
+GLOBAL_KERNEL_SIGNATURE(void) __launch_bounds__(64) LowResolutionUpsampling(HIPRTRenderData render_data, int2 res)
+#else
+GLOBAL_KERNEL_SIGNATURE(void) inline LowResolutionUpsampling(HIPRTRenderData render_data, int2 res, int x, int y)
+#endif
+{
+#ifdef __KERNELCC__
+    const uint32_t x = blockIdx.x * blockDim.x + threadIdx.x;
+    const uint32_t y = blockIdx.y * blockDim.y + threadIdx.y;
+#endif
+    if (x >= res.x || y >= res.y)
+        return;
+
+    int2 low_res = render_data.render_settings.get_render_grid_resolution(res);
+    float scaling = static_cast<float>(render_data.render_settings.render_low_resolution_scaling);
+
+    // Position of the center of the pixel in the low resolution grid
+    float low_res_x = (x + 0.5f) / scaling - 0.5f;
+    float low_res_y = (y + 0.5f) / scaling - 0.5f;
+
+    int center_x = hippt::clamp(0, low_res.x - 1, static_cast<int>(roundf(low_res_x)));
+    int center_y = hippt::clamp(0, low_res.y - 1, static_cast<int>(roundf(low_res_y)));
+    int center_index = center_x + center_y * low_res.x;
+
+    float3 camera_position = matrix_X_point(render_data.current_camera.inverse_view, make_float3(0.0f, 0.0f, 0.0f));
+
+    int x0 = static_cast<int>(floorf(low_res_x));
+    int y0 = static_cast<int>(floorf(low_res_y));
+    float fraction_x = low_res_x - x0;
+    float fraction_y = low_res_y - y0;
+
+    ColorRGB32F color_sum;
+    float weight_sum = 0.0f;
+    for (int offset_y = 0; offset_y <= 1; offset_y++)
+    {
+        for (int offset_x = 0; offset_x <= 1; offset_x++)
+        {
+            int neighbor_x = hippt::clamp(0, low_res.x - 1, x0 + offset_x);
+            int neighbor_y = hippt::clamp(0, low_res.y - 1, y0 + offset_y);
+            int neighbor_index = neighbor_x + neighbor_y * low_res.x;
+
+            if (neighbor_index != center_index && !upsampling_same_surface(render_data, neighbor_index, center_index, camera_position))
+                continue;
+
+            float weight = (offset_x == 0 ? 1.0f - fraction_x : fraction_x) * (offset_y == 0 ? 1.0f - fraction_y : fraction_y);
+
+            color_sum += render_data.aux_buffers.low_resolution_pixels[neighbor_index] * weight;
+            weight_sum += weight;
+        }
+    }
+
+    uint32_t pixel_index = x + y * res.x;
+    if (weight_sum > 0.0f)
+        render_data.buffers.pixels[pixel_index] = color_sum / weight_sum;
+    else
+        // The closest pixel may have a weight of 0 if the pixel is exactly between two low resolution pixels
+        render_data.buffers.pixels[pixel_index] = render_data.aux_buffers.low_resolution_pixels[center_index];
+
+    upsample_denoiser_AOVs(render_data, pixel_index, center_index);
+}
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef KERNELS_TEMPORAL_ACCUMULATION_H
+#define KERNELS_TEMPORAL_ACCUMULATION_H
+
+#include "Device/includes/FixIntellisense.h"
+#include "Device/includes/ReSTIR/DI/Utils.h"
+#include "HostDeviceCommon/RenderData.h"
+
+/**
+ * Returns the index of the pixel of the previous frame that saw the same surface
+ * as the given pixel of the current frame.
+ *
+ * Returns -1 if there is no such pixel: background, disocclusion, out of the
+ * previous viewport or a surface that doesn't pass the similarity heuristics
+ * (plane distance, normal, roughness) or that has another material
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE int reproject_temporal_history(const HIPRTRenderData& render_data, int2 res, uint32_t pixel_index)
+{
+    if (!render_data.g_buffer.camera_ray_hit[pixel_index])
+        // Not reprojecting the background, the envmap is cheap to evaluate anyways
+        return -1;
+
+    float3 shading_point = render_data.g_buffer.first_hits[pixel_index];
+    float3 previous_ndc_point = matrix_X_point(render_data.prev_camera.view_projection, shading_point);
+    if (previous_ndc_point.z < -1.0f || previous_ndc_point.z > 1.0f)
+        // Behind the previous camera or outside of its clipping planes
+        return -1;
+
+    // Same pixel coordinates as find_temporal_neighbor_index()
+    float2 prev_pixel_float = make_float2((previous_ndc_point.x + 1.0f) * 0.5f * res.x, (previous_ndc_point.y + 1.0f) * 0.5f * res.y);
+    prev_pixel_float -= make_float2(0.5f, 0.5f);
+
+    int2 prev_pixel = make_int2(static_cast<int>(round(prev_pixel_float.x)), static_cast<int>(round(prev_pixel_float.y)));
+    if (prev_pixel.x < 0 || prev_pixel.x >= res.x || prev_pixel.y < 0 || prev_pixel.y >= res.y)
+        return -1;
+
+    int prev_pixel_index = prev_pixel.x + prev_pixel.y * res.x;
+    if (!render_data.g_buffer_prev_frame.camera_ray_hit[prev_pixel_index])
+        return -1;
+
+    if (!check_neighbor_similarity_heuristics(render_data, prev_pixel_index, pixel_index, shading_point, render_data.g_buffer.shading_normals[pixel_index], /* previous frame */ true))
+        return -1;
+
+    int material_index = render_data.buffers.material_indices[render_data.g_buffer.first_hit_prim_index[pixel_index]];
+    int prev_material_index = render_data.buffers.material_indices[render_data.g_buffer_prev_frame.first_hit_prim_index[prev_pixel_index]];
+    if (material_index != prev_material_index)
+        return -1;
+
+    return prev_pixel_index;
+}
+
+/**
+ * Blends the sample of this frame with the history of the pixel, reprojected
+ * if the camera moved (see TemporalAccumulationSettings).
+ *
+ * When render_settings.temporal_accumulation.do_temporal_reprojection is true, the path tracer
+ * writes the sample of the frame alone in the framebuffer. This pass then replaces it with
+ * the blended color, multiplied by the number of samples of the frame so that the
+ * framebuffer can still be divided by 'sample_number' by its readers.
+ *
+ * The sample of the frame is the average of the samples of the pixel in this pass
+ * (render_data.aux_buffers.pixel_active of them, see FullPathTracer), it weighs as
+ * much as that many samples of the history
+ */
+#ifdef __KERNELCC__
+GLOBAL_KERNEL_SIGNATURE(void) __launch_bounds__(64) TemporalAccumulation(HIPRTRenderData render_data, int2 res)
+#else
+GLOBAL_KERNEL_SIGNATURE(void) inline TemporalAccumulation(HIPRTRenderData render_data, int2 res, int x, int y)
+#endif
+{
+#ifdef __KERNELCC__
+    const uint32_t x = blockIdx.x * blockDim.x + threadIdx.x;
+    const uint32_t y = blockIdx.y * blockDim.y + threadIdx.y;
+#endif
+    if (x >= res.x || y >= res.y)
+        return;
+
+    uint32_t pixel_index = x + y * res.x;
+
+    const TemporalAccumulationSettings& temporal_accumulation = render_data.render_settings.temporal_accumulation;
+    float framebuffer_sample_count = render_data.render_settings.sample_number + 1.0f;
+
+    int pass_sample_count = render_data.aux_buffers.pixel_active[pixel_index];
+    if (pass_sample_count == 0)
+    {
+        // Converged according to adaptive sampling so no new sample this frame (the camera
+        // didn't move, adaptive sampling restarts when it does) or all the samples of
+        // the frame were dropped by the sanity check of the path tracer
+        temporal_accumulation.history[pixel_index] = temporal_accumulation.prev_history[pixel_index];
+        temporal_accumulation.history_length[pixel_index] = temporal_accumulation.prev_history_length[pixel_index];
+        render_data.buffers.pixels[pixel_index] = temporal_accumulation.prev_history[pixel_index] * framebuffer_sample_count;
+
+        return;
+    }
+
+    ColorRGB32F new_sample = render_data.buffers.pixels[pixel_index];
+
+    int history_length = 0;
+    ColorRGB32F history_color;
+    if (!temporal_accumulation.camera_moved)
+    {
+        // Same point of view, this is the regular progressive accumulation
+        history_length = temporal_accumulation.prev_history_length[pixel_index];
+        history_color = temporal_accumulation.prev_history[pixel_index];
+    }
+    else
+    {
+        int prev_pixel_index = reproject_temporal_history(render_data, res, pixel_index);
+        if (prev_pixel_index != -1)
+        {
+            // The history was shaded from another point of view, capping its confidence
+            // so that it fades out in a few frames if it doesn't match anymore
+            history_length = hippt::min(temporal_accumulation.prev_history_length[prev_pixel_index], temporal_accumulation.max_history_length);
+            history_color = temporal_accumulation.prev_history[prev_pixel_index];
+        }
+    }
+
+    history_length += pass_sample_count;
+
+    ColorRGB32F blended_color;
+    if (history_length == pass_sample_count)
+        blended_color = new_sample;
+    else
+        blended_color = history_color + (new_sample - history_color) * static_cast<float>(pass_sample_count) / static_cast<float>(history_length);
+
+    temporal_accumulation.history[pixel_index] = blended_color;
+    temporal_accumulation.history_length[pixel_index] = history_length;
+    render_data.buffers.pixels[pixel_index] = blended_color * framebuffer_sample_count;
+}
+
+#endif
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef KERNELS_TILE_CONVERGENCE_H
+#define KERNELS_TILE_CONVERGENCE_H
+
+#include "Device/includes/FixIntellisense.h"
+#include "HostDeviceCommon/RenderData.h"
+
+/**
+ * Returns the error of the given tile relative to its luminance.
+ *
+ * The error of a pixel is the difference between the average luminance of all its
+ * samples and the average luminance of its odd samples only. The errors and the luminances
+ * are summed over the tile before the division so that a single firefly or an almost black
+ * pixel doesn't decide of the convergence of the whole tile.
+ *
+ * This only uses sums of samples, not the sum of the squared luminances that
+ * get_pixel_confidence_interval() uses, and doesn't suffer from its loss of
+ * precision at high sample counts.
+ *
+ * Returns -1.0f if a pixel of the tile doesn't have render_settings.tile_convergence_min_samples
+ * samples yet
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE float get_tile_relative_error(const HIPRTRenderData& render_data, int2 res, int tile_x, int tile_y)
+{
+    int tile_size = render_data.render_settings.convergence_tile_size;
+
+    int start_x = tile_x * tile_size;
+    int start_y = tile_y * tile_size;
+    int stop_x = hippt::min(start_x + tile_size, res.x);
+    int stop_y = hippt::min(start_y + tile_size, res.y);
+
+    float error_sum = 0.0f;
+    float luminance_sum = 0.0f;
+    for (int y = start_y; y < stop_y; y++)
+    {
+        for (int x = start_x; x < stop_x; x++)
+        {
+            int pixel_index = x + y * res.x;
+
+            int pixel_sample_count = render_data.aux_buffers.pixel_sample_count[pixel_index];
+            if (pixel_sample_count < render_data.render_settings.tile_convergence_min_samples)
+                // The pixel was reset on its own (see pixel_needs_material_reset()), the error
+                // of its few samples would be diluted by the other pixels of the tile
+                return -1.0f;
+
+            int odd_sample_count = pixel_sample_count / 2;
+
+            float average_luminance = render_data.aux_buffers.pixel_color_sum[pixel_index].luminance() / pixel_sample_count;
+            float odd_average_luminance = render_data.aux_buffers.pixel_odd_color_sum[pixel_index].luminance() / odd_sample_count;
+
+            error_sum += hippt::abs(average_luminance - odd_average_luminance);
+            luminance_sum += average_luminance;
+        }
+    }
+
+    if (luminance_sum == 0.0f)
+        // All the samples of the tile are black, the odd ones too
+        return 0.0f;
+
+    return error_sum / luminance_sum;
+}
+
+/**
+ * Updates render_data.aux_buffers.tile_converged with the tiles that reached
+ * render_data.render_settings.tile_convergence_threshold and counts the tiles
+ * that have converged in the status buffers.
+ *
+ * One thread per tile of render_data.render_settings.convergence_tile_size pixels,
+ * launched after the path tracing pass
+ */
+#ifdef __KERNELCC__
+GLOBAL_KERNEL_SIGNATURE(void) __launch_bounds__(64) TileConvergence(HIPRTRenderData render_data, int2 res)
+#else
+GLOBAL_KERNEL_SIGNATURE(void) inline TileConvergence(HIPRTRenderData render_data, int2 res, int tile_x, int tile_y)
+#endif
+{
+#ifdef __KERNELCC__
+    const uint32_t tile_x = blockIdx.x * blockDim.x + threadIdx.x;
+    const uint32_t tile_y = blockIdx.y * blockDim.y + threadIdx.y;
+#endif
+    const HIPRTRenderSettings& render_settings = render_data.render_settings;
+
+    int2 tile_count = render_settings.get_convergence_tile_count(res);
+    if (tile_x >= tile_count.x || tile_y >= tile_count.y)
+        return;
+
+    uint32_t tile_index = tile_x + tile_y * tile_count.x;
+
+    if (render_settings.sample_number == 0 || render_settings.need_to_reset)
+        // The tiles that converged were for the previous render
+        render_data.aux_buffers.tile_converged[tile_index] = 0;
+
+    if (render_settings.do_render_low_resolution())
+        // Only a fraction of the pixels are rendered, the sums
+        // of the pixels of the tile don't mean anything
+        return;
+
+    if (!render_data.aux_buffers.tile_converged[tile_index] && render_settings.sample_number + 1 >= render_settings.tile_convergence_min_samples)
+    {
+        float tile_error = get_tile_relative_error(render_data, res, tile_x, tile_y);
+        if (tile_error >= 0.0f && tile_error <= render_settings.tile_convergence_threshold)
+            render_data.aux_buffers.tile_converged[tile_index] = 1;
+    }
+
+    if (render_data.aux_buffers.tile_converged[tile_index] && render_settings.do_update_status_buffers)
+        hippt::atomic_add(render_data.aux_buffers.converged_tile_count, 1u);
+}
+
+#endif
@@ -9,6 +9,16 @@
 #include "Device/includes/FixIntellisense.h"
 #include "Device/includes/RayVolumeState.h"
 
+// Regression checks on the packing of the nested dielectrics state, compiled
+// with the NestedDielectricsStackSize of the kernels every time it changes
+static_assert(sizeof(StackEntry) == sizeof(unsigned int), "The interior stack entries aren't packed in 32 bits anymore");
+static_assert(sizeof(InteriorStackImpl<InteriorStackStrategy>) == sizeof(StackEntry) * NestedDielectricsStackSize + 2 * sizeof(unsigned int), "The state of the interior stack isn't packed in two 32 bits words anymore");
+static_assert(sizeof(RayVolumeState) == sizeof(InteriorStackImpl<InteriorStackStrategy>) + 2 * sizeof(float), "RayVolumeState has padding");
+
+/**
+ * Returns the size in bytes of RayVolumeState for the NestedDielectricsStackSize
+ * the kernels are compiled with. Used to size the G-buffer on the host
+ */
 #ifdef __KERNELCC__
 GLOBAL_KERNEL_SIGNATURE(void) RayVolumeStateSize(size_t* out_buffer)
 #else
@@ -0,0 +1,37 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef KERNELS_UNPACK_DENOISER_AOVS_H
+#define KERNELS_UNPACK_DENOISER_AOVS_H
+
+#include "Device/includes/FixIntellisense.h"
+#include "HostDeviceCommon/PackedAOVs.h"
+#include "HostDeviceCommon/RenderData.h"
+
+/**
+ * Decodes the packed denoiser AOVs (accumulated by the path tracer when
+ * render_settings.use_compact_AOVs is true) into the full precision
+ * 'denoiser_albedo' and 'denoiser_normals' buffers read by the denoiser and the display
+ */
+#ifdef __KERNELCC__
+GLOBAL_KERNEL_SIGNATURE(void) __launch_bounds__(64) UnpackDenoiserAOVs(HIPRTRenderData render_data, int2 res)
+#else
+GLOBAL_KERNEL_SIGNATURE(void) inline UnpackDenoiserAOVs(HIPRTRenderData render_data, int2 res, int x, int y)
+#endif
+{
+#ifdef __KERNELCC__
+    const uint32_t x = blockIdx.x * blockDim.x + threadIdx.x;
+    const uint32_t y = blockIdx.y * blockDim.y + threadIdx.y;
+#endif
+    if (x >= res.x || y >= res.y)
+        return;
+
+    uint32_t pixel_index = x + y * res.x;
+
+    render_data.aux_buffers.denoiser_albedo[pixel_index] = unpack_RGB9E5(render_data.aux_buffers.packed_denoiser_albedo[pixel_index]);
+    render_data.aux_buffers.denoiser_normals[pixel_index] = unpack_octahedral_normal(render_data.aux_buffers.packed_denoiser_normals[pixel_index]);
+}
+
+#endif
@@ -9,6 +9,7 @@
 #include "HIPRT-Orochi/HIPRTOrochiUtils.h"
 #include "HIPRT-Orochi/OrochiTexture.h"
 #include "HostDeviceCommon/Material.h"
+#include "HostDeviceCommon/MaterialsSoA.h"
 #include "UI/ImGui/ImGuiLogger.h"
 
 #include "hiprt/hiprt.h"
@@ -99,7 +100,7 @@ struct HIPRTScene
 		stream << "\t" << geometry.m_mesh.vertexCount << " vertices" << std::endl;
 		stream << "\t" << geometry.m_mesh.triangleCount << " vertices" << std::endl;
 		stream << "\t" << emissive_triangles_indices.get_element_count() << " emissive triangles" << std::endl;
-		stream << "\t" << materials_buffer.get_element_count() << " materials" << std::endl;
+		stream << "\t" << materials_hot.get_element_count() << " materials" << std::endl;
 		stream << "\t" << orochi_materials_textures.size() << " textures" << std::endl;
 	}
 
@@ -108,10 +109,45 @@ struct HIPRTScene
 	OrochiBuffer<bool> has_vertex_normals;
 	OrochiBuffer<float3> vertex_normals;
 	OrochiBuffer<int> material_indices;
-	OrochiBuffer<RendererMaterial> materials_buffer;
+	/**
+	 * Splits the materials into their hot / shading / cold blocks (see MaterialsSoA)
+	 * and uploads them to the GPU. The buffers are only reallocated if the number of
+	 * materials changed
+	 */
+	void upload_materials(const std::vector<RendererMaterial>& materials)
+	{
+		MaterialsSoAHost materials_soa;
+		materials_soa.pack(materials);
+
+		if (materials_hot.get_element_count() != materials.size())
+		{
+			materials_hot.resize(materials.size());
+			materials_shading.resize(materials.size());
+			materials_cold.resize(materials.size());
+		}
+
+		materials_hot.upload_data(materials_soa.hot);
+		materials_shading.upload_data(materials_soa.shading);
+		materials_cold.upload_data(materials_soa.cold);
+	}
+
+	MaterialsSoA get_materials_soa()
+	{
+		MaterialsSoA materials_soa;
+		materials_soa.hot = materials_hot.get_device_pointer();
+		materials_soa.shading = materials_shading.get_device_pointer();
+		materials_soa.cold = materials_cold.get_device_pointer();
+
+		return materials_soa;
+	}
+
+	OrochiBuffer<MaterialHotData> materials_hot;
+	OrochiBuffer<MaterialShadingData> materials_shading;
+	OrochiBuffer<MaterialColdData> materials_cold;
 
 	int emissive_triangles_count = 0;
 	OrochiBuffer<int> emissive_triangles_indices;
+	float emissive_irradiance_estimate = 0.0f;
 
 	// Vector to keep the textures data alive otherwise the OrochiTexture objects would
 	// be destroyed which means that the underlying textures would be destroyed
@@ -52,27 +52,24 @@ void OrochiEnvmap::free_cdf()
 
 void OrochiEnvmap::compute_alias_table(const Image32Bit& image)
 {
-	std::vector<float> probas;
-	std::vector<int> alias;
-	image.compute_alias_table(probas, alias, &m_luminance_total_sum);
+	std::vector<EnvmapAliasTableEntry> alias_table;
+	image.compute_alias_table(alias_table, &m_luminance_total_sum);
 
-	m_alias_table_probas.resize(width * height);
-	m_alias_table_alias.resize(width * height);
-
-	m_alias_table_probas.upload_data(probas.data());
-	m_alias_table_alias.upload_data(alias.data());
+	m_alias_table.resize(width * height);
+	m_alias_table.upload_data(alias_table.data());
 }
 
-void OrochiEnvmap::get_alias_table_device_pointers(float*& probas, int*& aliases)
+EnvmapAliasTableEntry* OrochiEnvmap::get_alias_table_device_pointer()
 {
-	probas = m_alias_table_probas.get_device_pointer();
-	aliases = m_alias_table_alias.get_device_pointer();
+	if (m_alias_table.get_element_count() == 0)
+		g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "Trying to get the alias table of an OrochiEnvmap whose alias table wasn't computed in the first place...");
+
+	return m_alias_table.get_device_pointer();
 }
 
 void OrochiEnvmap::free_alias_table()
 {
-	m_alias_table_probas.free();
-	m_alias_table_alias.free();
+	m_alias_table.free();
 }
 
 float OrochiEnvmap::get_luminance_total_sum() const
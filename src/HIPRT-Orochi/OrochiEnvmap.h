@@ -27,11 +27,13 @@ public:
 	void free_cdf();
 
 	void compute_alias_table(const Image32Bit& image);
-	void get_alias_table_device_pointers(float*& probas, int*& aliases);
+	EnvmapAliasTableEntry* get_alias_table_device_pointer();
 	void free_alias_table();
 
 	/**
-	 * Returns the sum of the luminance of all the texels of the envmap.
+	 * Returns the sum of the luminance times the solid angle of all the texels
+	 * of the envmap (see WorldSettings::envmap_total_sum).
+	 *
 	 * This value is not computed by this function but is computed by compute_cdf()
 	 * and compute_alias_table() so one of these two functions must be
 	 * called before calling 'get_luminance_total_sum' or 'get_luminance_total_sum'
@@ -44,8 +46,7 @@ private:
 
 	OrochiBuffer<float> m_cdf;
 
-	OrochiBuffer<float> m_alias_table_probas;
-	OrochiBuffer<int> m_alias_table_alias;
+	OrochiBuffer<EnvmapAliasTableEntry> m_alias_table;
 };
 
 #endif
@@ -29,11 +29,15 @@ struct BRDFsData
 	// 32x32 texture containing the precomputed parameters of the LTC
 	// fitted to approximate the SSGX sheen volumetric layer.
 	// See SheenLTCFittedParameters.h
+	// 
+	// This is an Image32BitView* on the CPU
 	void* sheen_ltc_parameters_texture = nullptr;
 
 	// 2D texture for the precomputed directional albedo
 	// for the GGX BRDFs used in the principled BSDF for energy conservation
 	// of conductors
+	// 
+	// This is an Image32BitView* on the CPU
 	void* GGX_conductor_Ess = nullptr;
 
 	// 3D texture for the precomputed directional albedo of the base layer
@@ -74,6 +74,7 @@ struct ColorRGB32F
     HIPRT_HOST_DEVICE void operator/=(const ColorRGB32F& other) { r /= other.r; g /= other.g; b /= other.b; }
     HIPRT_HOST_DEVICE void operator/=(float k) { r /= k; g /= k; b /= k; }
     HIPRT_HOST_DEVICE bool operator!=(const ColorRGB32F& other) { return r != other.r || g != other.g || b != other.g; }
+    HIPRT_HOST_DEVICE bool operator==(const ColorRGB32F& other) const { return r == other.r && g == other.g && b == other.b; }
 
     HIPRT_HOST_DEVICE float length() const { return sqrtf(this->length2()); }
     HIPRT_HOST_DEVICE float length2() const { return r * r + g * g + b * b; }
@@ -63,6 +63,10 @@
 #define ESS_BINARY_SEARCH 1
 #define ESS_ALIAS_TABLE 2
 
+#define DLUS_NONE 0
+#define DLUS_SCENE_POWER 1
+#define DLUS_PER_HIT_ESTIMATE 2
+
 #define RESTIR_DI_BIAS_CORRECTION_1_OVER_M 0
 #define RESTIR_DI_BIAS_CORRECTION_1_OVER_Z 1
 #define RESTIR_DI_BIAS_CORRECTION_MIS_LIKE 2
@@ -251,6 +255,32 @@
  */
 #define EnvmapSamplingDoBSDFMIS KERNEL_OPTION_TRUE
 
+/**
+ * Whether or not to choose stochastically between the emissive geometry and the envmap
+ * when sampling direct lighting at a path vertex. Only one of the two is then sampled
+ * (and its shadow rays traced) and its contribution is divided by the probability of
+ * having chosen it.
+ * 
+ * Possible values (the prefix DLUS stands for "Direct Lighting Unified Selection"):
+ * 
+ *	- DLUS_NONE
+ *		Both the emissive geometry and the envmap are sampled at each vertex
+ * 
+ *	- DLUS_SCENE_POWER
+ *		The envmap is chosen with a probability proportional to its irradiance estimate
+ *		versus the average irradiance that the emissive geometry of the scene delivers
+ *		(computed once on the CPU when the scene is loaded)
+ * 
+ *	- DLUS_PER_HIT_ESTIMATE
+ *		The irradiance of the emissive geometry is estimated at the shading point from
+ *		one random emissive triangle (no shadow ray). Adapts to the distance to the lights
+ *		but the estimate is noisy when there are many small lights
+ * 
+ * The estimates of DLUS_SCENE_POWER and DLUS_PER_HIT_ESTIMATE ignore occlusion:
+ * an interior lit by the envmap through a window picks the envmap way too often
+ */
+#define DirectLightUnifiedSelection DLUS_NONE
+
 /**
  * Whether or not to use a visiblity term in the target function whose PDF we're
  * approximating with RIS.
@@ -67,7 +67,24 @@ struct SimplifiedRendererMaterial
     {
         if (specular_transmission == 0.0f)
             // No transmission means that we should never skip this boundary --> max priority
-            dielectric_priority = (1 << StackPriorityEntry::PRIORITY_MAXIMUM) - 1;
+            dielectric_priority = StackEntry::PRIORITY_MAXIMUM;
+    }
+
+    /**
+     * Roughening of the base roughness and second metallic roughness based
+     * on the coat roughness
+     *
+     * Reference: [OpenPBR Surface 2024 Specification] https://academysoftwarefoundation.github.io/OpenPBR/#model/coat/roughening
+     */
+    HIPRT_HOST_DEVICE void apply_coat_roughening()
+    {
+        float target_base_roughness = hippt::pow_1_4(hippt::min(1.0f, hippt::pow_4(roughness) + 2.0f * hippt::pow_4(coat_roughness)));
+        float roughened_base_roughness = hippt::lerp(roughness, target_base_roughness, coat);
+        roughness = hippt::lerp(roughness, roughened_base_roughness, coat_roughening);
+
+        float target_second_metal_roughness = hippt::pow_1_4(hippt::min(1.0f, hippt::pow_4(second_roughness) + 2.0f * hippt::pow_4(coat_roughness)));
+        float roughened_second_metal_roughness = hippt::lerp(second_roughness, target_second_metal_roughness, coat);
+        second_roughness = hippt::lerp(second_roughness, roughened_second_metal_roughness, coat_roughening);
     }
 
     HIPRT_HOST_DEVICE static void get_oren_nayar_AB(float sigma, float& out_oren_A, float& out_oren_B)
@@ -126,6 +143,37 @@ struct SimplifiedRendererMaterial
         return emission;
     }
 
+    /**
+     * Compares the parameters one by one, not the bytes of the
+     * structures: the padding bytes may differ between two copies
+     */
+    HIPRT_HOST_DEVICE bool has_same_parameters(const SimplifiedRendererMaterial& other) const
+    {
+        bool same = emissive_texture_used == other.emissive_texture_used && emission_strength == other.emission_strength && emission == other.emission;
+        same &= base_color == other.base_color && roughness == other.roughness && oren_nayar_sigma == other.oren_nayar_sigma;
+        same &= metallic == other.metallic && metallic_F90_falloff_exponent == other.metallic_F90_falloff_exponent;
+        same &= metallic_F82 == other.metallic_F82 && metallic_F90 == other.metallic_F90;
+        same &= anisotropy == other.anisotropy && anisotropy_rotation == other.anisotropy_rotation;
+        same &= second_roughness_weight == other.second_roughness_weight && second_roughness == other.second_roughness;
+        same &= specular == other.specular && specular_tint == other.specular_tint && specular_color == other.specular_color;
+        same &= specular_darkening == other.specular_darkening;
+        same &= coat == other.coat && coat_medium_absorption == other.coat_medium_absorption && coat_medium_thickness == other.coat_medium_thickness;
+        same &= coat_roughness == other.coat_roughness && coat_roughening == other.coat_roughening && coat_darkening == other.coat_darkening;
+        same &= coat_anisotropy == other.coat_anisotropy && coat_anisotropy_rotation == other.coat_anisotropy_rotation && coat_ior == other.coat_ior;
+        same &= sheen == other.sheen && sheen_roughness == other.sheen_roughness && sheen_color == other.sheen_color;
+        same &= ior == other.ior && specular_transmission == other.specular_transmission;
+        same &= absorption_at_distance == other.absorption_at_distance && absorption_color == other.absorption_color;
+        same &= dispersion_scale == other.dispersion_scale && dispersion_abbe_number == other.dispersion_abbe_number && thin_walled == other.thin_walled;
+        same &= thin_film == other.thin_film && thin_film_ior == other.thin_film_ior && thin_film_thickness == other.thin_film_thickness;
+        same &= thin_film_kappa_3 == other.thin_film_kappa_3 && thin_film_hue_shift_degrees == other.thin_film_hue_shift_degrees;
+        same &= thin_film_base_ior_override == other.thin_film_base_ior_override && thin_film_do_ior_override == other.thin_film_do_ior_override;
+        same &= srgb == other.srgb && alpha_opacity == other.alpha_opacity && dielectric_priority == other.dielectric_priority;
+        same &= energy_preservation_monte_carlo_samples == other.energy_preservation_monte_carlo_samples;
+        same &= enforce_strong_energy_conservation == other.enforce_strong_energy_conservation;
+
+        return same;
+    }
+
     bool emissive_texture_used = false;
     float emission_strength = 1.0f;
     ColorRGB32F base_color = ColorRGB32F(1.0f);
@@ -236,6 +284,170 @@ struct RendererMaterial : public SimplifiedRendererMaterial
     // CONSTANT_EMISSIVE_TEXTURE
     static constexpr int CONSTANT_EMISSIVE_TEXTURE = -2;
 
+    /**
+     * The scalar properties of the material that can be read from a single channel of a texture.
+     *
+     * The scalar maps of a material that have the same resolution are packed at load time into
+     * the channels of shared RG or RGBA textures (see ThreadFunctions::pack_scene_scalar_textures()).
+     * The texture index of such a property is then the index of the packed texture and the
+     * channel to read is given by get_scalar_texture_channel().
+     *
+     * The order of the enum is the order in which the properties are read by get_intersection_material()
+     * and packed so that consecutive properties sharing a texture are read with a single fetch
+     */
+    enum ScalarTextureProperty : int
+    {
+        ROUGHNESS_TEXTURE = 0,
+        OREN_SIGMA_TEXTURE,
+        METALLIC_TEXTURE,
+        SPECULAR_TEXTURE,
+        SPECULAR_TINT_TEXTURE,
+        ANISOTROPIC_TEXTURE,
+        ANISOTROPIC_ROTATION_TEXTURE,
+        COAT_TEXTURE,
+        COAT_ROUGHNESS_TEXTURE,
+        COAT_IOR_TEXTURE,
+        SHEEN_TEXTURE,
+        SHEEN_ROUGHNESS_TEXTURE,
+        SPECULAR_TRANSMISSION_TEXTURE,
+
+        SCALAR_TEXTURE_PROPERTY_COUNT
+    };
+
+    /**
+     * Bits of the mask returned by get_texture_usage_mask().
+     *
+     * The scalar properties use the bit of their ScalarTextureProperty so that
+     * iterating over the set bits of the mask reads them in the packing order
+     */
+    enum TextureUsage : unsigned int
+    {
+        BASE_COLOR_TEXTURE_USED = 1u << (SCALAR_TEXTURE_PROPERTY_COUNT + 0),
+        EMISSION_TEXTURE_USED = 1u << (SCALAR_TEXTURE_PROPERTY_COUNT + 1),
+        ROUGHNESS_METALLIC_TEXTURE_USED = 1u << (SCALAR_TEXTURE_PROPERTY_COUNT + 2),
+        SPECULAR_COLOR_TEXTURE_USED = 1u << (SCALAR_TEXTURE_PROPERTY_COUNT + 3),
+        SHEEN_COLOR_TEXTURE_USED = 1u << (SCALAR_TEXTURE_PROPERTY_COUNT + 4),
+
+        // The textures that the coat roughening depends on, see apply_coat_roughening()
+        COAT_ROUGHENING_TEXTURES_USED = (1u << ROUGHNESS_TEXTURE) | (1u << COAT_TEXTURE) | (1u << COAT_ROUGHNESS_TEXTURE) | ROUGHNESS_METALLIC_TEXTURE_USED,
+    };
+
+    /**
+     * Returns a mask of the TextureUsage bits of the textures that have to be
+     * read at each intersection with this material.
+     *
+     * The normal map isn't included, it is read when computing the shading normal
+     */
+    HIPRT_HOST_DEVICE unsigned int get_texture_usage_mask() const
+    {
+        unsigned int mask = 0;
+
+        mask |= roughness_texture_index >= 0 ? 1u << ROUGHNESS_TEXTURE : 0;
+        mask |= oren_sigma_texture_index >= 0 ? 1u << OREN_SIGMA_TEXTURE : 0;
+        mask |= metallic_texture_index >= 0 ? 1u << METALLIC_TEXTURE : 0;
+        mask |= specular_texture_index >= 0 ? 1u << SPECULAR_TEXTURE : 0;
+        mask |= specular_tint_texture_index >= 0 ? 1u << SPECULAR_TINT_TEXTURE : 0;
+        mask |= anisotropic_texture_index >= 0 ? 1u << ANISOTROPIC_TEXTURE : 0;
+        mask |= anisotropic_rotation_texture_index >= 0 ? 1u << ANISOTROPIC_ROTATION_TEXTURE : 0;
+        mask |= coat_texture_index >= 0 ? 1u << COAT_TEXTURE : 0;
+        mask |= coat_roughness_texture_index >= 0 ? 1u << COAT_ROUGHNESS_TEXTURE : 0;
+        mask |= coat_ior_texture_index >= 0 ? 1u << COAT_IOR_TEXTURE : 0;
+        mask |= sheen_texture_index >= 0 ? 1u << SHEEN_TEXTURE : 0;
+        mask |= sheen_roughness_texture_index >= 0 ? 1u << SHEEN_ROUGHNESS_TEXTURE : 0;
+        mask |= specular_transmission_texture_index >= 0 ? 1u << SPECULAR_TRANSMISSION_TEXTURE : 0;
+
+        // CONSTANT_EMISSIVE_TEXTURE is negative too, the emission is in the material
+        mask |= base_color_texture_index >= 0 ? BASE_COLOR_TEXTURE_USED : 0;
+        mask |= emission_texture_index >= 0 ? EMISSION_TEXTURE_USED : 0;
+        mask |= roughness_metallic_texture_index >= 0 ? ROUGHNESS_METALLIC_TEXTURE_USED : 0;
+        mask |= specular_color_texture_index >= 0 ? SPECULAR_COLOR_TEXTURE_USED : 0;
+        mask |= sheen_color_texture_index >= 0 ? SHEEN_COLOR_TEXTURE_USED : 0;
+
+        return mask;
+    }
+
+    /**
+     * Whether or not alpha testing can let rays pass through this material
+     */
+    HIPRT_HOST_DEVICE bool may_be_transparent() const
+    {
+        return alpha_opacity < 1.0f || (base_color_texture_index >= 0 && !base_color_texture_opaque);
+    }
+
+    HIPRT_HOST_DEVICE bool has_same_parameters(const RendererMaterial& other) const
+    {
+        bool same = SimplifiedRendererMaterial::has_same_parameters(other);
+        same &= normal_map_texture_index == other.normal_map_texture_index && emission_texture_index == other.emission_texture_index;
+        same &= base_color_texture_index == other.base_color_texture_index && roughness_metallic_texture_index == other.roughness_metallic_texture_index;
+        same &= roughness_texture_index == other.roughness_texture_index && oren_sigma_texture_index == other.oren_sigma_texture_index;
+        same &= metallic_texture_index == other.metallic_texture_index && specular_texture_index == other.specular_texture_index;
+        same &= specular_tint_texture_index == other.specular_tint_texture_index && specular_color_texture_index == other.specular_color_texture_index;
+        same &= anisotropic_texture_index == other.anisotropic_texture_index && anisotropic_rotation_texture_index == other.anisotropic_rotation_texture_index;
+        same &= coat_texture_index == other.coat_texture_index && coat_roughness_texture_index == other.coat_roughness_texture_index;
+        same &= coat_ior_texture_index == other.coat_ior_texture_index && sheen_texture_index == other.sheen_texture_index;
+        same &= sheen_roughness_texture_index == other.sheen_roughness_texture_index && sheen_color_texture_index == other.sheen_color_texture_index;
+        same &= specular_transmission_texture_index == other.specular_transmission_texture_index;
+        same &= scalar_texture_channels == other.scalar_texture_channels && base_color_texture_opaque == other.base_color_texture_opaque;
+
+        return same;
+    }
+
+    HIPRT_HOST_DEVICE float& get_scalar_property(ScalarTextureProperty property)
+    {
+        switch (property)
+        {
+        case ROUGHNESS_TEXTURE: return roughness;
+        case OREN_SIGMA_TEXTURE: return oren_nayar_sigma;
+        case METALLIC_TEXTURE: return metallic;
+        case SPECULAR_TEXTURE: return specular;
+        case SPECULAR_TINT_TEXTURE: return specular_tint;
+        case ANISOTROPIC_TEXTURE: return anisotropy;
+        case ANISOTROPIC_ROTATION_TEXTURE: return anisotropy_rotation;
+        case COAT_TEXTURE: return coat;
+        case COAT_ROUGHNESS_TEXTURE: return coat_roughness;
+        case COAT_IOR_TEXTURE: return coat_ior;
+        case SHEEN_TEXTURE: return sheen;
+        case SHEEN_ROUGHNESS_TEXTURE: return sheen_roughness;
+        case SPECULAR_TRANSMISSION_TEXTURE:
+        default: return specular_transmission;
+        }
+    }
+
+    HIPRT_HOST_DEVICE int& get_scalar_texture_index(ScalarTextureProperty property)
+    {
+        switch (property)
+        {
+        case ROUGHNESS_TEXTURE: return roughness_texture_index;
+        case OREN_SIGMA_TEXTURE: return oren_sigma_texture_index;
+        case METALLIC_TEXTURE: return metallic_texture_index;
+        case SPECULAR_TEXTURE: return specular_texture_index;
+        case SPECULAR_TINT_TEXTURE: return specular_tint_texture_index;
+        case ANISOTROPIC_TEXTURE: return anisotropic_texture_index;
+        case ANISOTROPIC_ROTATION_TEXTURE: return anisotropic_rotation_texture_index;
+        case COAT_TEXTURE: return coat_texture_index;
+        case COAT_ROUGHNESS_TEXTURE: return coat_roughness_texture_index;
+        case COAT_IOR_TEXTURE: return coat_ior_texture_index;
+        case SHEEN_TEXTURE: return sheen_texture_index;
+        case SHEEN_ROUGHNESS_TEXTURE: return sheen_roughness_texture_index;
+        case SPECULAR_TRANSMISSION_TEXTURE:
+        default: return specular_transmission_texture_index;
+        }
+    }
+
+    /**
+     * Channel (0 to 3 for R to A) of its texture that the given scalar property is read from
+     */
+    HIPRT_HOST_DEVICE int get_scalar_texture_channel(ScalarTextureProperty property) const
+    {
+        return (scalar_texture_channels >> (property * 2)) & 0b11;
+    }
+
+    HIPRT_HOST_DEVICE void set_scalar_texture_channel(ScalarTextureProperty property, int channel)
+    {
+        scalar_texture_channels &= ~(0b11u << (property * 2));
+        scalar_texture_channels |= (channel & 0b11u) << (property * 2);
+    }
+
     int normal_map_texture_index = -1;
 
     int emission_texture_index = -1;
@@ -265,6 +477,13 @@ struct RendererMaterial : public SimplifiedRendererMaterial
     int sheen_color_texture_index = -1;
 
     int specular_transmission_texture_index = -1;
+
+    // 2 bits per ScalarTextureProperty, 0 (the red channel) for the textures that aren't packed
+    unsigned int scalar_texture_channels = 0;
+
+    // True if all the texels of the base color texture have an alpha of 1, set when loading the texture.
+    // Assuming that the texture may have transparency until then
+    bool base_color_texture_opaque = false;
 };
 
 #endif
@@ -0,0 +1,402 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef HOST_DEVICE_COMMON_MATERIALS_SOA_H
+#define HOST_DEVICE_COMMON_MATERIALS_SOA_H
+
+#include "HostDeviceCommon/Material.h"
+
+#ifndef __KERNELCC__
+#include <vector>
+#endif
+
+/**
+ * The RendererMaterial structure is a few hundred bytes. Fetching the whole structure
+ * just to read one or two parameters (alpha testing in the filter function, emission of a
+ * light when sampling it, IOR of the volume we're in, ...) wastes most of the memory
+ * bandwidth of the fetch.
+ *
+ * The materials are thus stored on the device as a structure of arrays of 3 blocks:
+ *	- The hot block: the few parameters needed everywhere, including
+ *		shadow rays, alpha tests and light sampling
+ *	- The shading block: the parameters needed when evaluating the BSDF at a hit
+ *	- The cold block: the parameters of rarely used features (thin-film, dispersion,
+ *		volume and coat absorption, ...)
+ *
+ * The host keeps working with std::vector<RendererMaterial> (UI, scene parsing, ...), the
+ * materials are only split into the 3 blocks when uploaded to the renderer.
+ */
+
+struct MaterialHotData
+{
+	enum Flags : unsigned int
+	{
+		THIN_WALLED = 1 << 0,
+		THIN_FILM_DO_IOR_OVERRIDE = 1 << 1,
+		SRGB = 1 << 2,
+		ENFORCE_STRONG_ENERGY_CONSERVATION = 1 << 3,
+		// See RendererMaterial::may_be_transparent(), the filter function
+		// doesn't read the alpha of the materials that don't have this flag
+		MAY_BE_TRANSPARENT = 1 << 4,
+	};
+
+	HIPRT_HOST_DEVICE ColorRGB32F get_emission() const
+	{
+		return emission * emission_strength;
+	}
+
+	HIPRT_HOST_DEVICE bool has_flag(Flags flag) const
+	{
+		return flags & flag;
+	}
+
+	ColorRGB32F emission = ColorRGB32F(0.0f);
+	float emission_strength = 1.0f;
+
+	// Alpha testing
+	float alpha_opacity = 1.0f;
+	int base_color_texture_index = RendererMaterial::NO_TEXTURE;
+
+	// Nested dielectrics
+	float ior = 1.40f;
+	int dielectric_priority = 0;
+
+	int emission_texture_index = RendererMaterial::NO_TEXTURE;
+	unsigned int flags = Flags::SRGB;
+};
+
+struct MaterialShadingData
+{
+	ColorRGB32F base_color = ColorRGB32F(1.0f);
+
+	float roughness = 0.3f;
+	float oren_nayar_sigma = 0.34906585039886591538f;
+
+	float metallic = 0.0f;
+	float metallic_F90_falloff_exponent = 5.0f;
+	ColorRGB32F metallic_F82 = ColorRGB32F(1.0f);
+	ColorRGB32F metallic_F90 = ColorRGB32F(1.0f);
+	float anisotropy = 0.0f;
+	float anisotropy_rotation = 0.0f;
+	float second_roughness_weight = 0.0f;
+	float second_roughness = 0.5f;
+
+	float specular = 1.0f;
+	float specular_tint = 1.0f;
+	ColorRGB32F specular_color = ColorRGB32F(1.0f);
+	float specular_darkening = 0.0f;
+
+	float coat = 0.0f;
+	float coat_roughness = 0.0f;
+	float coat_roughening = 1.0f;
+	float coat_darkening = 1.0f;
+	float coat_anisotropy = 0.0f;
+	float coat_anisotropy_rotation = 0.0f;
+	float coat_ior = 1.5f;
+
+	float sheen = 0.0f;
+	float sheen_roughness = 0.5f;
+	ColorRGB32F sheen_color = ColorRGB32F(1.0f);
+
+	float specular_transmission = 0.0f;
+
+	int normal_map_texture_index = RendererMaterial::NO_TEXTURE;
+	int roughness_metallic_texture_index = RendererMaterial::NO_TEXTURE;
+	int roughness_texture_index = RendererMaterial::NO_TEXTURE;
+	int oren_sigma_texture_index = RendererMaterial::NO_TEXTURE;
+	int metallic_texture_index = RendererMaterial::NO_TEXTURE;
+	int specular_texture_index = RendererMaterial::NO_TEXTURE;
+	int specular_tint_texture_index = RendererMaterial::NO_TEXTURE;
+	int specular_color_texture_index = RendererMaterial::NO_TEXTURE;
+	int anisotropic_texture_index = RendererMaterial::NO_TEXTURE;
+	int anisotropic_rotation_texture_index = RendererMaterial::NO_TEXTURE;
+	int coat_texture_index = RendererMaterial::NO_TEXTURE;
+	int coat_roughness_texture_index = RendererMaterial::NO_TEXTURE;
+	int coat_ior_texture_index = RendererMaterial::NO_TEXTURE;
+	int sheen_texture_index = RendererMaterial::NO_TEXTURE;
+	int sheen_roughness_texture_index = RendererMaterial::NO_TEXTURE;
+	int sheen_color_texture_index = RendererMaterial::NO_TEXTURE;
+	int specular_transmission_texture_index = RendererMaterial::NO_TEXTURE;
+	unsigned int scalar_texture_channels = 0;
+
+	// RendererMaterial::TextureUsage bits of the textures read at each hit, computed when packing.
+	//
+	// If none of the RendererMaterial::COAT_ROUGHENING_TEXTURES_USED bits are set, 'roughness' and
+	// 'second_roughness' above already have the coat roughening applied
+	unsigned int texture_usage_mask = 0;
+};
+
+struct MaterialColdData
+{
+	ColorRGB32F coat_medium_absorption = ColorRGB32F(1.0f);
+	float coat_medium_thickness = 5.0f;
+
+	// Volume absorption
+	ColorRGB32F absorption_color = ColorRGB32F(1.0f);
+	float absorption_at_distance = 1.0f;
+
+	float dispersion_scale = 0.0f;
+	float dispersion_abbe_number = 20.0f;
+
+	float thin_film = 0.0f;
+	float thin_film_ior = 1.3f;
+	float thin_film_thickness = 500.0f;
+	float thin_film_kappa_3 = 0.0f;
+	float thin_film_hue_shift_degrees = 0.0f;
+	float thin_film_base_ior_override = 1.0f;
+
+	int energy_preservation_monte_carlo_samples = 12;
+};
+
+/**
+ * Structure of arrays of the materials of the scene as used by the renderers.
+ * All 3 arrays are indexed by the same material index
+ */
+struct MaterialsSoA
+{
+	MaterialHotData* hot = nullptr;
+	MaterialShadingData* shading = nullptr;
+	MaterialColdData* cold = nullptr;
+
+	HIPRT_HOST_DEVICE ColorRGB32F get_emission(int material_index) const
+	{
+		return hot[material_index].get_emission();
+	}
+
+	HIPRT_HOST_DEVICE float get_ior(int material_index) const
+	{
+		return hot[material_index].ior;
+	}
+
+	/**
+	 * Reads the parameters of the material without its texture indices.
+	 *
+	 * This is the material as evaluated at a hit for the materials that don't
+	 * have textures (see MaterialShadingData::texture_usage_mask)
+	 */
+	HIPRT_HOST_DEVICE SimplifiedRendererMaterial get_simplified_material(int material_index) const
+	{
+		const MaterialHotData& hot_data = hot[material_index];
+		const MaterialShadingData& shading_data = shading[material_index];
+		const MaterialColdData& cold_data = cold[material_index];
+
+		SimplifiedRendererMaterial material;
+
+		material.set_emission(hot_data.emission);
+		material.emission_strength = hot_data.emission_strength;
+		material.alpha_opacity = hot_data.alpha_opacity;
+		material.ior = hot_data.ior;
+		material.dielectric_priority = hot_data.dielectric_priority;
+		material.thin_walled = hot_data.has_flag(MaterialHotData::THIN_WALLED);
+		material.thin_film_do_ior_override = hot_data.has_flag(MaterialHotData::THIN_FILM_DO_IOR_OVERRIDE);
+		material.srgb = hot_data.has_flag(MaterialHotData::SRGB);
+		material.enforce_strong_energy_conservation = hot_data.has_flag(MaterialHotData::ENFORCE_STRONG_ENERGY_CONSERVATION);
+
+		material.base_color = shading_data.base_color;
+		material.roughness = shading_data.roughness;
+		material.oren_nayar_sigma = shading_data.oren_nayar_sigma;
+		material.metallic = shading_data.metallic;
+		material.metallic_F90_falloff_exponent = shading_data.metallic_F90_falloff_exponent;
+		material.metallic_F82 = shading_data.metallic_F82;
+		material.metallic_F90 = shading_data.metallic_F90;
+		material.anisotropy = shading_data.anisotropy;
+		material.anisotropy_rotation = shading_data.anisotropy_rotation;
+		material.second_roughness_weight = shading_data.second_roughness_weight;
+		material.second_roughness = shading_data.second_roughness;
+		material.specular = shading_data.specular;
+		material.specular_tint = shading_data.specular_tint;
+		material.specular_color = shading_data.specular_color;
+		material.specular_darkening = shading_data.specular_darkening;
+		material.coat = shading_data.coat;
+		material.coat_roughness = shading_data.coat_roughness;
+		material.coat_roughening = shading_data.coat_roughening;
+		material.coat_darkening = shading_data.coat_darkening;
+		material.coat_anisotropy = shading_data.coat_anisotropy;
+		material.coat_anisotropy_rotation = shading_data.coat_anisotropy_rotation;
+		material.coat_ior = shading_data.coat_ior;
+		material.sheen = shading_data.sheen;
+		material.sheen_roughness = shading_data.sheen_roughness;
+		material.sheen_color = shading_data.sheen_color;
+		material.specular_transmission = shading_data.specular_transmission;
+
+		material.coat_medium_absorption = cold_data.coat_medium_absorption;
+		material.coat_medium_thickness = cold_data.coat_medium_thickness;
+		material.absorption_color = cold_data.absorption_color;
+		material.absorption_at_distance = cold_data.absorption_at_distance;
+		material.dispersion_scale = cold_data.dispersion_scale;
+		material.dispersion_abbe_number = cold_data.dispersion_abbe_number;
+		material.thin_film = cold_data.thin_film;
+		material.thin_film_ior = cold_data.thin_film_ior;
+		material.thin_film_thickness = cold_data.thin_film_thickness;
+		material.thin_film_kappa_3 = cold_data.thin_film_kappa_3;
+		material.thin_film_hue_shift_degrees = cold_data.thin_film_hue_shift_degrees;
+		material.thin_film_base_ior_override = cold_data.thin_film_base_ior_override;
+		material.energy_preservation_monte_carlo_samples = cold_data.energy_preservation_monte_carlo_samples;
+
+		return material;
+	}
+
+	/**
+	 * Reads the 3 blocks of the material and rebuilds the full material
+	 */
+	HIPRT_HOST_DEVICE RendererMaterial get_material(int material_index) const
+	{
+		const MaterialHotData& hot_data = hot[material_index];
+		const MaterialShadingData& shading_data = shading[material_index];
+
+		RendererMaterial material;
+		static_cast<SimplifiedRendererMaterial&>(material) = get_simplified_material(material_index);
+
+		material.base_color_texture_index = hot_data.base_color_texture_index;
+		material.emission_texture_index = hot_data.emission_texture_index;
+		material.normal_map_texture_index = shading_data.normal_map_texture_index;
+		material.roughness_metallic_texture_index = shading_data.roughness_metallic_texture_index;
+		material.roughness_texture_index = shading_data.roughness_texture_index;
+		material.oren_sigma_texture_index = shading_data.oren_sigma_texture_index;
+		material.metallic_texture_index = shading_data.metallic_texture_index;
+		material.specular_texture_index = shading_data.specular_texture_index;
+		material.specular_tint_texture_index = shading_data.specular_tint_texture_index;
+		material.specular_color_texture_index = shading_data.specular_color_texture_index;
+		material.anisotropic_texture_index = shading_data.anisotropic_texture_index;
+		material.anisotropic_rotation_texture_index = shading_data.anisotropic_rotation_texture_index;
+		material.coat_texture_index = shading_data.coat_texture_index;
+		material.coat_roughness_texture_index = shading_data.coat_roughness_texture_index;
+		material.coat_ior_texture_index = shading_data.coat_ior_texture_index;
+		material.sheen_texture_index = shading_data.sheen_texture_index;
+		material.sheen_roughness_texture_index = shading_data.sheen_roughness_texture_index;
+		material.sheen_color_texture_index = shading_data.sheen_color_texture_index;
+		material.specular_transmission_texture_index = shading_data.specular_transmission_texture_index;
+		material.scalar_texture_channels = shading_data.scalar_texture_channels;
+
+		return material;
+	}
+};
+
+#ifndef __KERNELCC__
+/**
+ * Host side storage of the 3 blocks of the materials.
+ *
+ * Used directly by the CPU renderer and as a staging
+ * area for the upload to the GPU by the GPU renderer
+ */
+struct MaterialsSoAHost
+{
+	/**
+	 * Splits the materials into the 3 blocks. This is also where the per material
+	 * precomputations of the device are done (see MaterialShadingData::texture_usage_mask),
+	 * on load and on every edit of the materials
+	 */
+	void pack(const std::vector<RendererMaterial>& materials)
+	{
+		hot.resize(materials.size());
+		shading.resize(materials.size());
+		cold.resize(materials.size());
+
+		for (size_t i = 0; i < materials.size(); i++)
+		{
+			const RendererMaterial& material = materials[i];
+
+			MaterialHotData& hot_data = hot[i];
+			hot_data.emission = material.get_original_emission();
+			hot_data.emission_strength = material.emission_strength;
+			hot_data.alpha_opacity = material.alpha_opacity;
+			hot_data.base_color_texture_index = material.base_color_texture_index;
+			hot_data.ior = material.ior;
+			hot_data.dielectric_priority = material.dielectric_priority;
+			hot_data.emission_texture_index = material.emission_texture_index;
+			hot_data.flags = 0;
+			hot_data.flags |= material.thin_walled ? MaterialHotData::THIN_WALLED : 0;
+			hot_data.flags |= material.thin_film_do_ior_override ? MaterialHotData::THIN_FILM_DO_IOR_OVERRIDE : 0;
+			hot_data.flags |= material.srgb ? MaterialHotData::SRGB : 0;
+			hot_data.flags |= material.enforce_strong_energy_conservation ? MaterialHotData::ENFORCE_STRONG_ENERGY_CONSERVATION : 0;
+			hot_data.flags |= material.may_be_transparent() ? MaterialHotData::MAY_BE_TRANSPARENT : 0;
+
+			unsigned int texture_usage_mask = material.get_texture_usage_mask();
+			SimplifiedRendererMaterial roughened_material = material;
+			if (!(texture_usage_mask & RendererMaterial::COAT_ROUGHENING_TEXTURES_USED))
+				// The coat roughening doesn't depend on the hit, applying it once here
+				roughened_material.apply_coat_roughening();
+
+			MaterialShadingData& shading_data = shading[i];
+			shading_data.base_color = material.base_color;
+			shading_data.roughness = roughened_material.roughness;
+			shading_data.oren_nayar_sigma = material.oren_nayar_sigma;
+			shading_data.metallic = material.metallic;
+			shading_data.metallic_F90_falloff_exponent = material.metallic_F90_falloff_exponent;
+			shading_data.metallic_F82 = material.metallic_F82;
+			shading_data.metallic_F90 = material.metallic_F90;
+			shading_data.anisotropy = material.anisotropy;
+			shading_data.anisotropy_rotation = material.anisotropy_rotation;
+			shading_data.second_roughness_weight = material.second_roughness_weight;
+			shading_data.second_roughness = roughened_material.second_roughness;
+			shading_data.specular = material.specular;
+			shading_data.specular_tint = material.specular_tint;
+			shading_data.specular_color = material.specular_color;
+			shading_data.specular_darkening = material.specular_darkening;
+			shading_data.coat = material.coat;
+			shading_data.coat_roughness = material.coat_roughness;
+			shading_data.coat_roughening = material.coat_roughening;
+			shading_data.coat_darkening = material.coat_darkening;
+			shading_data.coat_anisotropy = material.coat_anisotropy;
+			shading_data.coat_anisotropy_rotation = material.coat_anisotropy_rotation;
+			shading_data.coat_ior = material.coat_ior;
+			shading_data.sheen = material.sheen;
+			shading_data.sheen_roughness = material.sheen_roughness;
+			shading_data.sheen_color = material.sheen_color;
+			shading_data.specular_transmission = material.specular_transmission;
+			shading_data.normal_map_texture_index = material.normal_map_texture_index;
+			shading_data.roughness_metallic_texture_index = material.roughness_metallic_texture_index;
+			shading_data.roughness_texture_index = material.roughness_texture_index;
+			shading_data.oren_sigma_texture_index = material.oren_sigma_texture_index;
+			shading_data.metallic_texture_index = material.metallic_texture_index;
+			shading_data.specular_texture_index = material.specular_texture_index;
+			shading_data.specular_tint_texture_index = material.specular_tint_texture_index;
+			shading_data.specular_color_texture_index = material.specular_color_texture_index;
+			shading_data.anisotropic_texture_index = material.anisotropic_texture_index;
+			shading_data.anisotropic_rotation_texture_index = material.anisotropic_rotation_texture_index;
+			shading_data.coat_texture_index = material.coat_texture_index;
+			shading_data.coat_roughness_texture_index = material.coat_roughness_texture_index;
+			shading_data.coat_ior_texture_index = material.coat_ior_texture_index;
+			shading_data.sheen_texture_index = material.sheen_texture_index;
+			shading_data.sheen_roughness_texture_index = material.sheen_roughness_texture_index;
+			shading_data.sheen_color_texture_index = material.sheen_color_texture_index;
+			shading_data.specular_transmission_texture_index = material.specular_transmission_texture_index;
+			shading_data.scalar_texture_channels = material.scalar_texture_channels;
+			shading_data.texture_usage_mask = texture_usage_mask;
+
+			MaterialColdData& cold_data = cold[i];
+			cold_data.coat_medium_absorption = material.coat_medium_absorption;
+			cold_data.coat_medium_thickness = material.coat_medium_thickness;
+			cold_data.absorption_color = material.absorption_color;
+			cold_data.absorption_at_distance = material.absorption_at_distance;
+			cold_data.dispersion_scale = material.dispersion_scale;
+			cold_data.dispersion_abbe_number = material.dispersion_abbe_number;
+			cold_data.thin_film = material.thin_film;
+			cold_data.thin_film_ior = material.thin_film_ior;
+			cold_data.thin_film_thickness = material.thin_film_thickness;
+			cold_data.thin_film_kappa_3 = material.thin_film_kappa_3;
+			cold_data.thin_film_hue_shift_degrees = material.thin_film_hue_shift_degrees;
+			cold_data.thin_film_base_ior_override = material.thin_film_base_ior_override;
+			cold_data.energy_preservation_monte_carlo_samples = material.energy_preservation_monte_carlo_samples;
+		}
+	}
+
+	MaterialsSoA get_data()
+	{
+		MaterialsSoA soa;
+		soa.hot = hot.data();
+		soa.shading = shading.data();
+		soa.cold = cold.data();
+
+		return soa;
+	}
+
+	std::vector<MaterialHotData> hot;
+	std::vector<MaterialShadingData> shading;
+	std::vector<MaterialColdData> cold;
+};
+#endif
+
+#endif
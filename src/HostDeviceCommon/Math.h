@@ -37,6 +37,11 @@
 #include <atomic>
 #endif
 
+#ifndef __KERNELCC__
+// For std::countr_zero in hippt::
+#include <bit>
+#endif
+
 struct float4x4
 {
 	float m[4][4] = { {0.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 0.0f} };
@@ -148,6 +153,11 @@ namespace hippt
 
 	__device__ float fract(float a) { return a - floorf(a); }
 
+	/**
+	 * Index of the least significant bit set of 'x'. 'x' must not be 0
+	 */
+	__device__ int count_trailing_zeros(unsigned int x) { return __ffs(x) - 1; }
+
 #else
 #undef M_PI
 #define M_PI		3.14159265358979323846f
@@ -231,6 +241,11 @@ namespace hippt
 	}
 
 	inline float fract(float a) { return a - floorf(a); }
+
+	/**
+	 * Index of the least significant bit set of 'x'. 'x' must not be 0
+	 */
+	inline int count_trailing_zeros(unsigned int x) { return std::countr_zero(x); }
 #endif
 }
 
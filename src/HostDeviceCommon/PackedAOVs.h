@@ -0,0 +1,104 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef HOST_DEVICE_COMMON_PACKED_AOVS_H
+#define HOST_DEVICE_COMMON_PACKED_AOVS_H
+
+#include "HostDeviceCommon/Color.h"
+#include "HostDeviceCommon/Math.h"
+
+/**
+ * 32 bit encodings of the denoiser AOVs used when render_settings.use_compact_AOVs is true.
+ *
+ * The albedo is stored as RGB9E5 (3 * 9 bits of mantissa sharing a 5 bits exponent, the
+ * format of GL_RGB9_E5) and the normals are stored with the octahedral mapping, 16 bits
+ * per component.
+ *
+ * Reference for the octahedral mapping:
+ * [A Survey of Efficient Representations for Independent Unit Vectors, Cigolle et al., 2014]
+ */
+
+#define RGB9E5_MANTISSA_BITS 9
+#define RGB9E5_EXPONENT_BIAS 15
+#define RGB9E5_MAX_VALUE 65408.0f
+
+HIPRT_HOST_DEVICE HIPRT_INLINE unsigned int pack_RGB9E5(const ColorRGB32F& color)
+{
+    float r = hippt::clamp(0.0f, RGB9E5_MAX_VALUE, color.r);
+    float g = hippt::clamp(0.0f, RGB9E5_MAX_VALUE, color.g);
+    float b = hippt::clamp(0.0f, RGB9E5_MAX_VALUE, color.b);
+
+    float max_component = hippt::max(r, hippt::max(g, b));
+    if (!(max_component > 0.0f))
+        // Black (or NaN) input. Also, log2(0) is -inf and converting it to an int is undefined
+        return 0;
+
+    // Very small values are clamped to the smallest exponent
+    int shared_exponent = hippt::max(-RGB9E5_EXPONENT_BIAS - 1, static_cast<int>(floorf(log2f(max_component)))) + 1 + RGB9E5_EXPONENT_BIAS;
+
+    float scale = exp2f(static_cast<float>(shared_exponent - RGB9E5_EXPONENT_BIAS - RGB9E5_MANTISSA_BITS));
+    if (static_cast<int>(floorf(max_component / scale + 0.5f)) == (1 << RGB9E5_MANTISSA_BITS))
+    {
+        // The max component rounds up to 512, one more exponent is needed
+        shared_exponent++;
+        scale *= 2.0f;
+    }
+
+    unsigned int r_mantissa = static_cast<unsigned int>(floorf(r / scale + 0.5f));
+    unsigned int g_mantissa = static_cast<unsigned int>(floorf(g / scale + 0.5f));
+    unsigned int b_mantissa = static_cast<unsigned int>(floorf(b / scale + 0.5f));
+
+    return r_mantissa | (g_mantissa << 9) | (b_mantissa << 18) | (static_cast<unsigned int>(shared_exponent) << 27);
+}
+
+HIPRT_HOST_DEVICE HIPRT_INLINE ColorRGB32F unpack_RGB9E5(unsigned int packed)
+{
+    int shared_exponent = static_cast<int>(packed >> 27);
+    float scale = exp2f(static_cast<float>(shared_exponent - RGB9E5_EXPONENT_BIAS - RGB9E5_MANTISSA_BITS));
+
+    return ColorRGB32F(static_cast<float>(packed & 0x1FF), static_cast<float>((packed >> 9) & 0x1FF), static_cast<float>((packed >> 18) & 0x1FF)) * scale;
+}
+
+/**
+ * 'normal' is expected to be normalized
+ */
+HIPRT_HOST_DEVICE HIPRT_INLINE unsigned int pack_octahedral_normal(const float3& normal)
+{
+    float inverse_L1_norm = 1.0f / (fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z));
+    float u = normal.x * inverse_L1_norm;
+    float v = normal.y * inverse_L1_norm;
+
+    if (normal.z < 0.0f)
+    {
+        // Folding the lower hemisphere over the diagonals
+        float folded_u = (1.0f - fabsf(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+        float folded_v = (1.0f - fabsf(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+
+        u = folded_u;
+        v = folded_v;
+    }
+
+    // [-1, 1] to snorm16
+    int u_snorm = static_cast<int>(roundf(hippt::clamp(-1.0f, 1.0f, u) * 32767.0f));
+    int v_snorm = static_cast<int>(roundf(hippt::clamp(-1.0f, 1.0f, v) * 32767.0f));
+
+    return (static_cast<unsigned int>(u_snorm) & 0xFFFF) | (static_cast<unsigned int>(v_snorm) << 16);
+}
+
+HIPRT_HOST_DEVICE HIPRT_INLINE float3 unpack_octahedral_normal(unsigned int packed)
+{
+    // Sign extending the two 16 bit components
+    float u = static_cast<float>(static_cast<short>(packed & 0xFFFF)) / 32767.0f;
+    float v = static_cast<float>(static_cast<short>(packed >> 16)) / 32767.0f;
+
+    float3 normal = make_float3(u, v, 1.0f - fabsf(u) - fabsf(v));
+    float t = hippt::max(-normal.z, 0.0f);
+    normal.x += normal.x >= 0.0f ? -t : t;
+    normal.y += normal.y >= 0.0f ? -t : t;
+
+    return hippt::normalize(normal);
+}
+
+#endif
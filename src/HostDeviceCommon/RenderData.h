@@ -12,6 +12,7 @@
 #include "HostDeviceCommon/BSDFsData.h"
 #include "HostDeviceCommon/HIPRTCamera.h"
 #include "HostDeviceCommon/Material.h"
+#include "HostDeviceCommon/MaterialsSoA.h"
 #include "HostDeviceCommon/Math.h"
 #include "HostDeviceCommon/RenderSettings.h"
 #include "HostDeviceCommon/WorldSettings.h"
@@ -53,12 +54,16 @@ struct RenderBuffers
 
 	// Index of the material used by each triangle of the scene
 	int* material_indices = nullptr;
-	// Materials array to be indexed by an index retrieved from the 
-	// material_indices array
-	RendererMaterial* materials_buffer = nullptr;
+	// Materials to be indexed by an index retrieved from the 
+	// material_indices array. Stored as hot / shading / cold blocks,
+	// see MaterialsSoA
+	MaterialsSoA materials_buffer;
 
 	int emissive_triangles_count = 0;
 	int* emissive_triangles_indices = nullptr;
+	// Average irradiance that the emissive geometry delivers to the surfaces of the scene.
+	// See Scene::compute_emissive_irradiance_estimate()
+	float emissive_irradiance_estimate = 0.0f;
 
 	// A pointer either to an array of Image8Bit or to an array of
 	// oroTextureObject_t whether if CPU or GPU rendering respectively
@@ -72,9 +77,11 @@ struct RenderBuffers
 
 struct AuxiliaryBuffers
 {
-	// Whether or not the pixel at a given index in the buffer is active or not. A pixel can be
-	// inactive when we're rendering at low resolution for example or when adaptive sampling has
-	// judged that the pixel was converged enough and doesn't need more samples
+	// How many samples the pixel at a given index gets in this pass, 0 if the pixel is inactive.
+	// A pixel can be inactive when we're rendering at low resolution for example or when adaptive
+	// sampling has judged that the pixel was converged enough and doesn't need more samples.
+	//
+	// This is always 0 or 1 unless adaptive sampling redistributes the samples
 	unsigned char* pixel_active = nullptr;
 
 	// World space normals for the denoiser
@@ -85,6 +92,14 @@ struct AuxiliaryBuffers
 	// The albedo should already be divided by the number of samples
 	ColorRGB32F* denoiser_albedo = nullptr;
 
+	// Denoiser normals and albedo in their 32 bit encodings (see PackedAOVs.h).
+	// 
+	// Only allocated if render_settings.use_compact_AOVs is true. In that case, these
+	// are the buffers accumulated by the path tracer and 'denoiser_normals' / 'denoiser_albedo'
+	// above are only filled by the UnpackDenoiserAOVs kernel, when the denoiser or the display needs them
+	unsigned int* packed_denoiser_normals = nullptr;
+	unsigned int* packed_denoiser_albedo = nullptr;
+
 	// Per pixel sample count. Useful when doing adaptive sampling
 	// where each pixel can have a different number of sample
 	int* pixel_sample_count = nullptr;
@@ -93,6 +108,34 @@ struct AuxiliaryBuffers
 	// This buffer should not be pre-divided by the number of samples
 	float* pixel_squared_luminance = nullptr;
 
+	// Per pixel sum of the colors of the 'pixel_sample_count' samples of the pixel.
+	// 
+	// With adaptive sampling, the framebuffer 'pixels' is resolved from this sum
+	// and the sample count of the pixel at each pass, see resolve_adaptive_sampling_pixel()
+	ColorRGB32F* pixel_color_sum = nullptr;
+
+	// Per pixel sum of the colors of the samples of odd index only (the 2nd, 4th, ... samples
+	// of the pixel). The average of half of the samples compared with the average of all the
+	// samples estimates the error of the pixel, see TileConvergence
+	ColorRGB32F* pixel_odd_color_sum = nullptr;
+
+	// Framebuffer of the render passes when rendering at low resolution, indexed with the width
+	// of the low resolution grid. The LowResolutionUpsampling pass reconstructs the
+	// full resolution 'pixels' framebuffer from it
+	ColorRGB32F* low_resolution_pixels = nullptr;
+
+	// Per pixel Bloom filter of the materials hit by the paths of the pixel since its last reset.
+	// Only allocated if render_settings.use_partial_material_reset is true
+	unsigned int* pixel_material_filter = nullptr;
+
+	// One entry per tile of render_settings.convergence_tile_size pixels, 1 if
+	// the tile has converged and doesn't need samples anymore, 0 otherwise
+	unsigned char* tile_converged = nullptr;
+
+	// Three sums, used in rotation, of the noise of the pixels at each pass.
+	// See redistributed_sample_count()
+	AtomicType<float>* adaptive_sampling_error_sums = nullptr;
+
 	// If a given pixel has converged, this buffer contains the number of samples
 	// that were necessary for the convergence. 
 	// 
@@ -112,6 +155,11 @@ struct AuxiliaryBuffers
 	// noise threshold.
 	AtomicType<unsigned int>* stop_noise_threshold_converged_count = nullptr;
 
+	// If render_settings.use_tile_convergence is true, this buffer (a single unsigned int)
+	// counts how many tiles of the image have converged. The render is done
+	// when all the tiles have converged
+	AtomicType<unsigned int>* converged_tile_count = nullptr;
+
 	// Pointers to the buffers allocated on the GPU. These pointers
 	// exist basically only to be reset in reset_render(). They should not
 	// be manipulated directly in the ReSTIR passes. 
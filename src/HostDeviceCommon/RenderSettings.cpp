@@ -15,6 +15,8 @@ HIPRT_HOST bool HIPRTRenderSettings::use_prev_frame_g_buffer(GPURenderer* render
 	bool need_g_buffer = renderer->get_global_compiler_options()->get_macro_value(GPUKernelCompilerOptions::DIRECT_LIGHT_SAMPLING_STRATEGY) == LSS_RESTIR_DI;
 	// If the temporal reuse isn't used, don't need the G-buffer
 	need_g_buffer &= restir_di_settings.temporal_pass.do_temporal_reuse_pass;
+	// The temporal reprojection of the accumulation compares the surfaces of the two frames
+	need_g_buffer |= temporal_accumulation.do_temporal_reprojection;
 
 	return need_g_buffer;
 }
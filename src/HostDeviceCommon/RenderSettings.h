@@ -9,6 +9,7 @@
 #include "HostDeviceCommon/PathRussianRoulette.h"
 #include "HostDeviceCommon/KernelOptions.h"
 #include "HostDeviceCommon/ReSTIRDISettings.h"
+#include "HostDeviceCommon/TemporalAccumulationSettings.h"
 
 #include <hiprt/hiprt_common.h>
 
@@ -64,6 +65,15 @@ struct HIPRTRenderSettings
 	// and get that "accumulated" normals value.
 	int denoiser_AOV_accumulation_counter = 0;
 
+	// If true, the albedo and normals AOVs are accumulated in 32 bit per pixel
+	// (RGB9E5 and octahedral encodings) instead of 96 bit per pixel. This divides by 3
+	// the memory traffic of the accumulation of these AOVs, done every sample.
+	// 
+	// Because they are quantized, the running averages stop moving once the contribution
+	// of a new sample falls below the precision of the encoding (after a few hundred samples)
+	// but that's plenty for the denoiser
+	bool use_compact_AOVs = false;
+
 	// Number of samples rendered so far before the kernel call
 	// This is the sum of samples_per_frame for all frames
 	// that have been rendered.
@@ -120,7 +130,10 @@ struct HIPRTRenderSettings
 	// with the 'allow_render_low_resolution' flag
 	bool wants_render_low_resolution = false;
 	// How to divide the render resolution by when rendering at low resolution
-	// (when interacting with the camera)
+	// (when interacting with the camera).
+	//
+	// The render passes are then launched on a grid of (width / scaling) x (height / scaling)
+	// pixels and the LowResolutionUpsampling pass reconstructs the full resolution framebuffer
 	int render_low_resolution_scaling = 2;
 
 	bool enable_adaptive_sampling = true;
@@ -131,6 +144,16 @@ struct HIPRTRenderSettings
 	int adaptive_sampling_min_samples = 64;
 	// Adaptive sampling noise threshold
 	float adaptive_sampling_noise_threshold = 0.3f;
+	// If true, the pixels that haven't converged share a budget of one sample per pixel
+	// of the image at each pass, proportionally to their noise (see redistributed_sample_count()).
+	// The noisiest pixels thus get several samples per pass while the pixels that are almost
+	// converged may be skipped for a pass.
+	//
+	// If false, adaptive sampling only stops sampling the pixels that have converged
+	bool adaptive_sampling_redistribute_samples = true;
+	// Maximum number of samples that a pixel can get in one pass when redistributing.
+	// In [1, 255]
+	int adaptive_sampling_max_samples_per_pass = 8;
 
 	// If true, the rendering will stop after a certain proportion (defined by 'stop_pixel_percentage_converged')
 	// of pixels of the image have converged. "converged" here is defined according to the adaptive sampling if
@@ -148,6 +171,36 @@ struct HIPRTRenderSettings
 	// condition
 	float stop_pixel_noise_threshold = 0.0f;
 
+	// If true, the image is split in square tiles whose convergence is estimated from
+	// the difference between the average of all the samples of their pixels and the
+	// average of their odd samples only (see TileConvergence).
+	// The tiles that have converged are not sampled anymore and the render is done when
+	// all the tiles have converged, 'stop_pixel_percentage_converged' isn't used
+	bool use_tile_convergence = false;
+	// Width and height in pixels of the convergence tiles.
+	// A multiple of 8 so that the GPU skips the converged tiles by whole blocks of threads
+	int convergence_tile_size = 16;
+	// Relative error under which a tile is considered converged
+	float tile_convergence_threshold = 0.01f;
+	// How many samples before the convergence of the tiles is evaluated.
+	// Both halves of the samples must have found the rare paths for the error to be meaningful
+	int tile_convergence_min_samples = 32;
+
+	// If true, the materials hit by the paths of each pixel are recorded in a 32 bit Bloom filter
+	// per pixel (see get_material_filter_bit()) and editing materials only resets the accumulation
+	// (and the ReSTIR reservoirs) of the pixels whose paths hit one of the edited materials.
+	// The other pixels keep converging.
+	//
+	// Only possible when the framebuffer is resolved from the per pixel sums of adaptive
+	// sampling, see can_partially_reset_render()
+	bool use_partial_material_reset = false;
+	// How many bounces of the paths record the material they hit in the filter of their pixel.
+	// 1 is the camera ray hit only. A material seen only deeper than that in the paths of a pixel
+	// doesn't reset the pixel when edited, its indirect contribution stays stale
+	int partial_material_reset_bounces = 2;
+	// Bloom filter of the materials edited since the last pass. The next pass resets
+	// the pixels whose filter shares a bit with it. 0 if there is nothing to reset
+	unsigned int material_reset_filter = 0;
 
 
 	// Clamp direct lighting contribution to reduce fireflies
@@ -186,6 +239,9 @@ struct HIPRTRenderSettings
 	// Settings for ReSTIR DI
 	ReSTIRDISettings restir_di_settings;
 
+	// What happens to the accumulation when the camera moves
+	TemporalAccumulationSettings temporal_accumulation;
+
 	/**
 	 * Returns true if the current frame should be renderer at low resolution, false otherwise.
 	 * 
@@ -197,6 +253,29 @@ struct HIPRTRenderSettings
 		return wants_render_low_resolution && allow_render_low_resolution && accumulate;
 	}
 
+	/**
+	 * Returns the resolution of the grid of pixels that the render passes are launched on
+	 * for a framebuffer of the given resolution: the full resolution divided by
+	 * 'render_low_resolution_scaling' when rendering at low resolution, the full resolution otherwise.
+	 *
+	 * The per pixel buffers are indexed with the width of that grid
+	 */
+	HIPRT_HOST_DEVICE int2 get_render_grid_resolution(int2 full_resolution) const
+	{
+		if (!do_render_low_resolution())
+			return full_resolution;
+
+		return make_int2((full_resolution.x + render_low_resolution_scaling - 1) / render_low_resolution_scaling, (full_resolution.y + render_low_resolution_scaling - 1) / render_low_resolution_scaling);
+	}
+
+	/**
+	 * Number of convergence tiles along each axis of an image of the given resolution
+	 */
+	HIPRT_HOST_DEVICE int2 get_convergence_tile_count(int2 resolution) const
+	{
+		return make_int2((resolution.x + convergence_tile_size - 1) / convergence_tile_size, (resolution.y + convergence_tile_size - 1) / convergence_tile_size);
+	}
+
 	/**
 	 * Returns true if the adaptive sampling buffers are ready for use, false otherwise.
 	 *
@@ -210,12 +289,39 @@ struct HIPRTRenderSettings
 
 		has_access |= stop_pixel_noise_threshold > 0.0f;
 		has_access |= enable_adaptive_sampling;
+		// The tiles are evaluated from the per pixel sums
+		has_access |= use_tile_convergence;
 		// Cannot use adaptive sampling without accumulation
 		has_access &= accumulate;
 
 		return has_access;
 	}
 
+	/**
+	 * Returns true if an edit of the materials can reset only the pixels whose paths
+	 * hit the edited materials (see use_partial_material_reset)
+	 */
+	HIPRT_HOST_DEVICE bool can_partially_reset_render() const
+	{
+		// The framebuffer must be resolved per pixel from the sums of the pixels
+		bool can_reset = use_partial_material_reset && has_access_to_adaptive_sampling_buffers();
+		// The history of the temporal accumulation isn't a sum that can be reset per pixel
+		can_reset &= !temporal_accumulation.do_temporal_reprojection;
+		can_reset &= !do_render_low_resolution();
+
+		return can_reset;
+	}
+
+	/**
+	 * Bit of the given material in the per pixel Bloom filters of the materials (a single
+	 * hash function). Materials whose indices are equal modulo 32 share their bit: editing
+	 * one of them also resets the pixels of the others
+	 */
+	HIPRT_HOST_DEVICE static unsigned int get_material_filter_bit(int material_index)
+	{
+		return 1u << (static_cast<unsigned int>(material_index) & 31u);
+	}
+
 	/**
 	 * Returns true if the renderer needs the G-buffer of the previous frame.
 	 * 
@@ -241,6 +347,8 @@ struct HIPRTRenderSettings
 		bool need_g_buffer = DirectLightSamplingStrategy == LSS_RESTIR_DI;
 		// If the temporal reuse isn't used, don't need the G-buffer
 		need_g_buffer &= restir_di_settings.temporal_pass.do_temporal_reuse_pass;
+		// The temporal reprojection of the accumulation compares the surfaces of the two frames
+		need_g_buffer |= temporal_accumulation.do_temporal_reprojection;
 
 		return need_g_buffer;
 	}
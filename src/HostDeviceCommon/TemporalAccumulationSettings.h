@@ -0,0 +1,46 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef HOST_DEVICE_TEMPORAL_ACCUMULATION_SETTINGS_H
+#define HOST_DEVICE_TEMPORAL_ACCUMULATION_SETTINGS_H
+
+#include "HostDeviceCommon/Color.h"
+
+/**
+ * Settings of the TemporalAccumulation pass, used by the CPU renderer when the
+ * camera moves between two frames of an interactive session
+ */
+struct TemporalAccumulationSettings
+{
+	// If false, moving the camera throws away the accumulation and the image
+	// restarts from 1 sample per pixel.
+	//
+	// If true, the image accumulated with the previous camera is reprojected onto the new
+	// camera and blended with the new samples. Pixels whose reprojected history doesn't look
+	// like the same surface (depth, normal and material, see check_neighbor_similarity_heuristics())
+	// restart from 1 sample per pixel
+	bool do_temporal_reprojection = false;
+
+	// Confidence (in number of samples) that the reprojected history of a pixel is capped to
+	// on the frames where the camera moves.
+	//
+	// Higher values give a less noisy image during the motion but the shading that doesn't
+	// follow the surfaces (reflections, view dependent specular) lags behind the camera
+	int max_history_length = 16;
+
+	// Set by the renderer on the frames where the camera moved since the last frame.
+	// If false, the history of a pixel is read at the same pixel, without reprojection
+	bool camera_moved = false;
+
+	// Average color of each pixel after the blending of the current frame.
+	// Swapped with the 'prev' buffers after each frame
+	ColorRGB32F* history = nullptr;
+	ColorRGB32F* prev_history = nullptr;
+	// How many samples (the confidence) each pixel of 'history' is an average of
+	int* history_length = nullptr;
+	int* prev_history_length = nullptr;
+};
+
+#endif
@@ -8,6 +8,24 @@
 
 #include "HostDeviceCommon/Color.h"
 
+/**
+ * Entry of the alias table used for importance sampling the envmap, one per texel.
+ *
+ * 16 bytes so that picking a texel is a single fetch: the PDFs of both the texel
+ * and its alias are stored so that picking the alias doesn't need a second fetch
+ */
+struct EnvmapAliasTableEntry
+{
+	// Probability of keeping this texel instead of picking its alias
+	float probability = 1.0f;
+	unsigned int alias = 0;
+
+	// PDFs in solid angle measure of sampling a direction in this texel and
+	// in the alias texel. See WorldSettings::envmap_total_sum
+	float pdf = 0.0f;
+	float alias_pdf = 0.0f;
+};
+
 enum AmbientLightType
 {
 	NONE,
@@ -35,16 +53,20 @@ struct WorldSettings
 	// Proper reinterpreting of the pointer is done in the kernel.
 	void* envmap = nullptr;
 
-	// Luminance sum of all the texels of the envmap
+	// Sum over all the texels of the envmap of their luminance times the solid
+	// angle that they cover (envmap intensity not included).
+	//
+	// The texels are importance sampled proportionally to that product so the PDF in solid
+	// angle measure of a direction is the luminance of its texel divided by this sum.
+	// There is no division by sin(theta) and the poles aren't oversampled
 	float envmap_total_sum = 0.0f;
 
 	// Cumulative distribution function. 1D float array of length width * height for
 	// importance sampling the envmap with a binary search strategy
 	float* envmap_cdf = nullptr;
 
-	// Probabilities and aliases for sampling the envmap with the alias table strategy
-	int* alias_table_alias = nullptr;
-	float* alias_table_probas = nullptr;
+	// width * height entries for sampling the envmap with the alias table strategy
+	EnvmapAliasTableEntry* alias_table = nullptr;
 
 	// Rotation matrix for rotating the envmap around in the current frame
 	float4x4 envmap_to_world_matrix = float4x4{ { {1.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 1.0f } } };
@@ -0,0 +1,259 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#include "Image/DisplayPipeline.h"
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+// The encoding LUT covers the tonemapped values in [2^-24, 1]. Below 2^-24, all encodings
+// are 0 in 8 bit and denormals in half float anyway
+static constexpr int ENCODING_LUT_MIN_EXPONENT = -24;
+// Number of bits of the mantissa used to index the LUT. 2^8 entries per power of 2
+static constexpr int ENCODING_LUT_MANTISSA_BITS = 8;
+static constexpr int ENCODING_LUT_SHIFT = 23 - ENCODING_LUT_MANTISSA_BITS;
+static constexpr uint32_t ENCODING_LUT_MIN_BITS = static_cast<uint32_t>(127 + ENCODING_LUT_MIN_EXPONENT) << 23;
+static constexpr uint32_t ENCODING_LUT_ONE_BITS = static_cast<uint32_t>(127) << 23;
+// + 2 because the entry of 1.0f is interpolated with the one after it
+static constexpr int ENCODING_LUT_SIZE = ((ENCODING_LUT_ONE_BITS - ENCODING_LUT_MIN_BITS) >> ENCODING_LUT_SHIFT) + 2;
+
+static const float ENCODING_LUT_MIN = std::bit_cast<float>(ENCODING_LUT_MIN_BITS);
+
+/**
+ * exp(-x) for x >= 0.
+ *
+ * Computed as 2^(-x * log2(e)) with the integer part of the exponent put in the exponent
+ * bits of the float and a polynomial for 2^fractional_part. Relative error around 1.0e-5.
+ * No branches so that the loops calling this are vectorized
+ */
+static inline float fast_exp_negative(float x)
+{
+    float y = -x * 1.44269504f;
+    // Below 2^-126, the result would be a denormal, 0 is close enough
+    y = y > -126.0f ? y : -126.0f;
+
+    float integer_part = std::floor(y);
+    float f = y - integer_part;
+
+    // Taylor expansion of 2^f on [0, 1)
+    float two_pow_f = 1.0f + f * (0.693147181f + f * (0.240226507f + f * (0.0555041087f + f * (0.00961812911f + f * (0.00133335581f + f * 0.000154035304f)))));
+    float two_pow_integer = std::bit_cast<float>(static_cast<uint32_t>(static_cast<int>(integer_part) + 127) << 23);
+
+    return two_pow_f * two_pow_integer;
+}
+
+static float encode_exact(float x, DisplayEncoding encoding, float gamma)
+{
+    switch (encoding)
+    {
+    case DisplayEncoding::GAMMA:
+        return std::pow(x, 1.0f / gamma);
+
+    case DisplayEncoding::SRGB:
+        return x <= 0.0031308f ? 12.92f * x : 1.055f * std::pow(x, 1.0f / 2.4f) - 0.055f;
+
+    case DisplayEncoding::LINEAR:
+    default:
+        return x;
+    }
+}
+
+DisplayPipeline::DisplayPipeline(const DisplayPipelineSettings& settings) : m_settings(settings)
+{
+    build_encoding_LUT();
+}
+
+const DisplayPipelineSettings& DisplayPipeline::get_settings() const
+{
+    return m_settings;
+}
+
+void DisplayPipeline::set_settings(const DisplayPipelineSettings& settings)
+{
+    bool rebuild_LUT = settings.encoding != m_settings.encoding || settings.gamma != m_settings.gamma;
+
+    m_settings = settings;
+    if (rebuild_LUT)
+        build_encoding_LUT();
+}
+
+void DisplayPipeline::build_encoding_LUT()
+{
+    m_encoding_LUT.resize(ENCODING_LUT_SIZE);
+
+    for (int i = 0; i < ENCODING_LUT_SIZE; i++)
+    {
+        // Value at the start of the bucket of this entry
+        float x = std::bit_cast<float>(ENCODING_LUT_MIN_BITS + (static_cast<uint32_t>(i) << ENCODING_LUT_SHIFT));
+
+        m_encoding_LUT[i] = encode_exact(x, m_settings.encoding, m_settings.gamma);
+    }
+}
+
+void DisplayPipeline::tone_map_channel(float* channel, int count) const
+{
+    switch (m_settings.tone_map_operator)
+    {
+    case ToneMapOperator::EXPONENTIAL:
+#pragma omp simd
+        for (int i = 0; i < count; i++)
+        {
+            float x = channel[i] > 0.0f ? channel[i] : 0.0f;
+
+            // 1 - exp(-x) loses all its precision for small x (the darks), the
+            // Taylor expansion is used instead there
+            float taylor = x * (1.0f - x * (0.5f - x * (0.166666667f - x * 0.0416666667f)));
+            channel[i] = x < 0.0625f ? taylor : 1.0f - fast_exp_negative(x);
+        }
+        break;
+
+    case ToneMapOperator::REINHARD:
+#pragma omp simd
+        for (int i = 0; i < count; i++)
+        {
+            float x = channel[i] > 0.0f ? channel[i] : 0.0f;
+
+            channel[i] = x / (1.0f + x);
+        }
+        break;
+
+    case ToneMapOperator::ACES:
+#pragma omp simd
+        for (int i = 0; i < count; i++)
+        {
+            float x = channel[i] > 0.0f ? channel[i] : 0.0f;
+
+            channel[i] = (x * (2.51f * x + 0.03f)) / (x * (2.43f * x + 0.59f) + 0.14f);
+        }
+        break;
+
+    case ToneMapOperator::NONE:
+    default:
+        break;
+    }
+}
+
+void DisplayPipeline::encode_channel(float* channel, int count) const
+{
+    if (m_settings.encoding == DisplayEncoding::LINEAR)
+        return;
+
+    const float* LUT = m_encoding_LUT.data();
+
+#pragma omp simd
+    for (int i = 0; i < count; i++)
+    {
+        // Written that way so that NaNs end up at ENCODING_LUT_MIN
+        float x = channel[i] > ENCODING_LUT_MIN ? channel[i] : ENCODING_LUT_MIN;
+        x = x < 1.0f ? x : 1.0f;
+
+        uint32_t offset = std::bit_cast<uint32_t>(x) - ENCODING_LUT_MIN_BITS;
+        uint32_t index = offset >> ENCODING_LUT_SHIFT;
+        float t = static_cast<float>(offset & ((1u << ENCODING_LUT_SHIFT) - 1)) * (1.0f / (1u << ENCODING_LUT_SHIFT));
+
+        channel[i] = LUT[index] + (LUT[index + 1] - LUT[index]) * t;
+    }
+}
+
+void DisplayPipeline::process_row(const ColorRGB32F* hdr_row, int width, float sample_scale, float* row_r, float* row_g, float* row_b) const
+{
+    float scale = sample_scale * m_settings.exposure;
+
+#pragma omp simd
+    for (int x = 0; x < width; x++)
+    {
+        row_r[x] = hdr_row[x].r * scale;
+        row_g[x] = hdr_row[x].g * scale;
+        row_b[x] = hdr_row[x].b * scale;
+    }
+
+    tone_map_channel(row_r, width);
+    tone_map_channel(row_g, width);
+    tone_map_channel(row_b, width);
+
+    encode_channel(row_r, width);
+    encode_channel(row_g, width);
+    encode_channel(row_b, width);
+}
+
+void DisplayPipeline::process(const ColorRGB32F* hdr_pixels, int width, int height, float sample_scale, unsigned char* out_pixels) const
+{
+#pragma omp parallel
+    {
+        // Channels of the row being processed by this thread
+        std::vector<float> row_r(width), row_g(width), row_b(width);
+
+#pragma omp for
+        for (int y = 0; y < height; y++)
+        {
+            process_row(hdr_pixels + y * width, width, sample_scale, row_r.data(), row_g.data(), row_b.data());
+
+            unsigned char* out_row = out_pixels + y * width * 3;
+#pragma omp simd
+            for (int x = 0; x < width; x++)
+            {
+                // NaNs end up black
+                float r = row_r[x] > 0.0f ? row_r[x] : 0.0f;
+                float g = row_g[x] > 0.0f ? row_g[x] : 0.0f;
+                float b = row_b[x] > 0.0f ? row_b[x] : 0.0f;
+                r = r < 1.0f ? r : 1.0f;
+                g = g < 1.0f ? g : 1.0f;
+                b = b < 1.0f ? b : 1.0f;
+
+                out_row[x * 3 + 0] = static_cast<unsigned char>(r * 255.0f + 0.5f);
+                out_row[x * 3 + 1] = static_cast<unsigned char>(g * 255.0f + 0.5f);
+                out_row[x * 3 + 2] = static_cast<unsigned char>(b * 255.0f + 0.5f);
+            }
+        }
+    }
+}
+
+void DisplayPipeline::process(const ColorRGB32F* hdr_pixels, int width, int height, float sample_scale, ColorRGB32F* out_pixels) const
+{
+#pragma omp parallel
+    {
+        std::vector<float> row_r(width), row_g(width), row_b(width);
+
+#pragma omp for
+        for (int y = 0; y < height; y++)
+        {
+            process_row(hdr_pixels + y * width, width, sample_scale, row_r.data(), row_g.data(), row_b.data());
+
+            ColorRGB32F* out_row = out_pixels + y * width;
+#pragma omp simd
+            for (int x = 0; x < width; x++)
+            {
+                out_row[x].r = row_r[x];
+                out_row[x].g = row_g[x];
+                out_row[x].b = row_b[x];
+            }
+        }
+    }
+}
+
+std::vector<unsigned char> DisplayPipeline::process_to_8bit(const ColorRGB32F* hdr_pixels, int width, int height, float sample_scale) const
+{
+    std::vector<unsigned char> out_pixels(width * height * 3);
+    process(hdr_pixels, width, height, sample_scale, out_pixels.data());
+
+    return out_pixels;
+}
+
+bool DisplayPipeline::parse_tone_map_operator(const std::string& operator_string, ToneMapOperator& out_operator)
+{
+    if (operator_string == "none")
+        out_operator = ToneMapOperator::NONE;
+    else if (operator_string == "exponential")
+        out_operator = ToneMapOperator::EXPONENTIAL;
+    else if (operator_string == "reinhard")
+        out_operator = ToneMapOperator::REINHARD;
+    else if (operator_string == "aces")
+        out_operator = ToneMapOperator::ACES;
+    else
+        return false;
+
+    return true;
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef DISPLAY_PIPELINE_H
+#define DISPLAY_PIPELINE_H
+
+#include "HostDeviceCommon/Color.h"
+
+#include <string>
+#include <vector>
+
+enum class ToneMapOperator
+{
+    // Linear, only clamped to [0, 1] for the 8 bit output
+    NONE,
+    // 1 - exp(-x), what the renderer has always used
+    EXPONENTIAL,
+    // x / (1 + x)
+    REINHARD,
+    // Narkowicz's fit of the ACES filmic curve
+    ACES
+};
+
+enum class DisplayEncoding
+{
+    // Linear output, for HDR images
+    LINEAR,
+    // pow(x, 1 / gamma)
+    GAMMA,
+    // Piecewise sRGB transfer function
+    SRGB
+};
+
+struct DisplayPipelineSettings
+{
+    ToneMapOperator tone_map_operator = ToneMapOperator::EXPONENTIAL;
+    DisplayEncoding encoding = DisplayEncoding::GAMMA;
+
+    float exposure = 1.0f;
+    float gamma = 2.2f;
+};
+
+/**
+ * Converts HDR pixels (the accumulation buffer of a renderer, a denoised image, ...)
+ * into displayable pixels written to a separate output: the input is never modified
+ * so this can be used on snapshots of a render that is still accumulating.
+ *
+ * Exposure and tonemapping are done on whole rows at a time, one channel after the
+ * other, in loops that the compiler vectorizes. The exponential of the EXPONENTIAL
+ * operator uses a polynomial approximation that is precise way beyond what the 8 bit
+ * and half float outputs can represent.
+ *
+ * The gamma / sRGB encoding is a lookup table indexed by the exponent and the high bits
+ * of the mantissa of the tonemapped value (so the table is as precise in the darks as in
+ * the highlights) and linearly interpolated.
+ *
+ * The rows are processed in parallel.
+ */
+class DisplayPipeline
+{
+public:
+    DisplayPipeline(const DisplayPipelineSettings& settings = DisplayPipelineSettings());
+
+    const DisplayPipelineSettings& get_settings() const;
+    /**
+     * The encoding lookup table is only rebuilt if the encoding or the gamma changed
+     */
+    void set_settings(const DisplayPipelineSettings& settings);
+
+    /**
+     * 'sample_scale' multiplies the input pixels before the exposure.
+     * 1.0f / sample_number for a framebuffer that holds the sum of the samples for example.
+     *
+     * 'out_pixels' must have room for width * height * 3 values
+     */
+    void process(const ColorRGB32F* hdr_pixels, int width, int height, float sample_scale, unsigned char* out_pixels) const;
+    void process(const ColorRGB32F* hdr_pixels, int width, int height, float sample_scale, ColorRGB32F* out_pixels) const;
+
+    std::vector<unsigned char> process_to_8bit(const ColorRGB32F* hdr_pixels, int width, int height, float sample_scale) const;
+
+    /**
+     * Parses "none", "exponential", "reinhard" or "aces" into 'out_operator'.
+     * Returns false if the string isn't one of those
+     */
+    static bool parse_tone_map_operator(const std::string& operator_string, ToneMapOperator& out_operator);
+
+private:
+    void build_encoding_LUT();
+
+    /**
+     * Applies exposure, tonemapping and encoding to one row of pixels.
+     * The results are left in 'row_r', 'row_g' and 'row_b'
+     */
+    void process_row(const ColorRGB32F* hdr_row, int width, float sample_scale, float* row_r, float* row_g, float* row_b) const;
+
+    void tone_map_channel(float* channel, int count) const;
+    void encode_channel(float* channel, int count) const;
+
+    DisplayPipelineSettings m_settings;
+
+    // Encoded values of the tonemapped values in [ENCODING_LUT_MIN, 1]
+    std::vector<float> m_encoding_LUT;
+};
+
+#endif
@@ -102,7 +102,9 @@ bool Image8Bit::write_image_png(const char* filename, const bool flipY) const
         for (int j = 0; j < channels; j++)
             tmp[i * channels + j] = hippt::clamp(static_cast<unsigned char>(0), static_cast<unsigned char>(255), m_pixel_data[i * channels + j]);
 
-    stbi_flip_vertically_on_write(flipY);
+    if (flipY)
+        flip_image_rows(tmp, width, height, channels);
+
     return stbi_write_png(filename, width, height, channels, tmp.data(), width * channels) != 0;
 }
 
@@ -116,8 +118,10 @@ bool Image8Bit::write_image_hdr(const char* filename, const bool flipY) const
         for (int j = 0; j < channels; j++)
             tmp[i * channels + j] = m_pixel_data[i * channels + j] / 255.0f;
 
-    stbi_flip_vertically_on_write(flipY);
-    return stbi_write_hdr(filename, width, height, channels, reinterpret_cast<const float*>(m_pixel_data.data())) != 0;
+    if (flipY)
+        flip_image_rows(tmp, width, height, channels);
+
+    return stbi_write_hdr(filename, width, height, channels, tmp.data()) != 0;
 }
 
 float Image8Bit::luminance_of_pixel(int x, int y) const
@@ -270,6 +274,18 @@ bool Image8Bit::is_constant_color(int threshold) const
     return true;
 }
 
+bool Image8Bit::is_fully_opaque() const
+{
+    if (channels != 4)
+        return true;
+
+    for (size_t i = 3; i < m_pixel_data.size(); i += 4)
+        if (m_pixel_data[i] != 255)
+            return false;
+
+    return true;
+}
+
 void Image8Bit::free()
 {
     m_pixel_data.clear();
@@ -433,7 +449,9 @@ bool Image32Bit::write_image_png(const char* filename, const bool flipY) const
     for (unsigned i = 0; i < width * height * channels; i++)
         tmp[i] = hippt::clamp(0.0f, 255.0f, m_pixel_data[i] * 255.0f);
 
-    stbi_flip_vertically_on_write(flipY);
+    if (flipY)
+        flip_image_rows(tmp, width, height, channels);
+
     return stbi_write_png(filename, width, height, channels, tmp.data(), width * channels) != 0;
 }
 
@@ -447,8 +465,10 @@ bool Image32Bit::write_image_hdr(const char* filename, const bool flipY) const
         for (int j = 0; j < channels; j++)
             tmp[i * channels + j] = m_pixel_data[i * channels + j];
 
-    stbi_flip_vertically_on_write(flipY);
-    return stbi_write_hdr(filename, width, height, channels, reinterpret_cast<const float*>(m_pixel_data.data())) != 0;
+    if (flipY)
+        flip_image_rows(tmp, width, height, channels);
+
+    return stbi_write_hdr(filename, width, height, channels, tmp.data()) != 0;
 }
 
 float Image32Bit::luminance_of_pixel(int x, int y) const
@@ -491,38 +511,7 @@ float Image32Bit::luminance_of_area(const ImageBin& area) const
 
 ColorRGBA32F Image32Bit::sample_rgba32f(float2 uv) const
 {
-    // Sampling in repeat mode so we're just keeping the fractional part
-    float u = uv.x;
-    if (u != 1.0f)
-        // Only doing that if u != 1.0f because if we actually have
-        // uv.x == 1.0f, then subtracting static_cast<int>(uv.x) will
-        // give us 0.0f even though we actually want 1.0f (which is correct).
-        // 
-        // Basically, 1.0f gets transformed into 0.0f even though 1.0f is a correct
-        // U coordinate which needs not to be wrapped
-        u -= static_cast<int>(uv.x);
-
-    float v = uv.y;
-    if (v != 1.0f)
-        // Same for v
-        v -= static_cast<int>(uv.y);
-
-    // For negative UVs, we also want to repeat and we want, for example, 
-    // -0.1f to behave as 0.9f
-    u = u < 0 ? 1.0f + u : u;
-    v = v < 0 ? 1.0f + v : v;
-
-    // Sampling with [0, 0] bottom-left convention
-    v = 1.0f - v;
-
-    int x = (u * (width - 1));
-    int y = (v * (height - 1));
-
-    ColorRGBA32F out_color;
-    for (int i = 0; i < channels; i++)
-        out_color[i] = m_pixel_data[(x + y * width) * channels + i];
-
-    return out_color;
+    return Image32BitView(m_pixel_data.data(), width, height, channels).sample_rgba32f(uv);
 }
 
 void Image32Bit::set_data(const std::vector<float>& data)
@@ -550,23 +539,30 @@ float& Image32Bit::operator[](int index)
     return m_pixel_data[index];
 }
 
+float Image32Bit::texel_solid_angle(int y) const
+{
+    // The row 'y' spans theta in [y * PI / height, (y + 1) * PI / height]
+    float cos_theta_top = std::cos(y * M_PI / height);
+    float cos_theta_bottom = std::cos((y + 1) * M_PI / height);
+
+    return M_TWO_PI / width * (cos_theta_top - cos_theta_bottom);
+}
+
 std::vector<float> Image32Bit::compute_cdf() const
 {
     std::vector<float> out_cdf;
     out_cdf.resize(height * width);
-    out_cdf[0] = 0.0f;
 
-    float max_radiance = 0.0f;
+    float cumulative_sum = 0.0f;
     for (int y = 0; y < height; y++)
     {
+        float solid_angle = texel_solid_angle(y);
         for (int x = 0; x < width; x++)
         {
             int index = y * width + x;
 
-            out_cdf[index] = out_cdf[std::max(index - 1, 0)] + luminance_of_pixel(x, y);
-
-            for (int i = 0; i < hippt::min(3, channels); i++)
-                max_radiance = hippt::max(max_radiance, m_pixel_data[(x + y * width) * channels + i]);
+            cumulative_sum += luminance_of_pixel(x, y) * solid_angle;
+            out_cdf[index] = cumulative_sum;
         }
     }
 
@@ -576,48 +572,48 @@ std::vector<float> Image32Bit::compute_cdf() const
 /**
  * Reference: Vose's Alias Method [https://www.keithschwarz.com/darts-dice-coins/]
  */
-void Image32Bit::compute_alias_table(std::vector<float>& out_probas, std::vector<int>& out_alias, float* out_luminance_total_sum) const
+void Image32Bit::compute_alias_table(std::vector<EnvmapAliasTableEntry>& out_alias_table, float* out_luminance_total_sum) const
 {
-    // TODO try using floats here to reduce memory usage during the construction and see if precision is an issue or not
-
-    // A vector of the luminance of all the pixels of the envmap
-    // normalized such that the average of the elements of this vector is 'width*height'
-    std::vector<double> normalized_luminance_of_pixels(width * height);
-    double luminance_sum = 0.0f;
+    // The weights of the texels (luminance times solid angle)
+    // normalized such that the average of the elements of this vector is 1
+    std::vector<double> normalized_weights(width * height);
+    double weights_sum = 0.0;
     for (int y = 0; y < height; y++)
     {
+        double solid_angle = static_cast<double>(texel_solid_angle(y));
         for (int x = 0; x < width; x++)
         {
             int index = y * width + x;
 
-            double luminance = static_cast<double>(luminance_of_pixel(x, y));
-            normalized_luminance_of_pixels[index] = luminance;
-            luminance_sum += luminance;
+            double weight = static_cast<double>(luminance_of_pixel(x, y)) * solid_angle;
+            normalized_weights[index] = weight;
+            weights_sum += weight;
         }
     }
 
     if (out_luminance_total_sum != nullptr)
-        *out_luminance_total_sum = luminance_sum;
+        *out_luminance_total_sum = static_cast<float>(weights_sum);
 
-    for (double& luminance_value : normalized_luminance_of_pixels)
+    out_alias_table.resize(width * height);
+    for (int y = 0; y < height; y++)
     {
-        // Normalize so that the sum of the elements is 1
-        luminance_value /= luminance_sum;
+        for (int x = 0; x < width; x++)
+        {
+            int index = y * width + x;
 
-        // Scale for alias table construction such that the average of
-        // the elements is 1
-        luminance_value *= (width * height);
+            // The solid angle of the texel cancels out in the PDF in solid angle measure
+            out_alias_table[index].pdf = static_cast<float>(luminance_of_pixel(x, y) / weights_sum);
+            out_alias_table[index].alias = index;
+            normalized_weights[index] *= (width * height) / weights_sum;
+        }
     }
 
-    out_probas.resize(width * height);
-    out_alias.resize(width * height);
-
     std::deque<int> small;
     std::deque<int> large;
 
-    for (int i = 0; i < normalized_luminance_of_pixels.size(); i++)
+    for (int i = 0; i < normalized_weights.size(); i++)
     {
-        if (normalized_luminance_of_pixels[i] < 1.0)
+        if (normalized_weights[i] < 1.0)
             small.push_back(i);
         else
             large.push_back(i);
@@ -631,31 +627,32 @@ void Image32Bit::compute_alias_table(std::vector<float>& out_probas, std::vector
         small.pop_front();
         large.pop_front();
 
-        out_probas[small_index] = normalized_luminance_of_pixels[small_index];
-        out_alias[small_index] = large_index;
+        out_alias_table[small_index].probability = normalized_weights[small_index];
+        out_alias_table[small_index].alias = large_index;
 
-        normalized_luminance_of_pixels[large_index] = (normalized_luminance_of_pixels[large_index] + normalized_luminance_of_pixels[small_index]) - 1.0;
-        if (normalized_luminance_of_pixels[large_index] > 1.0)
+        normalized_weights[large_index] = (normalized_weights[large_index] + normalized_weights[small_index]) - 1.0;
+        if (normalized_weights[large_index] > 1.0)
             large.push_back(large_index);
         else
             small.push_back(large_index);
     }
 
+    // The remaining texels keep themselves with a probability of 1
+    // (numerical errors for the small ones)
     while (!large.empty())
     {
-        int index = large.front();
+        out_alias_table[large.front()].probability = 1.0f;
         large.pop_front();
-
-        out_probas[index] = 1.0;
     }
 
     while (!small.empty())
     {
-        int index = small.front();
+        out_alias_table[small.front()].probability = 1.0f;
         small.pop_front();
-
-        out_probas[index] = 1.0;
     }
+
+    for (EnvmapAliasTableEntry& entry : out_alias_table)
+        entry.alias_pdf = out_alias_table[entry.alias].pdf;
 }
 
 size_t Image32Bit::byte_size() const
@@ -714,6 +711,44 @@ void Image32Bit::free()
     channels = 0;
 }
 
+Image32BitView::Image32BitView(const float* data, int width, int height, int channels) : data(data), width(width), height(height), channels(channels) {}
+
+ColorRGBA32F Image32BitView::sample_rgba32f(float2 uv) const
+{
+    // Sampling in repeat mode so we're just keeping the fractional part
+    float u = uv.x;
+    if (u != 1.0f)
+        // Only doing that if u != 1.0f because if we actually have
+        // uv.x == 1.0f, then subtracting static_cast<int>(uv.x) will
+        // give us 0.0f even though we actually want 1.0f (which is correct).
+        // 
+        // Basically, 1.0f gets transformed into 0.0f even though 1.0f is a correct
+        // U coordinate which needs not to be wrapped
+        u -= static_cast<int>(uv.x);
+
+    float v = uv.y;
+    if (v != 1.0f)
+        // Same for v
+        v -= static_cast<int>(uv.y);
+
+    // For negative UVs, we also want to repeat and we want, for example, 
+    // -0.1f to behave as 0.9f
+    u = u < 0 ? 1.0f + u : u;
+    v = v < 0 ? 1.0f + v : v;
+
+    // Sampling with [0, 0] bottom-left convention
+    v = 1.0f - v;
+
+    int x = (u * (width - 1));
+    int y = (v * (height - 1));
+
+    ColorRGBA32F out_color;
+    for (int i = 0; i < channels; i++)
+        out_color[i] = data[(x + y * width) * channels + i];
+
+    return out_color;
+}
+
 Image32Bit3D::Image32Bit3D() 
 {
     width = 0;
@@ -7,12 +7,15 @@
 #define IMAGE_H
 
 #include "HostDeviceCommon/Color.h"
+#include "HostDeviceCommon/WorldSettings.h"
 
 #include "stb_image.h"
 #include "stb_image_write.h"
 
+#include <algorithm>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 struct ImageBin
 {
@@ -20,6 +23,21 @@ struct ImageBin
     int y0, y1;
 };
 
+/**
+ * Flips the rows of the given pixels in place.
+ *
+ * The images are flipped with this function before being written and never with
+ * stbi_flip_vertically_on_write(): the flag of stb is a global, shared by all the
+ * threads that write images at the same time (background denoiser, image writer pool, ...)
+ */
+template <typename T>
+void flip_image_rows(std::vector<T>& pixels, int width, int height, int channels)
+{
+    size_t row_size = static_cast<size_t>(width) * channels;
+    for (int y = 0; y < height / 2; y++)
+        std::swap_ranges(pixels.begin() + y * row_size, pixels.begin() + (y + 1) * row_size, pixels.begin() + (height - 1 - y) * row_size);
+}
+
 class Image8Bit
 {
 public:
@@ -61,6 +79,12 @@ public:
      */ 
      bool is_constant_color(int threshold = 0) const;
 
+    /**
+     * Returns true if the image doesn't have an alpha channel
+     * or if the alpha of all its pixels is 255
+     */
+    bool is_fully_opaque() const;
+
     /**
      * Frees the data of this image and sets its width, height and channels back to 0
      */
@@ -105,8 +129,20 @@ public:
     const float& operator[](int index) const;
     float& operator[](int index);
 
+    /**
+     * The CDF and the alias table consider the image as an equirectangular envmap:
+     * the texels are weighted by their luminance times the solid angle that they
+     * cover so that the texels near the poles aren't oversampled.
+     *
+     * 'out_luminance_total_sum' is the sum of these weights, see WorldSettings::envmap_total_sum
+     */
     std::vector<float> compute_cdf() const;
-    void compute_alias_table(std::vector<float>& out_probas, std::vector<int>& out_alias, float* out_luminance_total_sum = nullptr) const;
+    void compute_alias_table(std::vector<EnvmapAliasTableEntry>& out_alias_table, float* out_luminance_total_sum = nullptr) const;
+
+    /**
+     * Solid angle covered by the texels of the row 'y' of an equirectangular envmap of this size
+     */
+    float texel_solid_angle(int y) const;
 
     size_t byte_size() const;
 
@@ -131,6 +167,24 @@ protected:
     std::vector<float> m_pixel_data;
 };
 
+/**
+ * Non-owning, read-only view over 32 bit floating point pixels.
+ * 
+ * This is used to sample data that doesn't live in an Image32Bit
+ * (such as constant LUTs compiled in the executable) without copying it
+ */
+class Image32BitView
+{
+public:
+    Image32BitView() {}
+    Image32BitView(const float* data, int width, int height, int channels);
+
+    ColorRGBA32F sample_rgba32f(float2 uv) const;
+
+    const float* data = nullptr;
+    int width = 0, height = 0, channels = 0;
+};
+
 class Image32Bit3D
 {
 public:
@@ -0,0 +1,154 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#include "Image/ImageWriterPool.h"
+#include "UI/ImGui/ImGuiLogger.h"
+
+#include "stb_image_write.h"
+
+#include <algorithm>
+
+extern ImGuiLogger g_imgui_logger;
+
+ImageWriterPool::ImageWriterPool(int worker_count, int max_queued_images) : m_max_queued_images(std::max(1, max_queued_images))
+{
+    for (int i = 0; i < std::max(1, worker_count); i++)
+        m_workers.emplace_back(&ImageWriterPool::worker_thread_function, this);
+}
+
+ImageWriterPool::~ImageWriterPool()
+{
+    // Writing everything that is still queued before stopping
+    wait_idle();
+
+    {
+        std::lock_guard<std::mutex> lock(m_jobs_mutex);
+        m_stop_workers = true;
+    }
+    m_job_available_condition.notify_all();
+
+    for (std::thread& worker : m_workers)
+        worker.join();
+}
+
+void ImageWriterPool::write_png(std::vector<unsigned char>&& pixels, int width, int height, int channels, const std::string& filepath, bool flipY)
+{
+    ImageWriteJob job;
+    job.pixels_8bit = std::move(pixels);
+    job.width = width;
+    job.height = height;
+    job.channels = channels;
+    job.format = PNG;
+    job.filepath = filepath;
+    job.flipY = flipY;
+
+    push_job(std::move(job));
+}
+
+void ImageWriterPool::write_image(Image32Bit&& image, ImageFormat format, const std::string& filepath, bool flipY)
+{
+    ImageWriteJob job;
+    job.width = image.width;
+    job.height = image.height;
+    job.channels = image.channels;
+    job.image_32bit = std::move(image);
+    job.format = format;
+    job.filepath = filepath;
+    job.flipY = flipY;
+
+    push_job(std::move(job));
+}
+
+void ImageWriterPool::wait_idle()
+{
+    std::unique_lock<std::mutex> lock(m_jobs_mutex);
+
+    m_job_done_condition.wait(lock, [this]() { return m_jobs.empty() && m_jobs_in_progress == 0; });
+}
+
+void ImageWriterPool::push_job(ImageWriteJob&& job)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_jobs_mutex);
+
+        // Back-pressure: waiting for a worker to make room in the queue
+        m_job_done_condition.wait(lock, [this]() { return static_cast<int>(m_jobs.size()) < m_max_queued_images; });
+
+        m_jobs.push_back(std::move(job));
+    }
+
+    m_job_available_condition.notify_one();
+}
+
+void ImageWriterPool::worker_thread_function()
+{
+    while (true)
+    {
+        ImageWriteJob job;
+
+        {
+            std::unique_lock<std::mutex> lock(m_jobs_mutex);
+            m_job_available_condition.wait(lock, [this]() { return m_stop_workers || !m_jobs.empty(); });
+
+            if (m_jobs.empty())
+                // Stopping and nothing left to write
+                break;
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+            m_jobs_in_progress++;
+        }
+        // There's room in the queue now
+        m_job_done_condition.notify_all();
+
+        write_job(job);
+
+        {
+            std::lock_guard<std::mutex> lock(m_jobs_mutex);
+            m_jobs_in_progress--;
+        }
+        m_job_done_condition.notify_all();
+    }
+}
+
+void ImageWriterPool::write_job(ImageWriteJob& job)
+{
+    bool success = false;
+
+    if (job.format == PNG)
+    {
+        if (job.pixels_8bit.empty())
+        {
+            // Quantizing the floating point image
+            const std::vector<float>& image_data = job.image_32bit.data();
+
+            job.pixels_8bit.resize(image_data.size());
+            for (size_t i = 0; i < image_data.size(); i++)
+                job.pixels_8bit[i] = static_cast<unsigned char>(hippt::clamp(0.0f, 255.0f, image_data[i] * 255.0f));
+
+            job.image_32bit.free();
+        }
+
+        // Flipping the pixels owned by the job, see flip_image_rows()
+        if (job.flipY)
+            flip_image_rows(job.pixels_8bit, job.width, job.height, job.channels);
+
+        success = stbi_write_png(job.filepath.c_str(), job.width, job.height, job.channels, job.pixels_8bit.data(), job.width * job.channels) != 0;
+    }
+    else
+    {
+        std::vector<float>& image_data = job.image_32bit.data();
+
+        if (job.flipY)
+            flip_image_rows(image_data, job.width, job.height, job.channels);
+
+        success = stbi_write_hdr(job.filepath.c_str(), job.width, job.height, job.channels, image_data.data()) != 0;
+    }
+
+    if (success)
+        g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_INFO, "Image written to \"%s\"", job.filepath.c_str());
+    else
+        g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "Could not write image \"%s\"", job.filepath.c_str());
+}
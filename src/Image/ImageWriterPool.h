@@ -0,0 +1,96 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef IMAGE_WRITER_POOL_H
+#define IMAGE_WRITER_POOL_H
+
+#include "Image/Image.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Pool of threads that encode and write images to disk in the background.
+ *
+ * The write functions take ownership of the pixels (std::move them in, no copy) and return
+ * immediately so that, when rendering a frame sequence, the rendering of frame N + 1 overlaps
+ * with the encoding of frame N. The images are encoded in parallel by the workers.
+ *
+ * The queue is bounded: if 'max_queued_images' images are already waiting to be written,
+ * the write functions block until a worker picks one up. This caps the memory used by the
+ * pending images if the renderer produces images faster than they can be encoded.
+ *
+ * The vertical flip is done by the workers on the owned pixels with flip_image_rows(),
+ * the global flag of stb (stbi_flip_vertically_on_write()) is never set.
+ */
+class ImageWriterPool
+{
+public:
+    enum ImageFormat
+    {
+        PNG,
+        HDR
+    };
+
+    ImageWriterPool(int worker_count = 2, int max_queued_images = 4);
+    ~ImageWriterPool();
+
+    ImageWriterPool(const ImageWriterPool& other) = delete;
+    ImageWriterPool& operator=(const ImageWriterPool& other) = delete;
+
+    /**
+     * Writes 8 bit pixels as a PNG
+     */
+    void write_png(std::vector<unsigned char>&& pixels, int width, int height, int channels, const std::string& filepath, bool flipY);
+
+    /**
+     * Writes a floating point image. The pixels are clamped to [0, 1]
+     * and quantized to 8 bit for the PNG format, as Image32Bit::write_image_png() does
+     */
+    void write_image(Image32Bit&& image, ImageFormat format, const std::string& filepath, bool flipY);
+
+    /**
+     * Blocks until all the images given to the pool so far have been written
+     */
+    void wait_idle();
+
+private:
+    struct ImageWriteJob
+    {
+        // Only one of the two is used depending on what was given to the pool
+        std::vector<unsigned char> pixels_8bit;
+        Image32Bit image_32bit;
+
+        int width = 0, height = 0, channels = 0;
+        ImageFormat format = PNG;
+        std::string filepath;
+        bool flipY = false;
+    };
+
+    void push_job(ImageWriteJob&& job);
+    void worker_thread_function();
+    static void write_job(ImageWriteJob& job);
+
+    int m_max_queued_images;
+
+    std::deque<ImageWriteJob> m_jobs;
+    // Number of jobs popped by the workers but not written yet
+    int m_jobs_in_progress = 0;
+    bool m_stop_workers = false;
+
+    std::mutex m_jobs_mutex;
+    // Signaled when a job is pushed or when the workers should stop
+    std::condition_variable m_job_available_condition;
+    // Signaled when a job is popped (there's room in the queue) or written (for wait_idle())
+    std::condition_variable m_job_done_condition;
+
+    std::vector<std::thread> m_workers;
+};
+
+#endif
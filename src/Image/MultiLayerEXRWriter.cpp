@@ -0,0 +1,183 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#include "Image/MultiLayerEXRWriter.h"
+#include "UI/ImGui/ImGuiLogger.h"
+
+// The implementation of tinyexr is compiled in Image.cpp
+#include "tinyexr.h"
+
+#include <algorithm>
+#include <cstring>
+
+extern ImGuiLogger g_imgui_logger;
+
+MultiLayerEXRWriter::MultiLayerEXRWriter(int width, int height) : m_width(width), m_height(height) {}
+
+MultiLayerEXRWriter::EXRChannel& MultiLayerEXRWriter::add_channel(const std::string& layer_name, const std::string& channel_name, PixelType pixel_type)
+{
+    EXRChannel channel;
+    channel.name = layer_name.empty() ? channel_name : layer_name + "." + channel_name;
+    channel.pixel_type = pixel_type;
+    channel.data.resize(m_width * m_height);
+
+    m_channels.push_back(std::move(channel));
+
+    return m_channels.back();
+}
+
+void MultiLayerEXRWriter::add_layer(const std::string& layer_name, const std::vector<std::string>& channel_names, const float* interleaved_data, PixelType pixel_type)
+{
+    int channel_count = static_cast<int>(channel_names.size());
+
+    for (int channel_index = 0; channel_index < channel_count; channel_index++)
+    {
+        EXRChannel& channel = add_channel(layer_name, channel_names[channel_index], pixel_type);
+
+#pragma omp parallel for
+        for (int i = 0; i < m_width * m_height; i++)
+            channel.data[i] = interleaved_data[i * channel_count + channel_index];
+    }
+}
+
+void MultiLayerEXRWriter::add_layer(const std::string& layer_name, const ColorRGB32F* data, PixelType pixel_type, float scale)
+{
+    EXRChannel& channel_R = add_channel(layer_name, "R", pixel_type);
+    EXRChannel& channel_G = add_channel(layer_name, "G", pixel_type);
+    EXRChannel& channel_B = add_channel(layer_name, "B", pixel_type);
+
+#pragma omp parallel for
+    for (int i = 0; i < m_width * m_height; i++)
+    {
+        channel_R.data[i] = data[i].r * scale;
+        channel_G.data[i] = data[i].g * scale;
+        channel_B.data[i] = data[i].b * scale;
+    }
+}
+
+void MultiLayerEXRWriter::add_layer(const std::string& layer_name, const float3* data, PixelType pixel_type)
+{
+    add_layer(layer_name, { "X", "Y", "Z" }, reinterpret_cast<const float*>(data), pixel_type);
+}
+
+void MultiLayerEXRWriter::add_layer(const std::string& layer_name, const float* data, PixelType pixel_type)
+{
+    add_layer(layer_name, { "Y" }, data, pixel_type);
+}
+
+void MultiLayerEXRWriter::add_layer(const std::string& layer_name, const int* data)
+{
+    EXRChannel& channel = add_channel(layer_name, "Y", PixelType::FLOAT);
+
+#pragma omp parallel for
+    for (int i = 0; i < m_width * m_height; i++)
+        channel.data[i] = static_cast<float>(data[i]);
+}
+
+bool MultiLayerEXRWriter::write(const std::string& filepath, Compression compression, bool flipY) const
+{
+    if (m_channels.empty())
+        return false;
+
+    // OpenEXR expects the channels sorted by name
+    std::vector<const EXRChannel*> sorted_channels;
+    for (const EXRChannel& channel : m_channels)
+        sorted_channels.push_back(&channel);
+    std::sort(sorted_channels.begin(), sorted_channels.end(), [](const EXRChannel* a, const EXRChannel* b) { return a->name < b->name; });
+
+    int channel_count = static_cast<int>(sorted_channels.size());
+
+    // Flipping the rows on copies of the channels, if needed, so that this function can stay const
+    std::vector<std::vector<float>> flipped_channels(flipY ? channel_count : 0);
+    std::vector<unsigned char*> channel_pointers(channel_count);
+    for (int i = 0; i < channel_count; i++)
+    {
+        const std::vector<float>& channel_data = sorted_channels[i]->data;
+
+        if (flipY)
+        {
+            flipped_channels[i].resize(channel_data.size());
+
+#pragma omp parallel for
+            for (int y = 0; y < m_height; y++)
+                std::copy(channel_data.begin() + y * m_width, channel_data.begin() + (y + 1) * m_width, flipped_channels[i].begin() + (m_height - 1 - y) * m_width);
+
+            channel_pointers[i] = reinterpret_cast<unsigned char*>(flipped_channels[i].data());
+        }
+        else
+            // tinyexr only reads the images when saving
+            channel_pointers[i] = reinterpret_cast<unsigned char*>(const_cast<float*>(channel_data.data()));
+    }
+
+    std::vector<EXRChannelInfo> channel_infos(channel_count);
+    std::vector<int> pixel_types(channel_count, TINYEXR_PIXELTYPE_FLOAT);
+    std::vector<int> requested_pixel_types(channel_count);
+    for (int i = 0; i < channel_count; i++)
+    {
+        std::memset(&channel_infos[i], 0, sizeof(EXRChannelInfo));
+        std::strncpy(channel_infos[i].name, sorted_channels[i]->name.c_str(), 255);
+
+        requested_pixel_types[i] = sorted_channels[i]->pixel_type == PixelType::HALF ? TINYEXR_PIXELTYPE_HALF : TINYEXR_PIXELTYPE_FLOAT;
+    }
+
+    EXRImage image;
+    InitEXRImage(&image);
+    image.images = channel_pointers.data();
+    image.num_channels = channel_count;
+    image.width = m_width;
+    image.height = m_height;
+
+    // The arrays of the header are owned by the vectors above,
+    // FreeEXRHeader() must not be called on this header
+    EXRHeader header;
+    InitEXRHeader(&header);
+    header.num_channels = channel_count;
+    header.channels = channel_infos.data();
+    header.pixel_types = pixel_types.data();
+    header.requested_pixel_types = requested_pixel_types.data();
+    switch (compression)
+    {
+    case Compression::NONE:
+        header.compression_type = TINYEXR_COMPRESSIONTYPE_NONE;
+        break;
+
+    case Compression::ZIP:
+        header.compression_type = TINYEXR_COMPRESSIONTYPE_ZIP;
+        break;
+
+    case Compression::PIZ:
+        header.compression_type = TINYEXR_COMPRESSIONTYPE_PIZ;
+        break;
+    }
+
+    const char* err = nullptr;
+    int ret = SaveEXRImageToFile(&image, &header, filepath.c_str(), &err);
+    if (ret != TINYEXR_SUCCESS)
+    {
+        g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "Error writing EXR image \"%s\": %s", filepath.c_str(), err ? err : "unknown error");
+        if (err)
+            FreeEXRErrorMessage(err);
+
+        return false;
+    }
+
+    g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_INFO, "EXR image with %d channels written to \"%s\"", channel_count, filepath.c_str());
+
+    return true;
+}
+
+bool MultiLayerEXRWriter::parse_compression(const std::string& compression_string, Compression& out_compression)
+{
+    if (compression_string == "none")
+        out_compression = Compression::NONE;
+    else if (compression_string == "zip")
+        out_compression = Compression::ZIP;
+    else if (compression_string == "piz")
+        out_compression = Compression::PIZ;
+    else
+        return false;
+
+    return true;
+}
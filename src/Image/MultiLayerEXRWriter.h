@@ -0,0 +1,102 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef MULTI_LAYER_EXR_WRITER_H
+#define MULTI_LAYER_EXR_WRITER_H
+
+#include "HostDeviceCommon/Color.h"
+
+#include <deque>
+#include <string>
+#include <vector>
+
+/**
+ * Writes several images (beauty, denoised beauty, AOVs, ...) of the same
+ * resolution as the layers of a single OpenEXR file.
+ *
+ * The channels of a layer are named "layer.channel" (denoised.R, normals.X, ...)
+ * as expected by compositing software. The layer with an empty name is the default
+ * layer: its channels are just R, G and B.
+ *
+ * The layers are copied (and de-interleaved) when added so the buffers given to
+ * add_layer() can be modified / freed right after.
+ *
+ * The compression of the file is done by tinyexr, in parallel (OpenMP) over the
+ * blocks of scanlines of the image.
+ */
+class MultiLayerEXRWriter
+{
+public:
+    /**
+     * DWAA isn't available because tinyexr doesn't implement it.
+     * PIZ gives the best ratio on noisy renders, ZIP is faster to decode
+     */
+    enum Compression
+    {
+        NONE,
+        ZIP,
+        PIZ
+    };
+
+    enum PixelType
+    {
+        HALF,
+        FLOAT
+    };
+
+    MultiLayerEXRWriter(int width, int height);
+
+    /**
+     * Adds a layer from 'channel_names.size()' interleaved channels
+     */
+    void add_layer(const std::string& layer_name, const std::vector<std::string>& channel_names, const float* interleaved_data, PixelType pixel_type);
+
+    /**
+     * R, G, B layer. The colors are multiplied by 'scale' (1.0f / sample_count for
+     * a framebuffer that holds the sum of the samples for example)
+     */
+    void add_layer(const std::string& layer_name, const ColorRGB32F* data, PixelType pixel_type, float scale = 1.0f);
+    /**
+     * X, Y, Z layer
+     */
+    void add_layer(const std::string& layer_name, const float3* data, PixelType pixel_type);
+    /**
+     * Single channel 'Y' layer
+     */
+    void add_layer(const std::string& layer_name, const float* data, PixelType pixel_type);
+    /**
+     * Single channel 'Y' layer. Always written as FLOAT because
+     * half floats can't represent integers above 2048 exactly
+     */
+    void add_layer(const std::string& layer_name, const int* data);
+
+    /**
+     * Returns false and logs an error if the file couldn't be written
+     */
+    bool write(const std::string& filepath, Compression compression, bool flipY) const;
+
+    /**
+     * Parses "none", "zip" or "piz" into 'out_compression'.
+     * Returns false if the string isn't one of those
+     */
+    static bool parse_compression(const std::string& compression_string, Compression& out_compression);
+
+private:
+    struct EXRChannel
+    {
+        std::string name;
+        PixelType pixel_type;
+        std::vector<float> data;
+    };
+
+    EXRChannel& add_channel(const std::string& layer_name, const std::string& channel_name, PixelType pixel_type);
+
+    int m_width, m_height;
+
+    // Deque so that the references returned by add_channel() stay valid when adding more channels
+    std::deque<EXRChannel> m_channels;
+};
+
+#endif
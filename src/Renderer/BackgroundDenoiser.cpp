@@ -0,0 +1,166 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#include "Renderer/BackgroundDenoiser.h"
+#include "UI/ImGui/ImGuiLogger.h"
+
+#include <algorithm>
+#include <chrono>
+
+extern ImGuiLogger g_imgui_logger;
+
+BackgroundDenoiser::BackgroundDenoiser(int width, int height, bool use_albedo, bool use_normals) : m_width(width), m_height(height), m_use_albedo(use_albedo), m_use_normals(use_normals)
+{
+    int pixel_count = width * height;
+
+    m_submitted_color.resize(pixel_count);
+    m_pending_color.resize(pixel_count);
+    m_working_color.resize(pixel_count);
+    if (use_albedo)
+    {
+        m_submitted_albedo.resize(pixel_count);
+        m_pending_albedo.resize(pixel_count);
+        m_working_albedo.resize(pixel_count);
+    }
+    if (use_normals)
+    {
+        m_submitted_normals.resize(pixel_count);
+        m_pending_normals.resize(pixel_count);
+        m_working_normals.resize(pixel_count);
+    }
+
+    m_published_denoised = Image32Bit(width, height, 3);
+    m_back_denoised = Image32Bit(width, height, 3);
+
+    // CPU device because the denoiser reads the working
+    // snapshot in host memory directly
+    m_denoiser.initialize(/* force CPU device */ true);
+    m_denoiser.set_use_albedo(use_albedo);
+    m_denoiser.set_use_normals(use_normals);
+    m_denoiser.set_shared_host_buffers(m_working_color.data(), use_normals ? m_working_normals.data() : nullptr, use_albedo ? m_working_albedo.data() : nullptr);
+    m_denoiser.resize(width, height);
+    m_denoiser.finalize();
+
+    m_worker_thread = std::thread(&BackgroundDenoiser::worker_thread_function, this);
+}
+
+BackgroundDenoiser::~BackgroundDenoiser()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        m_stop_worker = true;
+    }
+    m_pending_condition.notify_one();
+
+    if (m_worker_thread.joinable())
+        m_worker_thread.join();
+}
+
+void BackgroundDenoiser::set_denoised_callback(DenoisedCallback callback)
+{
+    std::lock_guard<std::mutex> lock(m_published_mutex);
+
+    m_denoised_callback = callback;
+}
+
+void BackgroundDenoiser::submit_snapshot(const ColorRGB32F* framebuffer, const ColorRGB32F* albedo, const float3* normals, int sample_number)
+{
+    // Copying outside of the lock so that the worker never waits on the copy
+    float inverse_sample_number = 1.0f / hippt::max(1, sample_number);
+#pragma omp parallel for
+    for (int i = 0; i < m_width * m_height; i++)
+        m_submitted_color[i] = framebuffer[i] * inverse_sample_number;
+
+    if (m_use_albedo)
+        std::copy(albedo, albedo + m_width * m_height, m_submitted_albedo.begin());
+    if (m_use_normals)
+        std::copy(normals, normals + m_width * m_height, m_submitted_normals.begin());
+
+    {
+        // Only swapping the buffers under the lock. The pending snapshot that may get
+        // swapped out wasn't picked up by the worker in time, it is overwritten by the next submit
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+
+        std::swap(m_submitted_color, m_pending_color);
+        std::swap(m_submitted_albedo, m_pending_albedo);
+        std::swap(m_submitted_normals, m_pending_normals);
+
+        m_pending_sample_number = sample_number;
+    }
+
+    m_pending_condition.notify_one();
+}
+
+int BackgroundDenoiser::get_latest_denoised(Image32Bit& out_image)
+{
+    std::lock_guard<std::mutex> lock(m_published_mutex);
+
+    if (m_published_sample_number != -1)
+        out_image = m_published_denoised;
+
+    return m_published_sample_number;
+}
+
+void BackgroundDenoiser::flush()
+{
+    std::unique_lock<std::mutex> lock(m_pending_mutex);
+
+    m_idle_condition.wait(lock, [this]() { return m_pending_sample_number == -1 && !m_worker_busy; });
+}
+
+void BackgroundDenoiser::worker_thread_function()
+{
+    while (true)
+    {
+        int sample_number;
+
+        {
+            std::unique_lock<std::mutex> lock(m_pending_mutex);
+            m_pending_condition.wait(lock, [this]() { return m_stop_worker || m_pending_sample_number != -1; });
+
+            if (m_stop_worker)
+                break;
+
+            // Only copying under the lock, the denoising happens without it so that
+            // the renderer can submit a new snapshot while we're denoising this one
+            std::copy(m_pending_color.begin(), m_pending_color.end(), m_working_color.begin());
+            std::copy(m_pending_albedo.begin(), m_pending_albedo.end(), m_working_albedo.begin());
+            std::copy(m_pending_normals.begin(), m_pending_normals.end(), m_working_normals.begin());
+
+            sample_number = m_pending_sample_number;
+            m_pending_sample_number = -1;
+            m_worker_busy = true;
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        m_denoiser.denoise_shared_buffers();
+        m_denoiser.blend_denoised_data(m_working_color.data(), 1.0f, m_back_denoised.get_data_as_ColorRGB32F());
+
+        DenoisedCallback callback;
+        {
+            std::lock_guard<std::mutex> lock(m_published_mutex);
+
+            std::swap(m_published_denoised, m_back_denoised);
+            m_published_sample_number = sample_number;
+
+            callback = m_denoised_callback;
+        }
+
+        auto stop = std::chrono::high_resolution_clock::now();
+        g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_INFO, "Background denoising of sample %d done in %dms", sample_number, static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count()));
+
+        if (callback)
+            // Only the worker thread writes 'm_published_denoised' so
+            // it can be read here without holding the lock
+            callback(m_published_denoised, sample_number);
+
+        {
+            std::lock_guard<std::mutex> lock(m_pending_mutex);
+            m_worker_busy = false;
+        }
+        m_idle_condition.notify_all();
+    }
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef BACKGROUND_DENOISER_H
+#define BACKGROUND_DENOISER_H
+
+#include "HostDeviceCommon/Color.h"
+#include "Image/Image.h"
+#include "Renderer/OpenImageDenoiser.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Denoises snapshots of the framebuffer on its own thread while the renderer keeps rendering.
+ *
+ * The renderer hands a snapshot with submit_snapshot(). This only copies the framebuffer (and
+ * the AOVs), swaps the copy in as the "pending" snapshot and returns: the render threads never
+ * wait on the denoiser.
+ *
+ * The worker thread picks the latest pending snapshot up, denoises it and publishes the result.
+ * If the renderer submits snapshots faster than they can be denoised, the snapshots that weren't
+ * picked up in time are simply replaced by the newer ones.
+ *
+ * The latest denoised image can then be read with get_latest_denoised() (display, early termination
+ * checks, ...) or pushed to a callback as soon as it is available (headless preview files, ...).
+ *
+ * The snapshots are divided by their sample count when copied so the denoised images are averages,
+ * they don't need to be divided by the sample count again.
+ */
+class BackgroundDenoiser
+{
+public:
+    /**
+     * Called on the worker thread after each denoised snapshot.
+     * (denoised_image, sample_number of the snapshot)
+     */
+    using DenoisedCallback = std::function<void(const Image32Bit&, int)>;
+
+    BackgroundDenoiser(int width, int height, bool use_albedo, bool use_normals);
+    ~BackgroundDenoiser();
+
+    void set_denoised_callback(DenoisedCallback callback);
+
+    /**
+     * Copies the given buffers into the pending snapshot and wakes the worker thread up.
+     * Must not be called from several threads at the same time.
+     *
+     * 'framebuffer' is expected to hold the sum of 'sample_number' samples per pixel.
+     * 'albedo' and 'normals' are only read if the denoiser was created with use_albedo / use_normals
+     */
+    void submit_snapshot(const ColorRGB32F* framebuffer, const ColorRGB32F* albedo, const float3* normals, int sample_number);
+
+    /**
+     * Copies the latest denoised image into 'out_image' and returns its sample number.
+     * Returns -1 (and doesn't touch 'out_image') if nothing has been denoised yet
+     */
+    int get_latest_denoised(Image32Bit& out_image);
+
+    /**
+     * Blocks until all the submitted snapshots have been denoised (or replaced by newer ones)
+     */
+    void flush();
+
+private:
+    void worker_thread_function();
+
+    int m_width, m_height;
+    bool m_use_albedo, m_use_normals;
+
+    // The denoiser reads directly from the 'working' buffers below
+    OpenImageDenoiser m_denoiser;
+
+    // Snapshot being copied by submit_snapshot(), outside of the lock. Only
+    // accessed by the submitting thread
+    std::vector<ColorRGB32F> m_submitted_color;
+    std::vector<ColorRGB32F> m_submitted_albedo;
+    std::vector<float3> m_submitted_normals;
+
+    // Latest submitted snapshot, swapped with the one above by submit_snapshot().
+    // Protected by 'm_pending_mutex'
+    std::vector<ColorRGB32F> m_pending_color;
+    std::vector<ColorRGB32F> m_pending_albedo;
+    std::vector<float3> m_pending_normals;
+    // -1 if there is no pending snapshot
+    int m_pending_sample_number = -1;
+
+    // Snapshot being denoised. Only accessed by the worker thread
+    std::vector<ColorRGB32F> m_working_color;
+    std::vector<ColorRGB32F> m_working_albedo;
+    std::vector<float3> m_working_normals;
+
+    // Latest denoised image. Only written by the worker thread, under 'm_published_mutex'
+    Image32Bit m_published_denoised;
+    Image32Bit m_back_denoised;
+    int m_published_sample_number = -1;
+
+    DenoisedCallback m_denoised_callback;
+
+    std::mutex m_pending_mutex;
+    std::mutex m_published_mutex;
+    // Signals the worker that a snapshot is pending or that it should stop
+    std::condition_variable m_pending_condition;
+    // Signals flush() that the worker went idle
+    std::condition_variable m_idle_condition;
+
+    bool m_worker_busy = false;
+    bool m_stop_worker = false;
+    std::thread m_worker_thread;
+};
+
+#endif
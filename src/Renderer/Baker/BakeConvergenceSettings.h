@@ -0,0 +1,44 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef BAKE_CONVERGENCE_SETTINGS_H
+#define BAKE_CONVERGENCE_SETTINGS_H
+
+/**
+ * Settings for the convergence-driven baking of the CPUBaker.
+ * Everything is off by default so that the CPU bakes the same LUTs as the GPUBaker.
+ * 
+ * The samples of a texel are computed in batches. The standard error of the
+ * texel is estimated from the variance of the means of its batches and the texel
+ * stops being refined as soon as that standard error is below 'target_standard_error'.
+ * 
+ * Easy texels thus stop before the 'integration_sample_count' of the bake settings
+ * while the hard texels (grazing angles, low roughnesses, IORs close to 1, ...) are
+ * allowed to go above it, up to 'max_sample_count_multiplier' times.
+ */
+struct BakeConvergenceSettings
+{
+	// If false, every texel is integrated with exactly the
+	// 'integration_sample_count' samples of the bake settings
+	bool use_convergence = false;
+
+	// Absolute standard error under which a texel is considered converged.
+	// The LUTs store values in [0, 1]
+	float target_standard_error = 2.5e-4f;
+
+	// A texel cannot be considered converged before that many batches of samples.
+	// The variance estimate is too unreliable with fewer batches
+	int min_batches = 4;
+
+	// Texels that haven't converged after 'integration_sample_count' samples
+	// keep being refined up to 'integration_sample_count * max_sample_count_multiplier'
+	float max_sample_count_multiplier = 4.0f;
+
+	// If true, a "error_<filename>" LUT with the standard error of each texel is
+	// written next to each baked LUT
+	bool write_error_maps = false;
+};
+
+#endif
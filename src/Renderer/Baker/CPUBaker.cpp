@@ -0,0 +1,74 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#include "Device/kernels/Baking/GGXConductorDirectionalAlbedo.h"
+#include "Device/kernels/Baking/GGXFresnelDirectionalAlbedo.h"
+#include "Device/kernels/Baking/GGXGlassDirectionalAlbedo.h"
+#include "Device/kernels/Baking/GGXThinGlassDirectionalAlbedo.h"
+#include "Device/kernels/Baking/GlossyDielectricDirectionalAlbedo.h"
+
+#include "Renderer/Baker/CPUBaker.h"
+
+CPUBaker::CPUBaker(const BakeConvergenceSettings& convergence_settings) : m_convergence_settings(convergence_settings) {}
+
+void CPUBaker::bake_ggx_conductor_directional_albedo(const GGXConductorDirectionalAlbedoSettings& bake_settings, const std::string& output_filename)
+{
+	CPUBakerKernel kernel([bake_settings](int kernel_iterations, int current_iteration, float* out_buffer, int x, int y, int z) {
+		GGXConductorDirectionalAlbedoBake(kernel_iterations, current_iteration, bake_settings, out_buffer, x, y);
+	}, "GGX conductor directional albedo");
+
+	kernel.bake(make_int3(bake_settings.texture_size_cos_theta, bake_settings.texture_size_roughness, 1), bake_settings.integration_sample_count, output_filename, m_convergence_settings);
+}
+
+void CPUBaker::bake_ggx_fresnel_directional_albedo(const GGXFresnelDirectionalAlbedoSettings& bake_settings, const std::string& output_filename)
+{
+	CPUBakerKernel kernel([bake_settings](int kernel_iterations, int current_iteration, float* out_buffer, int x, int y, int z) {
+		GGXFresnelDirectionalAlbedoBake(kernel_iterations, current_iteration, bake_settings, out_buffer, x, y, z);
+	}, "GGX fresnel directional albedo");
+
+	kernel.bake(make_int3(bake_settings.texture_size_cos_theta, bake_settings.texture_size_roughness, bake_settings.texture_size_ior), bake_settings.integration_sample_count, output_filename, m_convergence_settings);
+}
+
+void CPUBaker::bake_glossy_dielectric_directional_albedo(const GlossyDielectricDirectionalAlbedoSettings& bake_settings, const std::string& output_filename)
+{
+	CPUBakerKernel kernel([bake_settings](int kernel_iterations, int current_iteration, float* out_buffer, int x, int y, int z) {
+		GlossyDielectricDirectionalAlbedoBake(kernel_iterations, current_iteration, bake_settings, out_buffer, x, y, z);
+	}, "dielectric directional albedo");
+
+	kernel.bake(make_int3(bake_settings.texture_size_cos_theta_o, bake_settings.texture_size_roughness, bake_settings.texture_size_ior), bake_settings.integration_sample_count, output_filename, m_convergence_settings);
+}
+
+void CPUBaker::bake_ggx_glass_directional_albedo(const GGXGlassDirectionalAlbedoSettings& bake_settings, const std::string& output_filename)
+{
+	int3 bake_resolution = make_int3(bake_settings.texture_size_cos_theta_o, bake_settings.texture_size_roughness, bake_settings.texture_size_ior);
+
+	CPUBakerKernel entering_kernel([bake_settings](int kernel_iterations, int current_iteration, float* out_buffer, int x, int y, int z) {
+		GGXGlassDirectionalAlbedoBakeEntering(kernel_iterations, current_iteration, bake_settings, out_buffer, x, y, z);
+	}, "GGX glass directional albedo 1/2");
+	entering_kernel.bake(bake_resolution, bake_settings.integration_sample_count, output_filename, m_convergence_settings);
+
+	CPUBakerKernel exiting_kernel([bake_settings](int kernel_iterations, int current_iteration, float* out_buffer, int x, int y, int z) {
+		GGXGlassDirectionalAlbedoBakeExiting(kernel_iterations, current_iteration, bake_settings, out_buffer, x, y, z);
+	}, "GGX glass directional albedo 2/2");
+	exiting_kernel.bake(bake_resolution, bake_settings.integration_sample_count, "inv_" + output_filename, m_convergence_settings);
+}
+
+void CPUBaker::bake_ggx_thin_glass_directional_albedo(const GGXThinGlassDirectionalAlbedoSettings& bake_settings, const std::string& output_filename)
+{
+	CPUBakerKernel kernel([bake_settings](int kernel_iterations, int current_iteration, float* out_buffer, int x, int y, int z) {
+		GGXThinGlassDirectionalAlbedoBake(kernel_iterations, current_iteration, bake_settings, out_buffer, x, y, z);
+	}, "GGX thin glass directional albedo");
+
+	kernel.bake(make_int3(bake_settings.texture_size_cos_theta_o, bake_settings.texture_size_roughness, bake_settings.texture_size_ior), bake_settings.integration_sample_count, output_filename, m_convergence_settings);
+}
+
+void CPUBaker::bake_all_renderer_luts()
+{
+	bake_ggx_conductor_directional_albedo(GGXConductorDirectionalAlbedoSettings(), GPUBakerConstants::get_GGX_conductor_Ess_filename());
+	bake_glossy_dielectric_directional_albedo(GlossyDielectricDirectionalAlbedoSettings(), GPUBakerConstants::get_glossy_dielectric_Ess_filename());
+	// The glass bake writes both the entering (GGX_Glass_Ess_...) and exiting (inv_GGX_Glass_Ess_...) LUTs
+	bake_ggx_glass_directional_albedo(GGXGlassDirectionalAlbedoSettings(), GPUBakerConstants::get_GGX_glass_Ess_filename());
+	bake_ggx_thin_glass_directional_albedo(GGXThinGlassDirectionalAlbedoSettings(), GPUBakerConstants::get_GGX_thin_glass_Ess_filename());
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef CPU_BAKER_H
+#define CPU_BAKER_H
+
+#include "Renderer/Baker/BakeConvergenceSettings.h"
+#include "Renderer/Baker/CPUBakerKernel.h"
+#include "Renderer/Baker/GlossyDielectricDirectionalAlbedoSettings.h"
+#include "Renderer/Baker/GGXConductorDirectionalAlbedoSettings.h"
+#include "Renderer/Baker/GGXFresnelDirectionalAlbedoSettings.h"
+#include "Renderer/Baker/GGXGlassDirectionalAlbedoSettings.h"
+#include "Renderer/Baker/GGXThinGlassDirectionalAlbedoSettings.h"
+
+#include <string>
+
+/**
+ * CPU implementation of the GPUBaker: runs the same bake kernels (Device/kernels/Baking/)
+ * on all the CPU cores and writes the same files.
+ * 
+ * This is for rebuilding the LUTs on machines without a GPU (or in CI). Contrary to the 
+ * GPUBaker, the bake functions here block until the bake is complete.
+ * 
+ * The CPUBaker can also bake progressively if enabled in the BakeConvergenceSettings: texels
+ * are then refined until they reach the error target instead of using a fixed sample count.
+ * An error map (standard error of each texel) can be written next to each LUT.
+ */
+class CPUBaker
+{
+public:
+	CPUBaker(const BakeConvergenceSettings& convergence_settings = BakeConvergenceSettings());
+
+	void bake_ggx_conductor_directional_albedo(const GGXConductorDirectionalAlbedoSettings& bake_settings, const std::string& output_filename);
+	void bake_ggx_fresnel_directional_albedo(const GGXFresnelDirectionalAlbedoSettings& bake_settings, const std::string& output_filename);
+	void bake_glossy_dielectric_directional_albedo(const GlossyDielectricDirectionalAlbedoSettings& bake_settings, const std::string& output_filename);
+	void bake_ggx_glass_directional_albedo(const GGXGlassDirectionalAlbedoSettings& bake_settings, const std::string& output_filename);
+	void bake_ggx_thin_glass_directional_albedo(const GGXThinGlassDirectionalAlbedoSettings& bake_settings, const std::string& output_filename);
+
+	/**
+	 * Bakes all the LUTs used by the renderers with their default settings
+	 * and default filenames, in the current working directory
+	 */
+	void bake_all_renderer_luts();
+
+private:
+	BakeConvergenceSettings m_convergence_settings;
+};
+
+#endif
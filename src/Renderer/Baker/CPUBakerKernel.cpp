@@ -0,0 +1,160 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#include "Image/Image.h"
+#include "Renderer/Baker/CPUBakerKernel.h"
+#include "Renderer/Baker/GPUBakerConstants.h"
+#include "UI/ImGui/ImGuiLogger.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+extern ImGuiLogger g_imgui_logger;
+
+CPUBakerKernel::CPUBakerKernel(KernelFunction kernel_function, const std::string& kernel_title)
+{
+	m_kernel_function = kernel_function;
+	m_kernel_title = kernel_title;
+}
+
+void CPUBakerKernel::bake(int3 bake_resolution, int integration_sample_count, const std::string& output_filename, const BakeConvergenceSettings& convergence_settings)
+{
+	g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_INFO, "%s", ("Launching " + m_kernel_title + " CPU baking...").c_str());
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	int texel_count = bake_resolution.x * bake_resolution.y * bake_resolution.z;
+	std::vector<float> bake_buffer(texel_count, 0.0f);
+	std::vector<float> error_buffer(texel_count, 0.0f);
+
+	// The bake kernels normalize their samples by assuming that they are launched
+	// the same way as the GPUBakerKernel launches them. We're thus splitting the
+	// samples in "kernel launches" exactly the same way here so that the CPU and
+	// the GPU bakers produce the same LUTs.
+	//
+	// Each "kernel launch" of a texel is also one batch of samples for the
+	// convergence estimation
+	int iterations_per_kernel = std::floor(hippt::max(1.0f, (float)GPUBakerConstants::COMPUTE_ELEMENT_PER_BAKE_KERNEL_LAUNCH / texel_count));
+	int nb_kernel_launch = std::ceil(integration_sample_count / (float)iterations_per_kernel);
+
+	int max_nb_batches = nb_kernel_launch;
+	if (convergence_settings.use_convergence)
+		max_nb_batches = hippt::max(nb_kernel_launch, static_cast<int>(std::ceil(nb_kernel_launch * convergence_settings.max_sample_count_multiplier)));
+	int min_nb_batches = hippt::clamp(2, max_nb_batches, convergence_settings.min_batches);
+
+	std::atomic<int> texels_done = 0;
+	std::atomic<long long int> batches_done = 0;
+	std::atomic<int> texels_not_converged = 0;
+
+	// Texels are independent so all the "kernel launches" of a given texel are done
+	// by the same thread, back to back. This keeps the texel in the cache of the core.
+	// Texels near grazing angles / low roughnesses take longer to integrate than the
+	// others (and need more batches to converge) so the work is distributed dynamically
+#pragma omp parallel for schedule(dynamic, 16)
+	for (int texel_index = 0; texel_index < texel_count; texel_index++)
+	{
+		int x = texel_index % bake_resolution.x;
+		int y = (texel_index / bake_resolution.x) % bake_resolution.y;
+		int z = texel_index / (bake_resolution.x * bake_resolution.y);
+
+		// Running mean and sum of squared deviations (Welford) of the batch estimates
+		double batch_mean = 0.0;
+		double batch_M2 = 0.0;
+		double standard_error = 0.0;
+
+		int batch_index = 0;
+		for (; batch_index < max_nb_batches; batch_index++)
+		{
+			// The kernel accumulates 'batch_sum / (nb_kernel_launch * iterations_per_kernel)'
+			// in the buffer. With a fixed sample count, the batches accumulate in the buffer
+			// exactly as on the GPU so that the LUT is the same. With the convergence, the
+			// number of batches isn't known in advance so every batch starts from 0 and
+			// the batches are averaged instead
+			if (convergence_settings.use_convergence)
+				bake_buffer[texel_index] = 0.0f;
+			float accumulated_before_batch = bake_buffer[texel_index];
+
+			// Same 'current_iteration' as on the GPU for the same random numbers.
+			// Batches past 'nb_kernel_launch' keep going with new random numbers
+			m_kernel_function(iterations_per_kernel, batch_index + 1, bake_buffer.data(), x, y, z);
+
+			// Estimate of the texel with this batch only
+			double batch_estimate = static_cast<double>(bake_buffer[texel_index] - accumulated_before_batch) * nb_kernel_launch;
+
+			double delta = batch_estimate - batch_mean;
+			batch_mean += delta / (batch_index + 1);
+			batch_M2 += delta * (batch_estimate - batch_mean);
+
+			int nb_batches = batch_index + 1;
+			if (nb_batches >= 2)
+				standard_error = std::sqrt(batch_M2 / (nb_batches - 1) / nb_batches);
+
+			if (!convergence_settings.use_convergence)
+				// Fixed sample count, the convergence doesn't matter
+				continue;
+
+			if (nb_batches >= min_nb_batches && standard_error <= convergence_settings.target_standard_error)
+			{
+				batch_index++;
+				break;
+			}
+		}
+
+		if (convergence_settings.use_convergence)
+		{
+			if (standard_error > convergence_settings.target_standard_error)
+				texels_not_converged++;
+
+			bake_buffer[texel_index] = static_cast<float>(batch_mean);
+		}
+		error_buffer[texel_index] = static_cast<float>(standard_error);
+		batches_done += batch_index;
+
+		// Logging the progress every 10%. Only one thread crosses each 10% step
+		int done = ++texels_done;
+		if (done * 10 / texel_count != (done - 1) * 10 / texel_count)
+			g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_INFO, "%s", (m_kernel_title + ": " + std::to_string(done * 100 / texel_count) + "%").c_str());
+	}
+
+	auto stop = std::chrono::high_resolution_clock::now();
+	float bake_duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count();
+	std::string unit_suffix = bake_duration < 1000.0f ? "ms!" : "s!";
+	bake_duration = bake_duration > 1000.0f ? bake_duration / 1000.0f : bake_duration;
+	g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_INFO, "%s", (m_kernel_title + " completed in " + std::to_string(bake_duration) + unit_suffix).c_str());
+
+	if (convergence_settings.use_convergence)
+	{
+		float average_samples = static_cast<float>(batches_done.load()) * iterations_per_kernel / texel_count;
+		g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_INFO, "%s: %.0f samples per texel on average (fixed count: %d), %d/%d texels above the target error.",
+			m_kernel_title.c_str(), average_samples, nb_kernel_launch * iterations_per_kernel, texels_not_converged.load(), texel_count);
+	}
+
+	write_lut(bake_buffer, bake_resolution, output_filename);
+	if (convergence_settings.write_error_maps)
+		write_lut(error_buffer, bake_resolution, "error_" + output_filename);
+}
+
+void CPUBakerKernel::write_lut(const std::vector<float>& lut_data, int3 bake_resolution, const std::string& output_filename)
+{
+	if (bake_resolution.z > 1)
+	{
+		// 3D texture
+		for (int i = 0; i < bake_resolution.z; i++)
+		{
+			Image32Bit image = Image32Bit(lut_data.data() + i * bake_resolution.x * bake_resolution.y, bake_resolution.x, bake_resolution.y, /* nb channels */ 1);
+
+			std::string final_filename = std::to_string(i) + output_filename;
+			image.write_image_hdr(final_filename.c_str(), false);
+		}
+	}
+	else
+	{
+		// A single 2D image
+		Image32Bit image = Image32Bit(lut_data, bake_resolution.x, bake_resolution.y, 1);
+		image.write_image_hdr(output_filename.c_str(), false);
+	}
+}
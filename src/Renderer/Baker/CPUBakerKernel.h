@@ -0,0 +1,57 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef CPU_BAKER_KERNEL_H
+#define CPU_BAKER_KERNEL_H
+
+#include "HostDeviceCommon/Math.h"
+#include "Renderer/Baker/BakeConvergenceSettings.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * CPU counterpart of GPUBakerKernel: runs one of the bake kernels of
+ * Device/kernels/Baking/ on all the texels of the LUT, on all the CPU cores
+ */
+class CPUBakerKernel
+{
+public:
+	/**
+	 * Signature of the CPU version of the bake kernels, bound to their bake settings.
+	 * (kernel_iterations, current_iteration, out_buffer, x, y, z)
+	 */
+	using KernelFunction = std::function<void(int, int, float*, int, int, int)>;
+
+	CPUBakerKernel() {}
+	CPUBakerKernel(KernelFunction kernel_function, const std::string& kernel_title);
+
+	/**
+	 * Bakes the LUT and writes it to disk. Blocks until the bake is complete.
+	 * 
+	 * The output files are the same as the ones written by the GPUBakerKernel.
+	 * 
+	 * If 'convergence_settings.use_convergence' is true, each texel is refined
+	 * until its standard error goes below the target of the convergence settings
+	 * instead of always using 'integration_sample_count' samples.
+	 * See BakeConvergenceSettings
+	 */
+	void bake(int3 bake_resolution, int integration_sample_count, const std::string& output_filename, const BakeConvergenceSettings& convergence_settings = BakeConvergenceSettings());
+
+private:
+	/**
+	 * Writes the given LUT data to disk. 3D LUTs are written as one
+	 * file per slice, prefixed with the index of the slice
+	 */
+	void write_lut(const std::vector<float>& lut_data, int3 bake_resolution, const std::string& output_filename);
+
+	KernelFunction m_kernel_function;
+
+	// String used for logging infos
+	std::string m_kernel_title = "";
+};
+
+#endif
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#include "Renderer/BatchRenderJob.h"
+#include "Scene/CameraAnimation.h"
+#include "UI/ImGui/ImGuiLogger.h"
+
+#include <fstream>
+#include <sstream>
+
+extern ImGuiLogger g_imgui_logger;
+
+/**
+ * Reads the optional "keyword value" pairs at the end of a 'view' or 'turntable' line.
+ * Returns false if an unknown keyword is found
+ */
+static bool parse_view_options(std::istringstream& line_stream, BatchRenderView& view, float3* center)
+{
+    std::string keyword;
+    while (line_stream >> keyword)
+    {
+        if (keyword == "samples")
+            line_stream >> view.samples;
+        else if (keyword == "bounces")
+            line_stream >> view.bounces;
+        else if (keyword == "fov")
+        {
+            float fov_degrees;
+            line_stream >> fov_degrees;
+
+            view.camera.set_FOV(fov_degrees / 180.0f * M_PI);
+        }
+        else if (keyword == "center" && center != nullptr)
+            line_stream >> center->x >> center->y >> center->z;
+        else
+            return false;
+
+        if (line_stream.fail())
+            return false;
+    }
+
+    return true;
+}
+
+BatchRenderJob::BatchRenderJob()
+{
+    m_animation_state.reset();
+    m_animation_state.is_rendering_frame_sequence = true;
+}
+
+bool BatchRenderJob::load_from_file(const std::string& job_filepath, const Camera& scene_camera, const float3& scene_center, BatchRenderJob& out_job)
+{
+    std::ifstream job_file(job_filepath);
+    if (!job_file.is_open())
+    {
+        g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "Could not open the batch job file %s", job_filepath.c_str());
+
+        return false;
+    }
+
+    out_job = BatchRenderJob();
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(job_file, line))
+    {
+        line_number++;
+
+        // Stripping the comments
+        std::size_t comment_start = line.find('#');
+        if (comment_start != std::string::npos)
+            line = line.substr(0, comment_start);
+
+        std::istringstream line_stream(line);
+        std::string statement;
+        if (!(line_stream >> statement))
+            // Empty line
+            continue;
+
+        bool line_valid = true;
+        if (statement == "output_folder")
+            line_valid = static_cast<bool>(line_stream >> out_job.m_animation_state.frames_output_folder);
+        else if (statement == "view")
+        {
+            BatchRenderView view;
+            view.camera = scene_camera;
+
+            glm::vec3 position, target;
+            line_valid = static_cast<bool>(line_stream >> view.name >> position.x >> position.y >> position.z >> target.x >> target.y >> target.z);
+            if (line_valid)
+            {
+                view.camera.look_at(position, target);
+                line_valid = parse_view_options(line_stream, view, nullptr);
+            }
+
+            if (line_valid)
+                out_job.add_view(view);
+        }
+        else if (statement == "turntable")
+        {
+            BatchRenderView options;
+            options.camera = scene_camera;
+
+            int view_count;
+            float3 center = scene_center;
+            line_valid = static_cast<bool>(line_stream >> view_count) && view_count > 0;
+            if (line_valid)
+                line_valid = parse_view_options(line_stream, options, &center);
+
+            if (line_valid)
+                out_job.add_turntable_views(options.camera, view_count, center, options.samples, options.bounces);
+        }
+        else
+            line_valid = false;
+
+        if (!line_valid)
+            g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_WARNING, "Invalid statement at line %d of the batch job file %s, ignored: %s", line_number, job_filepath.c_str(), line.c_str());
+    }
+
+    if (out_job.m_views.empty())
+    {
+        g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "The batch job file %s doesn't contain any view", job_filepath.c_str());
+
+        return false;
+    }
+
+    return true;
+}
+
+void BatchRenderJob::add_turntable_views(const Camera& start_camera, int view_count, const float3& center, int samples, int bounces)
+{
+    // Numbering the views of the turntable after the views already in the job
+    // so that two turntables of the same job don't overwrite each other
+    int first_view_index = m_views.size();
+
+    Camera camera = start_camera;
+
+    CameraAnimation turntable_animation;
+    turntable_animation.set_camera(&camera);
+    turntable_animation.m_rotate_around_point = glm::vec3(center.x, center.y, center.z);
+
+    for (int i = 0; i < view_count; i++)
+    {
+        BatchRenderView view;
+        view.name = "turntable_" + std::to_string(first_view_index + i);
+        view.camera = camera;
+        view.samples = samples;
+        view.bounces = bounces;
+
+        add_view(view);
+
+        turntable_animation.rotation_step(360.0f / view_count);
+    }
+}
+
+void BatchRenderJob::add_view(const BatchRenderView& view)
+{
+    m_views.push_back(view);
+
+    m_animation_state.number_of_animation_frames = m_views.size();
+}
+
+const std::vector<BatchRenderView>& BatchRenderJob::get_views() const
+{
+    return m_views;
+}
+
+RendererAnimationState& BatchRenderJob::get_animation_state()
+{
+    return m_animation_state;
+}
+
+std::string BatchRenderJob::get_view_filepath(const std::string& suffix)
+{
+    return m_animation_state.frames_output_folder + "/" + m_views[m_animation_state.frames_rendered_so_far].name + suffix;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef BATCH_RENDER_JOB_H
+#define BATCH_RENDER_JOB_H
+
+#include "Renderer/RendererAnimationState.h"
+#include "Scene/Camera.h"
+
+#include <string>
+#include <vector>
+
+struct BatchRenderView
+{
+    // Used for the names of the files written for this view
+    std::string name;
+    Camera camera;
+
+    // -1 to use the value of the commandline
+    int samples = -1;
+    int bounces = -1;
+};
+
+/**
+ * A list of views of the same scene rendered one after the other by the same
+ * renderer: the scene, its textures and its BVH are only loaded / built once
+ * for the whole batch.
+ *
+ * A job file is a text file with one statement per line ('#' starts a comment):
+ *
+ *      output_folder <folder>
+ *      view <name> <position x y z> <target x y z> [fov <vertical fov degrees>] [samples <N>] [bounces <N>]
+ *      turntable <view count> [center <x y z>] [samples <N>] [bounces <N>]
+ *
+ * 'turntable' adds 'view count' views that rotate the camera of the scene file around
+ * 'center' (the center of the scene if not given), evenly spaced over 360 degrees
+ */
+class BatchRenderJob
+{
+public:
+    /**
+     * The output folder defaults to a "FrameSeq - <date>" folder
+     */
+    BatchRenderJob();
+
+    /**
+     * 'scene_camera' is the camera of the scene file. The views of the job
+     * are copies of this camera (same aspect ratio, clip planes, FOV, ...)
+     * that are moved around.
+     *
+     * Returns false and logs an error if the file couldn't be read
+     */
+    static bool load_from_file(const std::string& job_filepath, const Camera& scene_camera, const float3& scene_center, BatchRenderJob& out_job);
+
+    /**
+     * Adds 'view_count' views rotating 'start_camera' around 'center'.
+     * The first view is 'start_camera' itself
+     */
+    void add_turntable_views(const Camera& start_camera, int view_count, const float3& center, int samples = -1, int bounces = -1);
+    void add_view(const BatchRenderView& view);
+
+    const std::vector<BatchRenderView>& get_views() const;
+
+    /**
+     * The output folder and the progress through the views of the job
+     * ('frames_rendered_so_far' / 'number_of_animation_frames')
+     */
+    RendererAnimationState& get_animation_state();
+
+    /**
+     * Path of an image of the view currently rendered, i.e. the view at
+     * index 'get_animation_state().frames_rendered_so_far'.
+     * 'suffix' is appended to the name of the view: "_denoised_1.png" for example
+     */
+    std::string get_view_filepath(const std::string& suffix);
+
+private:
+    std::vector<BatchRenderView> m_views;
+
+    RendererAnimationState m_animation_state;
+};
+
+#endif
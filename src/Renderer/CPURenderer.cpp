@@ -5,11 +5,15 @@
 
 #include "Device/kernels/CameraRays.h"
 #include "Device/kernels/FullPathTracer.h"
+#include "Device/kernels/LowResolutionUpsampling.h"
 #include "Device/kernels/ReSTIR/DI/LightsPresampling.h"
 #include "Device/kernels/ReSTIR/DI/InitialCandidates.h"
 #include "Device/kernels/ReSTIR/DI/TemporalReuse.h"
 #include "Device/kernels/ReSTIR/DI/SpatialReuse.h"
 #include "Device/kernels/ReSTIR/DI/FusedSpatiotemporalReuse.h"
+#include "Device/kernels/TemporalAccumulation.h"
+#include "Device/kernels/TileConvergence.h"
+#include "Device/kernels/Utils/UnpackDenoiserAOVs.h"
 
 #include "Renderer/Baker/GPUBaker.h"
 #include "Renderer/Baker/GPUBakerConstants.h"
@@ -17,10 +21,16 @@
 #include "Threads/ThreadManager.h"
 #include "UI/ApplicationSettings.h"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <omp.h>
 
+#if EMBED_BRDFS_LUTS
+// Generated at build time from the .hdr files of data/BRDFsData by cmake/SetupEmbeddedBRDFsLUTs.cmake
+#include "EmbeddedBRDFsLUTs.h"
+#endif
+
  // If 1, only the pixel at DEBUG_PIXEL_X and DEBUG_PIXEL_Y will be rendered,
  // allowing for fast step into that pixel with the debugger to see what's happening.
  // Otherwise if 0, all pixels of the image are rendered
@@ -65,14 +75,12 @@
 // DEBUG_PIXEL_Y coordinates
 #define DEBUG_NEIGHBORHOOD_SIZE 20
 
-CPURenderer::CPURenderer(int width, int height) : m_resolution(make_int2(width, height))
+CPURenderer::CPURenderer(int width, int height) : m_resolution(make_int2(width, height)), m_render_grid_resolution(make_int2(width, height))
 {
     m_framebuffer = Image32Bit(width, height, 3);
 
     // Resizing buffers + initial value
     m_pixel_active_buffer.resize(width * height, 0);
-    m_denoiser_albedo.resize(width * height, ColorRGB32F(0.0f));
-    m_denoiser_normals.resize(width * height, float3{ 0.0f, 0.0f, 0.0f });
     m_pixel_sample_count.resize(width * height, 0);
     m_pixel_converged_sample_count.resize(width * height, 0);
     m_pixel_squared_luminance.resize(width * height, 0.0f);
@@ -92,8 +100,14 @@ CPURenderer::CPURenderer(int width, int height) : m_resolution(make_int2(width,
 
 void CPURenderer::setup_brdfs_data()
 {
-    m_sheen_ltc_params = Image32Bit(reinterpret_cast<float*>(ltc_parameters_table_approximation.data()), 32, 32, 3);
-    m_GGX_conductor_Ess = Image32Bit::read_image_hdr("../data/BRDFsData/GGX/" + GPUBakerConstants::get_GGX_conductor_Ess_filename(), 1, true);
+    // The small LUTs are sampled in place, no copy
+    m_sheen_ltc_params = Image32BitView(reinterpret_cast<const float*>(ltc_parameters_table_approximation.data()), 32, 32, 3);
+#if EMBED_BRDFS_LUTS
+    m_GGX_conductor_Ess = Image32BitView(GGX_conductor_Ess_embedded, GGX_conductor_Ess_embedded_width, GGX_conductor_Ess_embedded_height, 1);
+#else
+    m_GGX_conductor_Ess_image = Image32Bit::read_image_hdr("../data/BRDFsData/GGX/" + GPUBakerConstants::get_GGX_conductor_Ess_filename(), 1, true);
+    m_GGX_conductor_Ess = Image32BitView(m_GGX_conductor_Ess_image.data().data(), m_GGX_conductor_Ess_image.width, m_GGX_conductor_Ess_image.height, m_GGX_conductor_Ess_image.channels);
+#endif
 
     std::vector<Image32Bit> images(GPUBakerConstants::GLOSSY_DIELECTRIC_TEXTURE_SIZE_IOR);
     for (int i = 0; i < GPUBakerConstants::GLOSSY_DIELECTRIC_TEXTURE_SIZE_IOR; i++)
@@ -135,7 +149,11 @@ void CPURenderer::set_scene(Scene& parsed_scene)
 {
     m_render_data.geom = nullptr;
 
-    m_render_data.buffers.materials_buffer = parsed_scene.materials.data();
+    // The packing of the scalar textures remaps the texture indices of the materials
+    ThreadManager::join_threads(ThreadManager::SCENE_TEXTURES_LOADING_THREAD_KEY);
+    ThreadManager::join_threads(ThreadManager::SCENE_TEXTURES_PACKING_THREAD_KEY);
+    m_materials.pack(parsed_scene.materials);
+    m_render_data.buffers.materials_buffer = m_materials.get_data();
     m_render_data.buffers.material_indices = parsed_scene.material_indices.data();
     m_render_data.buffers.has_vertex_normals = parsed_scene.has_vertex_normals.data();
     m_render_data.buffers.pixels = m_framebuffer.get_data_as_ColorRGB32F();
@@ -151,18 +169,17 @@ void CPURenderer::set_scene(Scene& parsed_scene)
     m_render_data.bsdfs_data.GGX_Ess_glass_inverse = &m_GGX_Ess_glass_inverse;
     m_render_data.bsdfs_data.GGX_Ess_thin_glass = &m_GGX_Ess_thin_glass;
 
-    ThreadManager::join_threads(ThreadManager::SCENE_TEXTURES_LOADING_THREAD_KEY);
     m_render_data.buffers.material_textures = parsed_scene.textures.data();
     m_render_data.buffers.textures_dims = parsed_scene.textures_dims.data();
 
     m_render_data.aux_buffers.pixel_active = m_pixel_active_buffer.data();
-    m_render_data.aux_buffers.denoiser_albedo = m_denoiser_albedo.data();
-    m_render_data.aux_buffers.denoiser_normals = m_denoiser_normals.data();
     m_render_data.aux_buffers.pixel_sample_count = m_pixel_sample_count.data();
     m_render_data.aux_buffers.pixel_converged_sample_count = m_pixel_converged_sample_count.data();
     m_render_data.aux_buffers.pixel_squared_luminance = m_pixel_squared_luminance.data();
+    m_render_data.aux_buffers.adaptive_sampling_error_sums = m_adaptive_sampling_error_sums;
     m_render_data.aux_buffers.still_one_ray_active = &m_still_one_ray_active;
     m_render_data.aux_buffers.stop_noise_threshold_converged_count = &m_stop_noise_threshold_count;
+    m_render_data.aux_buffers.converged_tile_count = &m_converged_tile_count;
 
     m_render_data.g_buffer.materials = m_g_buffer.materials.data();
     m_render_data.g_buffer.geometric_normals = m_g_buffer.geometric_normals.data();
@@ -192,6 +209,7 @@ void CPURenderer::set_scene(Scene& parsed_scene)
     ThreadManager::join_threads(ThreadManager::SCENE_LOADING_PARSE_EMISSIVE_TRIANGLES);
     m_render_data.buffers.emissive_triangles_count = parsed_scene.emissive_triangle_indices.size();
     m_render_data.buffers.emissive_triangles_indices = parsed_scene.emissive_triangle_indices.data();
+    m_render_data.buffers.emissive_irradiance_estimate = parsed_scene.compute_emissive_irradiance_estimate();
 
     std::cout << "Building scene BVH..." << std::endl;
     m_triangle_buffer = parsed_scene.get_triangles();
@@ -222,7 +240,7 @@ void CPURenderer::set_envmap(Image32Bit& envmap_image)
     {
         float total_sum;
 
-        envmap_image.compute_alias_table(m_alias_table_probas, m_alias_table_alias, &total_sum);
+        envmap_image.compute_alias_table(m_alias_table, &total_sum);
         m_render_data.world_settings.envmap_total_sum = total_sum;
     }
 
@@ -234,16 +252,15 @@ void CPURenderer::set_envmap(Image32Bit& envmap_image)
     if (EnvmapSamplingStrategy == ESS_BINARY_SEARCH)
         m_render_data.world_settings.envmap_cdf = m_envmap_cdf.data();
     else if (EnvmapSamplingStrategy == ESS_ALIAS_TABLE)
-    {
-        m_render_data.world_settings.alias_table_probas = m_alias_table_probas.data();
-        m_render_data.world_settings.alias_table_alias = m_alias_table_alias.data();
-    }
+        m_render_data.world_settings.alias_table = m_alias_table.data();
 }
 
 void CPURenderer::set_camera(Camera& camera)
 {
+    // Not touching 'm_render_data.current_camera' here, it becomes the previous
+    // camera of the next frame, the one the temporal reprojection reprojects from
     m_camera = camera;
-    m_render_data.current_camera = camera.to_hiprt();
+    m_camera_moved = true;
 }
 
 HIPRTRenderData& CPURenderer::get_render_data()
@@ -261,11 +278,217 @@ Image32Bit& CPURenderer::get_framebuffer()
     return m_framebuffer;
 }
 
+std::vector<ColorRGB32F>& CPURenderer::get_denoiser_albedo_AOV_buffer()
+{
+    unpack_denoiser_AOVs();
+
+    return m_denoiser_albedo;
+}
+
+std::vector<float3>& CPURenderer::get_denoiser_normals_AOV_buffer()
+{
+    unpack_denoiser_AOVs();
+
+    return m_denoiser_normals;
+}
+
+void CPURenderer::unpack_denoiser_AOVs()
+{
+    if (m_render_data.aux_buffers.packed_denoiser_albedo == nullptr)
+        return;
+
+    // Only allocated for the unpacking when the AOVs are compact,
+    // freed by update_compact_AOV_buffers() at the next render()
+    m_denoiser_albedo.resize(m_resolution.x * m_resolution.y);
+    m_denoiser_normals.resize(m_resolution.x * m_resolution.y);
+    m_render_data.aux_buffers.denoiser_albedo = m_denoiser_albedo.data();
+    m_render_data.aux_buffers.denoiser_normals = m_denoiser_normals.data();
+
+#pragma omp parallel for
+    for (int y = 0; y < m_resolution.y; y++)
+        for (int x = 0; x < m_resolution.x; x++)
+            UnpackDenoiserAOVs(m_render_data, m_resolution, x, y);
+
+    m_render_data.aux_buffers.denoiser_albedo = nullptr;
+    m_render_data.aux_buffers.denoiser_normals = nullptr;
+}
+
+void CPURenderer::update_adaptive_sampling_buffers()
+{
+    if (m_render_data.render_settings.has_access_to_adaptive_sampling_buffers())
+    {
+        m_pixel_color_sum.resize(m_resolution.x * m_resolution.y, ColorRGB32F(0.0f));
+        m_pixel_odd_color_sum.resize(m_resolution.x * m_resolution.y, ColorRGB32F(0.0f));
+    }
+    else
+    {
+        m_pixel_color_sum.clear();
+        m_pixel_color_sum.shrink_to_fit();
+        m_pixel_odd_color_sum.clear();
+        m_pixel_odd_color_sum.shrink_to_fit();
+    }
+
+    m_render_data.aux_buffers.pixel_color_sum = m_pixel_color_sum.data();
+    m_render_data.aux_buffers.pixel_odd_color_sum = m_pixel_odd_color_sum.data();
+}
+
+void CPURenderer::update_material_filter_buffer()
+{
+    if (m_render_data.render_settings.use_partial_material_reset)
+        m_pixel_material_filter.resize(m_resolution.x * m_resolution.y, 0);
+    else
+    {
+        m_pixel_material_filter.clear();
+        m_pixel_material_filter.shrink_to_fit();
+    }
+
+    m_render_data.aux_buffers.pixel_material_filter = m_pixel_material_filter.data();
+}
+
+void CPURenderer::update_tile_convergence_buffers()
+{
+    // The size of the tiles may have changed since the last render
+    int2 tile_count = m_render_data.render_settings.get_convergence_tile_count(m_resolution);
+    if (m_tile_converged.size() != static_cast<size_t>(tile_count.x * tile_count.y))
+    {
+        m_tile_converged.assign(tile_count.x * tile_count.y, 0);
+
+        // The tiles are evaluated again from the first sample
+        m_render_data.render_settings.sample_number = 0;
+        m_render_data.render_settings.need_to_reset = true;
+    }
+
+    m_render_data.aux_buffers.tile_converged = m_tile_converged.data();
+}
+
+void CPURenderer::update_temporal_accumulation_buffers()
+{
+    TemporalAccumulationSettings& temporal_accumulation = m_render_data.render_settings.temporal_accumulation;
+
+    if (temporal_accumulation.do_temporal_reprojection)
+    {
+        if (m_temporal_history_1.empty())
+        {
+            // Zero length histories, the first frame starts from its own sample
+            m_temporal_history_1.resize(m_resolution.x * m_resolution.y, ColorRGB32F(0.0f));
+            m_temporal_history_2.resize(m_resolution.x * m_resolution.y, ColorRGB32F(0.0f));
+            m_temporal_history_length_1.resize(m_resolution.x * m_resolution.y, 0);
+            m_temporal_history_length_2.resize(m_resolution.x * m_resolution.y, 0);
+
+            temporal_accumulation.history = m_temporal_history_1.data();
+            temporal_accumulation.prev_history = m_temporal_history_2.data();
+            temporal_accumulation.history_length = m_temporal_history_length_1.data();
+            temporal_accumulation.prev_history_length = m_temporal_history_length_2.data();
+
+            // The framebuffer doesn't have a history to start from yet
+            m_render_data.render_settings.sample_number = 0;
+            m_render_data.render_settings.need_to_reset = true;
+        }
+    }
+    else
+    {
+        m_temporal_history_1.clear();
+        m_temporal_history_1.shrink_to_fit();
+        m_temporal_history_2.clear();
+        m_temporal_history_2.shrink_to_fit();
+        m_temporal_history_length_1.clear();
+        m_temporal_history_length_1.shrink_to_fit();
+        m_temporal_history_length_2.clear();
+        m_temporal_history_length_2.shrink_to_fit();
+
+        temporal_accumulation.history = nullptr;
+        temporal_accumulation.prev_history = nullptr;
+        temporal_accumulation.history_length = nullptr;
+        temporal_accumulation.prev_history_length = nullptr;
+    }
+}
+
+void CPURenderer::update_compact_AOV_buffers()
+{
+    if (m_render_data.render_settings.use_compact_AOVs)
+    {
+        m_packed_denoiser_albedo.resize(m_resolution.x * m_resolution.y, 0);
+        m_packed_denoiser_normals.resize(m_resolution.x * m_resolution.y, 0);
+
+        m_render_data.aux_buffers.packed_denoiser_albedo = m_packed_denoiser_albedo.data();
+        m_render_data.aux_buffers.packed_denoiser_normals = m_packed_denoiser_normals.data();
+
+        // The path tracer accumulates in the packed buffers only. The full
+        // precision buffers are allocated by unpack_denoiser_AOVs() when needed
+        m_denoiser_albedo.clear();
+        m_denoiser_albedo.shrink_to_fit();
+        m_denoiser_normals.clear();
+        m_denoiser_normals.shrink_to_fit();
+
+        m_render_data.aux_buffers.denoiser_albedo = nullptr;
+        m_render_data.aux_buffers.denoiser_normals = nullptr;
+    }
+    else
+    {
+        m_packed_denoiser_albedo.clear();
+        m_packed_denoiser_albedo.shrink_to_fit();
+        m_packed_denoiser_normals.clear();
+        m_packed_denoiser_normals.shrink_to_fit();
+
+        m_render_data.aux_buffers.packed_denoiser_albedo = nullptr;
+        m_render_data.aux_buffers.packed_denoiser_normals = nullptr;
+
+        m_denoiser_albedo.resize(m_resolution.x * m_resolution.y, ColorRGB32F(0.0f));
+        m_denoiser_normals.resize(m_resolution.x * m_resolution.y, float3{ 0.0f, 0.0f, 0.0f });
+
+        m_render_data.aux_buffers.denoiser_albedo = m_denoiser_albedo.data();
+        m_render_data.aux_buffers.denoiser_normals = m_denoiser_normals.data();
+    }
+}
+
+std::vector<int>& CPURenderer::get_pixel_sample_count_buffer()
+{
+    return m_pixel_sample_count;
+}
+
+std::vector<int>& CPURenderer::get_pixel_converged_sample_count_buffer()
+{
+    return m_pixel_converged_sample_count;
+}
+
+std::vector<float> CPURenderer::compute_pixel_noise_map()
+{
+    if (!m_render_data.render_settings.has_access_to_adaptive_sampling_buffers())
+        return std::vector<float>();
+
+    std::vector<float> noise_map(m_resolution.x * m_resolution.y);
+
+#pragma omp parallel for
+    for (int pixel_index = 0; pixel_index < m_resolution.x * m_resolution.y; pixel_index++)
+    {
+        float average_luminance;
+        float confidence_interval = get_pixel_confidence_interval(m_render_data, pixel_index, m_pixel_sample_count[pixel_index], average_luminance);
+
+        noise_map[pixel_index] = average_luminance > 0.0f ? confidence_interval / average_luminance : 0.0f;
+    }
+
+    return noise_map;
+}
+
+void CPURenderer::set_background_denoiser(std::shared_ptr<BackgroundDenoiser> background_denoiser, int every_n_samples, float every_n_seconds)
+{
+    m_background_denoiser = background_denoiser;
+    m_background_denoise_every_n_samples = every_n_samples;
+    m_background_denoise_every_n_seconds = every_n_seconds;
+}
+
 void CPURenderer::render()  
 {
     std::cout << "CPU rendering..." << std::endl;
 
     auto start = std::chrono::high_resolution_clock::now();
+    auto last_background_denoise = start;
+
+    update_compact_AOV_buffers();
+    update_adaptive_sampling_buffers();
+    update_material_filter_buffer();
+    update_temporal_accumulation_buffers();
+    update_tile_convergence_buffers();
 
     // Using 'samples_per_frame' as the number of samples to render on the CPU
     for (int frame_number = 1; frame_number <= m_render_data.render_settings.samples_per_frame; frame_number++)
@@ -275,33 +498,129 @@ void CPURenderer::render()
         update(frame_number);
         update_render_data(frame_number);
 
+        if (m_render_data.render_settings.do_render_low_resolution())
+            // The render passes write in the compact framebuffer of the
+            // low resolution grid, upsampled at the end of the frame
+            m_render_data.buffers.pixels = m_low_resolution_framebuffer.data();
+
         camera_rays_pass();
 #if DirectLightSamplingStrategy == LSS_RESTIR_DI
         ReSTIR_DI();
 #endif
         tracing_pass();
+        if (m_render_data.render_settings.temporal_accumulation.do_temporal_reprojection && m_render_data.render_settings.accumulate)
+            temporal_accumulation_pass();
+        if (m_render_data.render_settings.use_tile_convergence && m_render_data.render_settings.has_access_to_adaptive_sampling_buffers())
+            tile_convergence_pass();
+        if (m_render_data.render_settings.do_render_low_resolution())
+        {
+            m_render_data.buffers.pixels = m_framebuffer.get_data_as_ColorRGB32F();
+            low_resolution_upsampling_pass();
+        }
 
         if (m_render_data.render_settings.accumulate)
+        {
             m_render_data.render_settings.sample_number++;
+            m_render_data.render_settings.denoiser_AOV_accumulation_counter++;
+        }
         m_render_data.random_seed = m_rng.xorshift32();
         m_render_data.render_settings.need_to_reset = false;
+        // The temporal buffers, if a clear was requested, have been cleared by this sample
+        m_render_data.render_settings.restir_di_settings.temporal_pass.temporal_buffer_clear_requested = false;
         // We want the G Buffer of the frame that we just rendered to go in the "g_buffer_prev_frame"
         // and then we can re-use the old buffers of to be filled by the current frame render
 
         std::cout << "Frame " << frame_number << ": " << frame_number/ static_cast<float>(m_render_data.render_settings.samples_per_frame) * 100.0f << "%" << std::endl;
+
+        if (m_background_denoiser != nullptr)
+        {
+            auto now = std::chrono::high_resolution_clock::now();
+            float seconds_since_last_denoise = std::chrono::duration<float>(now - last_background_denoise).count();
+
+            bool samples_trigger = m_background_denoise_every_n_samples > 0 && frame_number % m_background_denoise_every_n_samples == 0;
+            bool seconds_trigger = m_background_denoise_every_n_seconds > 0.0f && seconds_since_last_denoise >= m_background_denoise_every_n_seconds;
+            if (samples_trigger || seconds_trigger)
+            {
+                // Only copies the buffers, the denoising happens on the thread of the background denoiser
+                m_background_denoiser->submit_snapshot(m_framebuffer.get_data_as_ColorRGB32F(), get_denoiser_albedo_AOV_buffer().data(), get_denoiser_normals_AOV_buffer().data(), m_render_data.render_settings.sample_number);
+
+                last_background_denoise = now;
+            }
+        }
+
+        if (m_render_data.render_settings.use_tile_convergence && m_converged_tile_count.load() == m_tile_converged.size())
+        {
+            std::cout << "All the tiles have converged after " << m_render_data.render_settings.sample_number << " samples" << std::endl;
+
+            break;
+        }
     }
 
     auto stop = std::chrono::high_resolution_clock::now();
     std::cout << std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count() << "ms" << std::endl;
 }
 
+void CPURenderer::reset()
+{
+    // Same seed as a freshly constructed renderer so that rendering
+    // a view in a batch or on its own gives the same image
+    m_rng = Xorshift32Generator(42);
+    m_render_data.random_seed = HIPRTRenderData().random_seed;
+
+    m_render_data.render_settings.sample_number = 0;
+    m_render_data.render_settings.denoiser_AOV_accumulation_counter = 0;
+    m_render_data.render_settings.need_to_reset = true;
+    // The reservoirs of the previous render were for another camera
+    m_render_data.render_settings.restir_di_settings.temporal_pass.temporal_buffer_clear_requested = true;
+    m_restir_di_state.odd_frame = false;
+
+    // Not reprojecting onto the camera of the previous render
+    m_render_data.prev_camera = m_render_data.current_camera;
+    m_camera_moved = false;
+    m_render_data.render_settings.temporal_accumulation.camera_moved = false;
+    std::fill(m_temporal_history_length_1.begin(), m_temporal_history_length_1.end(), 0);
+    std::fill(m_temporal_history_length_2.begin(), m_temporal_history_length_2.end(), 0);
+    m_still_one_ray_active = true;
+}
+
 void CPURenderer::update(int frame_number)
 {
+    int2 render_grid_resolution = m_render_data.render_settings.get_render_grid_resolution(m_resolution);
+    if (render_grid_resolution.x != m_render_grid_resolution.x || render_grid_resolution.y != m_render_grid_resolution.y)
+    {
+        // The per pixel buffers of the previous frame were indexed with the width of another grid
+        std::fill(m_temporal_history_length_1.begin(), m_temporal_history_length_1.end(), 0);
+        std::fill(m_temporal_history_length_2.begin(), m_temporal_history_length_2.end(), 0);
+        // The camera rays pass copies the G-buffer of the last frame into the G-buffer of the previous frame
+        std::fill(m_g_buffer.cameray_ray_hit.begin(), m_g_buffer.cameray_ray_hit.end(), 0);
+        m_render_data.render_settings.restir_di_settings.temporal_pass.temporal_buffer_clear_requested = true;
+
+        m_render_grid_resolution = render_grid_resolution;
+    }
+
+    if (m_render_data.render_settings.do_render_low_resolution())
+        m_low_resolution_framebuffer.resize(m_render_grid_resolution.x * m_render_grid_resolution.y);
+    m_render_data.aux_buffers.low_resolution_pixels = m_low_resolution_framebuffer.data();
+
     // Resetting the status buffers
     // Uploading false to reset the flag
     *m_render_data.aux_buffers.still_one_ray_active = false;
     // Resetting the counter of pixels converged to 0
     m_render_data.aux_buffers.stop_noise_threshold_converged_count->store(0);
+    m_render_data.aux_buffers.converged_tile_count->store(0);
+
+    m_render_data.render_settings.temporal_accumulation.camera_moved = false;
+    if (m_camera_moved)
+    {
+        // What was accumulated so far is for another point of view. Restarting the
+        // accumulation, the TemporalAccumulation pass reprojects it if enabled
+        m_render_data.render_settings.sample_number = 0;
+        m_render_data.render_settings.denoiser_AOV_accumulation_counter = 0;
+        m_render_data.render_settings.need_to_reset = true;
+        m_render_data.render_settings.temporal_accumulation.camera_moved = true;
+
+        m_camera_moved = false;
+    }
 
     // Update the camera
     /*if (frame_number == 2)
@@ -314,7 +633,7 @@ void CPURenderer::update_render_data(int sample)
     m_render_data.current_camera = m_camera.to_hiprt();
 }
 
-void CPURenderer::debug_render_pass(std::function<void(int, int)> render_pass_function)
+void CPURenderer::debug_render_pass(std::function<void(int, int)> render_pass_function, bool skip_converged_tiles)
 {
     // Center pixel when rendering a neighborhood
     int center_x = 0;
@@ -360,9 +679,9 @@ void CPURenderer::debug_render_pass(std::function<void(int, int)> render_pass_fu
     // Rendering the neighborhood
 
 #pragma omp parallel for schedule(dynamic)
-    for (int render_y = std::max(0, center_y - DEBUG_NEIGHBORHOOD_SIZE); render_y <= std::min(m_resolution.y - 1, center_y + DEBUG_NEIGHBORHOOD_SIZE); render_y++)
+    for (int render_y = std::max(0, center_y - DEBUG_NEIGHBORHOOD_SIZE); render_y <= std::min(m_render_grid_resolution.y - 1, center_y + DEBUG_NEIGHBORHOOD_SIZE); render_y++)
     {
-        for (int render_x = std::max(0, center_x - DEBUG_NEIGHBORHOOD_SIZE); render_x <= std::min(m_resolution.x - 1, center_x + DEBUG_NEIGHBORHOOD_SIZE); render_x++)
+        for (int render_x = std::max(0, center_x - DEBUG_NEIGHBORHOOD_SIZE); render_x <= std::min(m_render_grid_resolution.x - 1, center_x + DEBUG_NEIGHBORHOOD_SIZE); render_x++)
         {
             if (render_x == debug_x && render_y == debug_y)
                 // Skipping the pixel that we debugged to avoid rendering it twice
@@ -375,10 +694,33 @@ void CPURenderer::debug_render_pass(std::function<void(int, int)> render_pass_fu
 
 #else // DEBUG_PIXEL
 
+    if (skip_converged_tiles && m_render_data.render_settings.use_tile_convergence && !m_render_data.render_settings.do_render_low_resolution())
+    {
+        // Scheduling the threads by convergence tiles so that the
+        // tiles that have converged are skipped wholesale
+        int tile_size = m_render_data.render_settings.convergence_tile_size;
+        int2 tile_count = m_render_data.render_settings.get_convergence_tile_count(m_resolution);
+
 #pragma omp parallel for schedule(dynamic)
-    for (int y = 0; y < m_resolution.y; y++)
+        for (int tile_index = 0; tile_index < tile_count.x * tile_count.y; tile_index++)
+        {
+            int tile_x = tile_index % tile_count.x;
+            int tile_y = tile_index / tile_count.x;
+            if (is_pixel_tile_converged(m_render_data, tile_x * tile_size, tile_y * tile_size, m_resolution))
+                continue;
+
+            for (int y = tile_y * tile_size; y < std::min(m_resolution.y, (tile_y + 1) * tile_size); y++)
+                for (int x = tile_x * tile_size; x < std::min(m_resolution.x, (tile_x + 1) * tile_size); x++)
+                    render_pass_function(x, y);
+        }
+
+        return;
+    }
+
+#pragma omp parallel for schedule(dynamic)
+    for (int y = 0; y < m_render_grid_resolution.y; y++)
     {
-        for (int x = 0; x < m_resolution.x; x++)
+        for (int x = 0; x < m_render_grid_resolution.x; x++)
         {
             if (x == debug_x && y == debug_y)
                 // Skipping the pixel that we debugged to avoid rendering it twice
@@ -394,7 +736,7 @@ void CPURenderer::debug_render_pass(std::function<void(int, int)> render_pass_fu
 void CPURenderer::camera_rays_pass()
 {
     debug_render_pass([this](int x, int y) {
-        CameraRays(m_render_data, m_resolution, x, y);
+        CameraRays(m_render_data, m_render_grid_resolution, x, y);
     });
 }
 
@@ -458,7 +800,7 @@ LightPresamplingParameters CPURenderer::configure_ReSTIR_DI_light_presampling_pa
     parameters.triangles_indices = m_render_data.buffers.triangles_indices;
     parameters.vertices_positions = m_render_data.buffers.vertices_positions;
     parameters.material_indices = m_render_data.buffers.material_indices;
-    parameters.materials = m_render_data.buffers.materials_buffer;
+    parameters.materials = m_render_data.buffers.materials_buffer.hot;
 
     // World settings for sampling the envmap
     parameters.world_settings = m_render_data.world_settings;
@@ -496,7 +838,7 @@ void CPURenderer::launch_ReSTIR_DI_initial_candidates_pass()
     configure_ReSTIR_DI_initial_pass();
 
     debug_render_pass([this](int x, int y) {
-        ReSTIR_DI_InitialCandidates(m_render_data, m_resolution, x, y);
+        ReSTIR_DI_InitialCandidates(m_render_data, m_render_grid_resolution, x, y);
     });
 }
 
@@ -635,52 +977,59 @@ void CPURenderer::configure_ReSTIR_DI_output_buffer()
 void CPURenderer::ReSTIR_DI_temporal_reuse_pass()
 {
     debug_render_pass([this](int x, int y) {
-        ReSTIR_DI_TemporalReuse(m_render_data, m_resolution, x, y);
+        ReSTIR_DI_TemporalReuse(m_render_data, m_render_grid_resolution, x, y);
     });
 }
 
 void CPURenderer::ReSTIR_DI_spatial_reuse_pass()
 {
     debug_render_pass([this](int x, int y) {
-        ReSTIR_DI_SpatialReuse(m_render_data, m_resolution, x, y);
+        ReSTIR_DI_SpatialReuse(m_render_data, m_render_grid_resolution, x, y);
     });
 }
 
 void CPURenderer::ReSTIR_DI_spatiotemporal_reuse_pass()
 {
     debug_render_pass([this](int x, int y) {
-        ReSTIR_DI_SpatiotemporalReuse(m_render_data, m_resolution, x, y);
+        ReSTIR_DI_SpatiotemporalReuse(m_render_data, m_render_grid_resolution, x, y);
     });
 }
 
 void CPURenderer::tracing_pass()
 {
+    // The camera rays pass already went through the converged tiles to
+    // keep their framebuffer in sync with the sample count
     debug_render_pass([this](int x, int y) {
-        FullPathTracer(m_render_data, m_resolution, x, y);
-    });
+        FullPathTracer(m_render_data, m_render_grid_resolution, x, y);
+    }, /* skip converged tiles */ true);
 }
 
-void CPURenderer::tonemap(float gamma, float exposure)
+void CPURenderer::tile_convergence_pass()
 {
-#if DEBUG_PIXEL == 0
+    int2 tile_count = m_render_data.render_settings.get_convergence_tile_count(m_resolution);
+
+#pragma omp parallel for schedule(dynamic)
+    for (int tile_index = 0; tile_index < tile_count.x * tile_count.y; tile_index++)
+        TileConvergence(m_render_data, m_resolution, tile_index % tile_count.x, tile_index / tile_count.x);
+}
+
+void CPURenderer::low_resolution_upsampling_pass()
+{
+    // One pixel of the full resolution framebuffer per call, not on the low resolution grid
 #pragma omp parallel for schedule(dynamic)
-#endif
     for (int y = 0; y < m_resolution.y; y++)
-    {
         for (int x = 0; x < m_resolution.x; x++)
-        {
-            int index = x + y * m_resolution.x;
-
-            ColorRGB32F hdr_color = m_render_data.buffers.pixels[index];
-
-            if (m_render_data.render_settings.accumulate)
-                // Scaling by sample count
-                hdr_color = hdr_color / float(m_render_data.render_settings.sample_number);
+            LowResolutionUpsampling(m_render_data, m_resolution, x, y);
+}
 
-            ColorRGB32F tone_mapped = ColorRGB32F(1.0f) - exp(-hdr_color * exposure);
-            tone_mapped = pow(tone_mapped, 1.0f / gamma);
+void CPURenderer::temporal_accumulation_pass()
+{
+    debug_render_pass([this](int x, int y) {
+        TemporalAccumulation(m_render_data, m_render_grid_resolution, x, y);
+    });
 
-            m_render_data.buffers.pixels[index] = tone_mapped;
-        }
-    }
+    // The history of this frame is read by the next one
+    TemporalAccumulationSettings& temporal_accumulation = m_render_data.render_settings.temporal_accumulation;
+    std::swap(temporal_accumulation.history, temporal_accumulation.prev_history);
+    std::swap(temporal_accumulation.history_length, temporal_accumulation.prev_history_length);
 }
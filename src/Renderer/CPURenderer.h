@@ -9,6 +9,7 @@
 #include "Device/kernel_parameters/ReSTIR/DI/LightPresamplingParameters.h"
 #include "HostDeviceCommon/RenderData.h"
 #include "Image/Image.h"
+#include "Renderer/BackgroundDenoiser.h"
 #include "Renderer/BVH.h"
 #include "Renderer/CPURendererGBuffer.h"
 #include "Scene/SceneParser.h"
@@ -26,17 +27,57 @@ public:
 
     void set_scene(Scene& parsed_scene);
     void set_envmap(Image32Bit& envmap_image);
+    /**
+     * If called between two calls to render() without reset(), the next frame
+     * either restarts the accumulation or reprojects it onto the new camera,
+     * depending on render_settings.temporal_accumulation.do_temporal_reprojection
+     */
     void set_camera(Camera& camera);
 
     HIPRTRenderData& get_render_data();
     HIPRTRenderSettings& get_render_settings();
     Image32Bit& get_framebuffer();
+    /**
+     * If render_settings.use_compact_AOVs is true, the packed AOVs
+     * are decoded into the returned buffer first
+     */
+    std::vector<ColorRGB32F>& get_denoiser_albedo_AOV_buffer();
+    std::vector<float3>& get_denoiser_normals_AOV_buffer();
+    std::vector<int>& get_pixel_sample_count_buffer();
+    std::vector<int>& get_pixel_converged_sample_count_buffer();
+
+    /**
+     * Returns the 95% confidence interval of the luminance of each pixel,
+     * relative to its average luminance, i.e. the same metric as the adaptive
+     * sampling noise threshold.
+     *
+     * Returns an empty vector if the renderer isn't accumulating the
+     * luminance needed (neither adaptive sampling nor the pixel noise threshold is on)
+     */
+    std::vector<float> compute_pixel_noise_map();
+
+    /**
+     * While rendering, snapshots of the framebuffer are handed to the given background denoiser
+     * every 'every_n_samples' samples or every 'every_n_seconds' seconds, whichever comes first.
+     * 0 disables the corresponding trigger. nullptr disables the background denoising
+     */
+    void set_background_denoiser(std::shared_ptr<BackgroundDenoiser> background_denoiser, int every_n_samples, float every_n_seconds);
 
     void render();
+    /**
+     * Resets the accumulation so that the next call to render() starts a new image.
+     * The scene, its BVH and the textures are kept. Used to render several views of
+     * the same scene (set_camera() then reset())
+     */
+    void reset();
     void update(int frame_number);
     void update_render_data(int sample);
 
-    void debug_render_pass(std::function<void(int, int)> render_pass_function);
+    /**
+     * If 'skip_converged_tiles' is true, the pixels of the tiles that have converged
+     * (see render_settings.use_tile_convergence) aren't given to the render pass function
+     */
+    void debug_render_pass(std::function<void(int, int)> render_pass_function, bool skip_converged_tiles = false);
     void camera_rays_pass();
 
     void ReSTIR_DI();
@@ -59,30 +100,93 @@ public:
     void ReSTIR_DI_spatiotemporal_reuse_pass();
 
     void tracing_pass();
+    void temporal_accumulation_pass();
+    void tile_convergence_pass();
+    void low_resolution_upsampling_pass();
 
-    void tonemap(float gamma, float exposure);
 
 private:
+    /**
+     * Allocates / frees the packed denoiser AOV buffers depending on render_settings.use_compact_AOVs.
+     * The full precision AOV buffers are freed while the AOVs are compact
+     */
+    void update_compact_AOV_buffers();
+    /**
+     * Decodes the packed denoiser AOVs into 'm_denoiser_albedo' and 'm_denoiser_normals',
+     * allocating them first. Does nothing if the AOVs aren't compact
+     */
+    void unpack_denoiser_AOVs();
+    /**
+     * Allocates / frees the per pixel color sums depending on
+     * render_settings.has_access_to_adaptive_sampling_buffers()
+     * (adaptive sampling, pixel noise threshold or tile convergence)
+     */
+    void update_adaptive_sampling_buffers();
+    /**
+     * Allocates / frees the per pixel material filter depending on
+     * render_settings.use_partial_material_reset
+     */
+    void update_material_filter_buffer();
+    /**
+     * Allocates / frees the history buffers of the temporal reprojection depending
+     * on render_settings.temporal_accumulation.do_temporal_reprojection
+     */
+    void update_temporal_accumulation_buffers();
+    /**
+     * Resizes the convergence tiles map to the tile size of the render settings
+     */
+    void update_tile_convergence_buffers();
+
     int2 m_resolution;
+    // Resolution of the grid that the render passes are launched on for the current frame,
+    // smaller than 'm_resolution' when rendering at low resolution.
+    // See HIPRTRenderSettings::get_render_grid_resolution()
+    int2 m_render_grid_resolution;
 
     Image32Bit m_framebuffer;
+    // Framebuffer of the render passes when rendering at low resolution
+    std::vector<ColorRGB32F> m_low_resolution_framebuffer;
     std::vector<unsigned char> m_pixel_active_buffer;
     std::vector<ColorRGB32F> m_denoiser_albedo;
     std::vector<float3> m_denoiser_normals;
+    // Used instead of the two buffers above for the accumulation when render_settings.use_compact_AOVs is true
+    std::vector<unsigned int> m_packed_denoiser_albedo;
+    std::vector<unsigned int> m_packed_denoiser_normals;
 
     std::vector<int> m_pixel_sample_count;
     std::vector<int> m_pixel_converged_sample_count;
     std::vector<float> m_pixel_squared_luminance;
+    std::vector<ColorRGB32F> m_pixel_color_sum;
+    std::vector<ColorRGB32F> m_pixel_odd_color_sum;
+    std::vector<unsigned int> m_pixel_material_filter;
+    std::vector<unsigned char> m_tile_converged;
+    AtomicType<float> m_adaptive_sampling_error_sums[3];
     unsigned char m_still_one_ray_active = true;
     AtomicType<unsigned int> m_stop_noise_threshold_count;
+    AtomicType<unsigned int> m_converged_tile_count;
+
+    // Materials of the scene split into their hot / shading / cold blocks
+    MaterialsSoAHost m_materials;
 
     std::vector<float> m_envmap_cdf;
-    std::vector<float> m_alias_table_probas;
-    std::vector<int> m_alias_table_alias;
+    std::vector<EnvmapAliasTableEntry> m_alias_table;
+
+    std::shared_ptr<BackgroundDenoiser> m_background_denoiser = nullptr;
+    int m_background_denoise_every_n_samples = 0;
+    float m_background_denoise_every_n_seconds = 0.0f;
 
     CPURendererGBuffer m_g_buffer;
     CPURendererGBuffer m_g_buffer_prev_frame;
 
+    // History of the temporal reprojection, swapped every frame.
+    // See TemporalAccumulationSettings
+    std::vector<ColorRGB32F> m_temporal_history_1;
+    std::vector<ColorRGB32F> m_temporal_history_2;
+    std::vector<int> m_temporal_history_length_1;
+    std::vector<int> m_temporal_history_length_2;
+    // Set by set_camera(), the accumulation is reset or reprojected on the next frame
+    bool m_camera_moved = false;
+
     // Random number generator for given a random seed to the threads at each sample
     Xorshift32Generator m_rng;
 
@@ -99,8 +203,11 @@ private:
         bool odd_frame = false;
     } m_restir_di_state;
 
-    Image32Bit m_sheen_ltc_params;
-    Image32Bit m_GGX_conductor_Ess;
+    Image32BitView m_sheen_ltc_params;
+    Image32BitView m_GGX_conductor_Ess;
+    // Storage for the GGX conductor LUT when it's read from disk
+    // i.e. when the LUTs aren't embedded in the executable
+    Image32Bit m_GGX_conductor_Ess_image;
     Image32Bit3D m_glossy_dielectrics_Ess;
     Image32Bit3D m_GGX_Ess_glass;
     Image32Bit3D m_GGX_Ess_glass_inverse;
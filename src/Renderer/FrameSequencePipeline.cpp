@@ -0,0 +1,177 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#include "Image/Image.h"
+#include "Renderer/CPURenderer.h"
+#include "Renderer/FrameSequencePipeline.h"
+#include "UI/ImGui/ImGuiLogger.h"
+
+#include <algorithm>
+#include <chrono>
+
+extern ImGuiLogger g_imgui_logger;
+
+FrameSequencePipeline::FrameSequencePipeline(int width, int height, const DisplayPipeline& display_pipeline, ImageWriterPool& image_writer_pool, const FrameSequenceOutputSettings& settings)
+    : m_width(width), m_height(height), m_display_pipeline(display_pipeline), m_image_writer_pool(image_writer_pool), m_settings(settings)
+{
+    int pixel_count = width * height;
+
+    for (FrameBuffers* frame : { &m_pending_frame, &m_working_frame })
+    {
+        frame->color.resize(pixel_count);
+        frame->albedo.resize(pixel_count);
+        frame->normals.resize(pixel_count);
+    }
+
+    // The working buffers are never reallocated, the denoiser
+    // reads them directly for the whole sequence
+    m_denoiser.initialize(/* force CPU device */ true);
+    m_denoiser.set_use_albedo(true);
+    m_denoiser.set_use_normals(true);
+    m_denoiser.set_shared_host_buffers(m_working_frame.color.data(), m_working_frame.normals.data(), m_working_frame.albedo.data());
+    m_denoiser.set_tiling(settings.denoise_tile_size, settings.denoise_tile_overlap);
+    m_denoiser.resize(width, height);
+    m_denoiser.finalize();
+
+    m_worker_thread = std::thread(&FrameSequencePipeline::worker_thread_function, this);
+}
+
+FrameSequencePipeline::~FrameSequencePipeline()
+{
+    flush();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop_worker = true;
+    }
+    m_frame_pending_condition.notify_one();
+
+    if (m_worker_thread.joinable())
+        m_worker_thread.join();
+}
+
+void FrameSequencePipeline::submit_frame(CPURenderer& renderer, const std::string& output_prefix)
+{
+    // Reading the buffers of the renderer before taking the lock, the
+    // getters may have to unpack the AOVs
+    const ColorRGB32F* color = renderer.get_framebuffer().get_data_as_ColorRGB32F();
+    const ColorRGB32F* albedo = renderer.get_denoiser_albedo_AOV_buffer().data();
+    const float3* normals = renderer.get_denoiser_normals_AOV_buffer().data();
+    std::vector<float> noise_map;
+    if (m_settings.write_exr)
+        noise_map = renderer.compute_pixel_noise_map();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    // Only one frame waiting at a time
+    m_frame_taken_condition.wait(lock, [this]() { return !m_frame_pending; });
+
+    std::copy(color, color + m_width * m_height, m_pending_frame.color.begin());
+    std::copy(albedo, albedo + m_width * m_height, m_pending_frame.albedo.begin());
+    std::copy(normals, normals + m_width * m_height, m_pending_frame.normals.begin());
+    if (m_settings.write_exr)
+    {
+        m_pending_frame.sample_count = renderer.get_pixel_sample_count_buffer();
+        m_pending_frame.converged_sample_count = renderer.get_pixel_converged_sample_count_buffer();
+        m_pending_frame.noise_map = std::move(noise_map);
+    }
+    m_pending_frame.sample_number = renderer.get_render_settings().sample_number;
+    m_pending_frame.output_prefix = output_prefix;
+
+    m_frame_pending = true;
+    lock.unlock();
+
+    m_frame_pending_condition.notify_one();
+}
+
+void FrameSequencePipeline::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_frame_taken_condition.wait(lock, [this]() { return !m_frame_pending && !m_worker_busy; });
+}
+
+void FrameSequencePipeline::worker_thread_function()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_frame_pending_condition.wait(lock, [this]() { return m_stop_worker || m_frame_pending; });
+
+            if (m_stop_worker)
+                break;
+
+            // The pixels are copied because the denoiser is bound to the working buffers.
+            // The rest can just be swapped
+            std::copy(m_pending_frame.color.begin(), m_pending_frame.color.end(), m_working_frame.color.begin());
+            std::copy(m_pending_frame.albedo.begin(), m_pending_frame.albedo.end(), m_working_frame.albedo.begin());
+            std::copy(m_pending_frame.normals.begin(), m_pending_frame.normals.end(), m_working_frame.normals.begin());
+            std::swap(m_pending_frame.sample_count, m_working_frame.sample_count);
+            std::swap(m_pending_frame.converged_sample_count, m_working_frame.converged_sample_count);
+            std::swap(m_pending_frame.noise_map, m_working_frame.noise_map);
+            m_working_frame.sample_number = m_pending_frame.sample_number;
+            m_working_frame.output_prefix = m_pending_frame.output_prefix;
+
+            m_frame_pending = false;
+            m_worker_busy = true;
+        }
+        // The renderer can submit its next frame
+        m_frame_taken_condition.notify_all();
+
+        finish_frame();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_worker_busy = false;
+        }
+        m_frame_taken_condition.notify_all();
+    }
+}
+
+void FrameSequencePipeline::finish_frame()
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // Denoising the HDR framebuffer only once, with the albedo and normals AOVs.
+    // The blend factors are then just a cheap blend of the denoised and noisy images
+    m_denoiser.denoise_shared_buffers();
+
+    const ColorRGB32F* noisy_pixels = m_working_frame.color.data();
+    Image32Bit image_denoised_1(m_width, m_height, 3);
+    Image32Bit image_denoised_075(m_width, m_height, 3);
+    Image32Bit image_denoised_05(m_width, m_height, 3);
+    m_denoiser.blend_denoised_data(noisy_pixels, 1.0f, image_denoised_1.get_data_as_ColorRGB32F());
+    m_denoiser.blend_denoised_data(noisy_pixels, 0.75f, image_denoised_075.get_data_as_ColorRGB32F());
+    m_denoiser.blend_denoised_data(noisy_pixels, 0.5f, image_denoised_05.get_data_as_ColorRGB32F());
+
+    // The framebuffer and the denoised images hold the sum of the samples
+    float inverse_sample_number = 1.0f / m_working_frame.sample_number;
+    const std::string& output_prefix = m_working_frame.output_prefix;
+
+    if (m_settings.write_exr)
+    {
+        MultiLayerEXRWriter exr_writer(m_width, m_height);
+        exr_writer.add_layer("", noisy_pixels, m_settings.exr_pixel_type, inverse_sample_number);
+        exr_writer.add_layer("denoised", image_denoised_1.get_data_as_ColorRGB32F(), m_settings.exr_pixel_type, inverse_sample_number);
+        exr_writer.add_layer("albedo", m_working_frame.albedo.data(), m_settings.exr_pixel_type);
+        exr_writer.add_layer("normals", m_working_frame.normals.data(), m_settings.exr_pixel_type);
+        exr_writer.add_layer("sample_count", m_working_frame.sample_count.data());
+        exr_writer.add_layer("converged_sample_count", m_working_frame.converged_sample_count.data());
+        if (!m_working_frame.noise_map.empty())
+            exr_writer.add_layer("noise", m_working_frame.noise_map.data(), m_settings.exr_pixel_type);
+
+        // Same orientation as the PNGs
+        exr_writer.write(output_prefix + ".exr", m_settings.exr_compression, /* flipY */ true);
+    }
+
+    // Encoded in parallel by the workers of the pool
+    m_image_writer_pool.write_png(m_display_pipeline.process_to_8bit(noisy_pixels, m_width, m_height, inverse_sample_number), m_width, m_height, 3, output_prefix + ".png", /* flipY */ true);
+    m_image_writer_pool.write_png(m_display_pipeline.process_to_8bit(image_denoised_1.get_data_as_ColorRGB32F(), m_width, m_height, inverse_sample_number), m_width, m_height, 3, output_prefix + "_denoised_1.png", /* flipY */ true);
+    m_image_writer_pool.write_png(m_display_pipeline.process_to_8bit(image_denoised_075.get_data_as_ColorRGB32F(), m_width, m_height, inverse_sample_number), m_width, m_height, 3, output_prefix + "_denoised_075.png", /* flipY */ true);
+    m_image_writer_pool.write_png(m_display_pipeline.process_to_8bit(image_denoised_05.get_data_as_ColorRGB32F(), m_width, m_height, inverse_sample_number), m_width, m_height, 3, output_prefix + "_denoised_05.png", /* flipY */ true);
+
+    auto stop = std::chrono::high_resolution_clock::now();
+    g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_INFO, "Frame %s finished in %dms", output_prefix.c_str(), static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count()));
+}
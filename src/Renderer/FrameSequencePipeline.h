@@ -0,0 +1,121 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef FRAME_SEQUENCE_PIPELINE_H
+#define FRAME_SEQUENCE_PIPELINE_H
+
+#include "HostDeviceCommon/Color.h"
+#include "Image/DisplayPipeline.h"
+#include "Image/ImageWriterPool.h"
+#include "Image/MultiLayerEXRWriter.h"
+#include "Renderer/OpenImageDenoiser.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class CPURenderer;
+
+struct FrameSequenceOutputSettings
+{
+    // If true, a multi-layer EXR is written next to the PNGs of each frame
+    bool write_exr = false;
+    MultiLayerEXRWriter::Compression exr_compression = MultiLayerEXRWriter::Compression::ZIP;
+    MultiLayerEXRWriter::PixelType exr_pixel_type = MultiLayerEXRWriter::PixelType::HALF;
+
+    // See OpenImageDenoiser::set_tiling()
+    int denoise_tile_size = 0;
+    int denoise_tile_overlap = 32;
+};
+
+/**
+ * Headless frame sequence engine of the CPU renderer.
+ *
+ * The frames go through three stages that run at the same time on different frames:
+ *  - The renderer renders frame N + 1 on the calling thread
+ *  - The worker thread of this pipeline finishes frame N: denoising, blending,
+ *    tonemapping and EXR writing
+ *  - The workers of the ImageWriterPool encode the PNGs of frame N - 1
+ *
+ * submit_frame() copies the buffers of the renderer so that it can start the next frame
+ * right away. Only one frame waits for the worker at a time: submit_frame() blocks if the
+ * worker is still busy with the previous frame and another one is already waiting. This
+ * bounds the memory used by long sequences.
+ *
+ * Each frame is finished the same way the final image of a single render is.
+ * The output depends only on the rendered buffers, not on the timing of the stages.
+ */
+class FrameSequencePipeline
+{
+public:
+    /**
+     * 'display_pipeline' and 'image_writer_pool' must outlive the pipeline
+     */
+    FrameSequencePipeline(int width, int height, const DisplayPipeline& display_pipeline, ImageWriterPool& image_writer_pool, const FrameSequenceOutputSettings& settings);
+    /**
+     * Finishes all the submitted frames
+     */
+    ~FrameSequencePipeline();
+
+    /**
+     * Copies the framebuffer, the AOVs and the per pixel sample counts of the renderer
+     * and returns. The images of the frame are written as "<output_prefix>.png",
+     * "<output_prefix>_denoised_1.png", ...
+     */
+    void submit_frame(CPURenderer& renderer, const std::string& output_prefix);
+
+    /**
+     * Blocks until all the submitted frames have been finished and handed to the image writer pool
+     */
+    void flush();
+
+private:
+    struct FrameBuffers
+    {
+        std::vector<ColorRGB32F> color;
+        std::vector<ColorRGB32F> albedo;
+        std::vector<float3> normals;
+
+        // Only filled if the EXR is written
+        std::vector<int> sample_count;
+        std::vector<int> converged_sample_count;
+        std::vector<float> noise_map;
+
+        int sample_number = 0;
+        std::string output_prefix;
+    };
+
+    void worker_thread_function();
+    void finish_frame();
+
+    int m_width, m_height;
+
+    const DisplayPipeline& m_display_pipeline;
+    ImageWriterPool& m_image_writer_pool;
+    FrameSequenceOutputSettings m_settings;
+
+    // Reads the buffers of 'm_working_frame' directly
+    OpenImageDenoiser m_denoiser;
+
+    // Frame written by submit_frame(). Protected by 'm_mutex'
+    FrameBuffers m_pending_frame;
+    bool m_frame_pending = false;
+    // Frame being finished. Only accessed by the worker thread
+    FrameBuffers m_working_frame;
+
+    std::mutex m_mutex;
+    // Signals the worker that a frame is pending or that it should stop
+    std::condition_variable m_frame_pending_condition;
+    // Signals submit_frame() / flush() that the pending frame was picked up / that the worker went idle
+    std::condition_variable m_frame_taken_condition;
+
+    bool m_worker_busy = false;
+    bool m_stop_worker = false;
+    std::thread m_worker_thread;
+};
+
+#endif
@@ -17,9 +17,17 @@
 
 #include <condition_variable>
 
+#if EMBED_BRDFS_LUTS
+// Generated at build time from the .hdr files of data/BRDFsData by cmake/SetupEmbeddedBRDFsLUTs.cmake
+#include "EmbeddedBRDFsLUTs.h"
+#endif
+
 const std::string GPURenderer::CAMERA_RAYS_KERNEL_ID = "Camera Rays";
 const std::string GPURenderer::PATH_TRACING_KERNEL_ID = "Path Tracing";
+const std::string GPURenderer::TILE_CONVERGENCE_KERNEL_ID = "Tile Convergence";
+const std::string GPURenderer::LOW_RESOLUTION_UPSAMPLING_KERNEL_ID = "Low Resolution Upsampling";
 const std::string GPURenderer::RAY_VOLUME_STATE_SIZE_KERNEL_ID = "Ray Volume State Size";
+const std::string GPURenderer::UNPACK_DENOISER_AOVS_KERNEL_ID = "Unpack Denoiser AOVs";
 
 // List of partials_options that will be specific to each kernel. We don't want these partials_options
 	// to be synchronized between kernels
@@ -33,14 +41,20 @@ const std::unordered_map<std::string, std::string> GPURenderer::KERNEL_FUNCTION_
 {
 	{ CAMERA_RAYS_KERNEL_ID, "CameraRays" },
 	{ PATH_TRACING_KERNEL_ID, "FullPathTracer" },
+	{ TILE_CONVERGENCE_KERNEL_ID, "TileConvergence" },
+	{ LOW_RESOLUTION_UPSAMPLING_KERNEL_ID, "LowResolutionUpsampling" },
 	{ RAY_VOLUME_STATE_SIZE_KERNEL_ID, "RayVolumeStateSize" },
+	{ UNPACK_DENOISER_AOVS_KERNEL_ID, "UnpackDenoiserAOVs" },
 };
 
 const std::unordered_map<std::string, std::string> GPURenderer::KERNEL_FILES =
 {
 	{ CAMERA_RAYS_KERNEL_ID, DEVICE_KERNELS_DIRECTORY "/CameraRays.h" },
 	{ PATH_TRACING_KERNEL_ID, DEVICE_KERNELS_DIRECTORY "/FullPathTracer.h" },
+	{ TILE_CONVERGENCE_KERNEL_ID, DEVICE_KERNELS_DIRECTORY "/TileConvergence.h" },
+	{ LOW_RESOLUTION_UPSAMPLING_KERNEL_ID, DEVICE_KERNELS_DIRECTORY "/LowResolutionUpsampling.h" },
 	{ RAY_VOLUME_STATE_SIZE_KERNEL_ID, DEVICE_KERNELS_DIRECTORY "/Utils/RayVolumeStateSize.h" },
+	{ UNPACK_DENOISER_AOVS_KERNEL_ID, DEVICE_KERNELS_DIRECTORY "/Utils/UnpackDenoiserAOVs.h" },
 };
 
 const std::string GPURenderer::FULL_FRAME_TIME_KEY = "FullFrameTime";
@@ -80,6 +94,11 @@ GPURenderer::GPURenderer(std::shared_ptr<HIPRTOrochiCtx> hiprt_oro_ctx)
 	m_still_one_ray_active_buffer.resize(1);
 	m_still_one_ray_active_buffer.upload_data(&true_data);
 	m_pixels_converged_count_buffer.resize(1);
+	m_converged_tile_count_buffer.resize(1);
+	// Three sums in rotation, see redistributed_sample_count()
+	float zero_error_sums[3] = { 0.0f, 0.0f, 0.0f };
+	m_adaptive_sampling_error_sums_buffer.resize(3);
+	m_adaptive_sampling_error_sums_buffer.upload_data(zero_error_sums);
 
 	OROCHI_CHECK_ERROR(oroEventCreate(&m_frame_start_event));
 	OROCHI_CHECK_ERROR(oroEventCreate(&m_frame_stop_event));
@@ -119,7 +138,13 @@ void GPURenderer::init_sheen_ltc_texture()
 
 void GPURenderer::init_GGX_Ess_texture(HIPfilter_mode filtering_mode)
 {
+#if EMBED_BRDFS_LUTS
+	// Note that this means that a GGX conductor LUT baked with the GPUBaker at runtime
+	// is only going to be used after rebuilding
+	Image32Bit GGXEss_image(GGX_conductor_Ess_embedded, GGX_conductor_Ess_embedded_width, GGX_conductor_Ess_embedded_height, 1);
+#else
 	Image32Bit GGXEss_image = Image32Bit::read_image_hdr(BRDFS_DATA_DIRECTORY "/GGX/" + GPUBakerConstants::get_GGX_conductor_Ess_filename(), 1, true);
+#endif
 	m_GGX_conductor_Ess = OrochiTexture(GGXEss_image, filtering_mode);
 
 	m_render_data_buffers_invalidated = true;
@@ -212,6 +237,17 @@ void GPURenderer::setup_kernels()
 	m_kernels[GPURenderer::PATH_TRACING_KERNEL_ID].get_kernel_options().set_macro_value(GPUKernelCompilerOptions::USE_SHARED_STACK_BVH_TRAVERSAL, KERNEL_OPTION_TRUE);
 	m_kernels[GPURenderer::PATH_TRACING_KERNEL_ID].get_kernel_options().set_macro_value(GPUKernelCompilerOptions::SHARED_STACK_BVH_TRAVERSAL_SIZE, 48);
 
+	// Doesn't trace any ray
+	m_kernels[GPURenderer::TILE_CONVERGENCE_KERNEL_ID].set_kernel_file_path(GPURenderer::KERNEL_FILES.at(GPURenderer::TILE_CONVERGENCE_KERNEL_ID));
+	m_kernels[GPURenderer::TILE_CONVERGENCE_KERNEL_ID].set_kernel_function_name(GPURenderer::KERNEL_FUNCTION_NAMES.at(GPURenderer::TILE_CONVERGENCE_KERNEL_ID));
+	m_kernels[GPURenderer::TILE_CONVERGENCE_KERNEL_ID].synchronize_options_with(*m_global_compiler_options, GPURenderer::KERNEL_OPTIONS_NOT_SYNCHRONIZED);
+	m_kernels[GPURenderer::TILE_CONVERGENCE_KERNEL_ID].get_kernel_options().set_macro_value(GPUKernelCompilerOptions::USE_SHARED_STACK_BVH_TRAVERSAL, KERNEL_OPTION_FALSE);
+
+	m_kernels[GPURenderer::LOW_RESOLUTION_UPSAMPLING_KERNEL_ID].set_kernel_file_path(GPURenderer::KERNEL_FILES.at(GPURenderer::LOW_RESOLUTION_UPSAMPLING_KERNEL_ID));
+	m_kernels[GPURenderer::LOW_RESOLUTION_UPSAMPLING_KERNEL_ID].set_kernel_function_name(GPURenderer::KERNEL_FUNCTION_NAMES.at(GPURenderer::LOW_RESOLUTION_UPSAMPLING_KERNEL_ID));
+	m_kernels[GPURenderer::LOW_RESOLUTION_UPSAMPLING_KERNEL_ID].synchronize_options_with(*m_global_compiler_options, GPURenderer::KERNEL_OPTIONS_NOT_SYNCHRONIZED);
+	m_kernels[GPURenderer::LOW_RESOLUTION_UPSAMPLING_KERNEL_ID].get_kernel_options().set_macro_value(GPUKernelCompilerOptions::USE_SHARED_STACK_BVH_TRAVERSAL, KERNEL_OPTION_FALSE);
+
 	m_restir_di_render_pass = ReSTIRDIRenderPass(this);
 	if (m_global_compiler_options->get_macro_value(GPUKernelCompilerOptions::DIRECT_LIGHT_SAMPLING_STRATEGY) == LSS_RESTIR_DI)
 		// We only need to compile the ReSTIR DI render pass if ReSTIR DI is actually being used
@@ -228,9 +264,18 @@ void GPURenderer::setup_kernels()
 	m_ray_volume_state_byte_size_kernel.synchronize_options_with(*m_global_compiler_options, GPURenderer::KERNEL_OPTIONS_NOT_SYNCHRONIZED);
 	ThreadManager::start_thread(ThreadManager::COMPILE_RAY_VOLUME_STATE_SIZE_KERNEL_KEY, ThreadFunctions::compile_kernel_silent, std::ref(m_ray_volume_state_byte_size_kernel), m_hiprt_orochi_ctx, std::ref(m_func_name_sets));
 
+	// Kernel that decodes the packed denoiser AOVs when render_settings.use_compact_AOVs is true.
+	// Not part of 'm_kernels' since this isn't a render pass
+	m_unpack_denoiser_AOVs_kernel.set_kernel_file_path(GPURenderer::KERNEL_FILES.at(GPURenderer::UNPACK_DENOISER_AOVS_KERNEL_ID));
+	m_unpack_denoiser_AOVs_kernel.set_kernel_function_name(GPURenderer::KERNEL_FUNCTION_NAMES.at(GPURenderer::UNPACK_DENOISER_AOVS_KERNEL_ID));
+	m_unpack_denoiser_AOVs_kernel.synchronize_options_with(*m_global_compiler_options, GPURenderer::KERNEL_OPTIONS_NOT_SYNCHRONIZED);
+
 	// Compiling kernels
 	ThreadManager::start_thread(ThreadManager::COMPILE_KERNELS_THREAD_KEY, ThreadFunctions::compile_kernel, std::ref(m_kernels[GPURenderer::CAMERA_RAYS_KERNEL_ID]), m_hiprt_orochi_ctx, std::ref(m_func_name_sets));
 	ThreadManager::start_thread(ThreadManager::COMPILE_KERNELS_THREAD_KEY, ThreadFunctions::compile_kernel, std::ref(m_kernels[GPURenderer::PATH_TRACING_KERNEL_ID]), m_hiprt_orochi_ctx, std::ref(m_func_name_sets));
+	ThreadManager::start_thread(ThreadManager::COMPILE_KERNELS_THREAD_KEY, ThreadFunctions::compile_kernel, std::ref(m_kernels[GPURenderer::TILE_CONVERGENCE_KERNEL_ID]), m_hiprt_orochi_ctx, std::ref(m_func_name_sets));
+	ThreadManager::start_thread(ThreadManager::COMPILE_KERNELS_THREAD_KEY, ThreadFunctions::compile_kernel, std::ref(m_kernels[GPURenderer::LOW_RESOLUTION_UPSAMPLING_KERNEL_ID]), m_hiprt_orochi_ctx, std::ref(m_func_name_sets));
+	ThreadManager::start_thread(ThreadManager::COMPILE_KERNELS_THREAD_KEY, ThreadFunctions::compile_kernel_silent, std::ref(m_unpack_denoiser_AOVs_kernel), m_hiprt_orochi_ctx, std::ref(m_func_name_sets));
 }
 
 void GPURenderer::update()
@@ -250,6 +295,11 @@ void GPURenderer::update()
 	internal_update_prev_frame_g_buffer();
 	internal_update_adaptive_sampling_buffers();
 	internal_update_global_stack_buffer();
+	internal_update_compact_AOV_buffers();
+	internal_update_tile_convergence_buffers();
+	internal_update_material_filter_buffer();
+	internal_update_low_resolution_buffers();
+	internal_update_render_grid_resolution();
 
 	update_render_data();
 
@@ -270,6 +320,7 @@ void GPURenderer::copy_status_buffers()
 {
 	OROCHI_CHECK_ERROR(oroMemcpy(&m_status_buffers_values.one_ray_active, m_still_one_ray_active_buffer.get_device_pointer(), sizeof(unsigned char), oroMemcpyDeviceToHost));
 	OROCHI_CHECK_ERROR(oroMemcpy(&m_status_buffers_values.pixel_converged_count, m_pixels_converged_count_buffer.get_device_pointer(), sizeof(unsigned int), oroMemcpyDeviceToHost));
+	OROCHI_CHECK_ERROR(oroMemcpy(&m_status_buffers_values.converged_tile_count, m_converged_tile_count_buffer.get_device_pointer(), sizeof(unsigned int), oroMemcpyDeviceToHost));
 }
 
 void GPURenderer::internal_update_clear_device_status_buffers()
@@ -280,12 +331,15 @@ void GPURenderer::internal_update_clear_device_status_buffers()
 	m_still_one_ray_active_buffer.upload_data(&false_data);
 	// Resetting the counter of pixels converged to 0
 	m_pixels_converged_count_buffer.upload_data(&zero_data);
+	// Resetting the counter of tiles converged to 0
+	m_converged_tile_count_buffer.upload_data(&zero_data);
 }
 
 void GPURenderer::internal_clear_m_status_buffers()
 {
 	m_status_buffers_values.one_ray_active = true;
 	m_status_buffers_values.pixel_converged_count = 0;
+	m_status_buffers_values.converged_tile_count = 0;
 }
 
 void GPURenderer::internal_update_prev_frame_g_buffer()
@@ -324,9 +378,11 @@ void GPURenderer::internal_update_adaptive_sampling_buffers()
 	{
 		bool pixels_squared_luminance_needs_resize = m_pixels_squared_luminance_buffer.get_element_count() == 0;
 		bool pixels_sample_count_needs_resize = m_pixels_sample_count_buffer.get_element_count() == 0;
+		bool pixels_color_sum_needs_resize = m_pixels_color_sum_buffer.get_element_count() == 0;
+		bool pixels_odd_color_sum_needs_resize = m_pixels_odd_color_sum_buffer.get_element_count() == 0;
 		bool pixels_converged_sample_count_needs_resize = m_pixels_converged_sample_count_buffer->get_element_count() == 0;
 
-		if (pixels_squared_luminance_needs_resize || pixels_sample_count_needs_resize || pixels_converged_sample_count_needs_resize)
+		if (pixels_squared_luminance_needs_resize || pixels_sample_count_needs_resize || pixels_color_sum_needs_resize || pixels_odd_color_sum_needs_resize || pixels_converged_sample_count_needs_resize)
 			// At least on buffer is going to be resized so buffers are invalidated
 			m_render_data_buffers_invalidated = true;
 
@@ -338,21 +394,150 @@ void GPURenderer::internal_update_adaptive_sampling_buffers()
 			// Only allocating if it isn't already
 			m_pixels_sample_count_buffer.resize(m_render_resolution.x * m_render_resolution.y);
 
+		if (pixels_color_sum_needs_resize)
+			// Only allocating if it isn't already
+			m_pixels_color_sum_buffer.resize(m_render_resolution.x * m_render_resolution.y);
+
+		if (pixels_odd_color_sum_needs_resize)
+			m_pixels_odd_color_sum_buffer.resize(m_render_resolution.x * m_render_resolution.y);
+
 		if (pixels_converged_sample_count_needs_resize)
 			m_pixels_converged_sample_count_buffer->resize(m_render_resolution.x * m_render_resolution.y);
 
 	}
 	else
 	{
-		if (m_pixels_squared_luminance_buffer.get_element_count() > 0 || m_pixels_sample_count_buffer.get_element_count() > 0 || m_pixels_converged_sample_count_buffer->get_element_count() > 0)
+		if (m_pixels_squared_luminance_buffer.get_element_count() > 0 || m_pixels_sample_count_buffer.get_element_count() > 0 || m_pixels_color_sum_buffer.get_element_count() > 0 || m_pixels_odd_color_sum_buffer.get_element_count() > 0 || m_pixels_converged_sample_count_buffer->get_element_count() > 0)
 			m_render_data_buffers_invalidated = true;
 
 		m_pixels_squared_luminance_buffer.free();
 		m_pixels_sample_count_buffer.free();
+		m_pixels_color_sum_buffer.free();
+		m_pixels_odd_color_sum_buffer.free();
 		m_pixels_converged_sample_count_buffer->free();
 	}
 }
 
+void GPURenderer::internal_update_tile_convergence_buffers()
+{
+	if (m_render_data.render_settings.use_tile_convergence)
+	{
+		int2 tile_count = m_render_data.render_settings.get_convergence_tile_count(m_render_resolution);
+		if (m_tile_converged_buffer.get_element_count() != static_cast<size_t>(tile_count.x * tile_count.y))
+		{
+			// The tile size or the resolution changed. The kernel clears
+			// the map on the first sample, the render is going to be reset
+			m_tile_converged_buffer.resize(tile_count.x * tile_count.y);
+
+			m_render_data_buffers_invalidated = true;
+		}
+	}
+	else if (m_tile_converged_buffer.get_element_count() > 0)
+	{
+		m_tile_converged_buffer.free();
+
+		m_render_data_buffers_invalidated = true;
+	}
+}
+
+void GPURenderer::internal_update_low_resolution_buffers()
+{
+	if (m_render_data.render_settings.allow_render_low_resolution)
+	{
+		// Sized for the current scaling. The buffer isn't freed when getting out of low
+		// resolution to not reallocate it every time the user starts moving the camera
+		int scaling = m_render_data.render_settings.render_low_resolution_scaling;
+		int element_count = ((m_render_resolution.x + scaling - 1) / scaling) * ((m_render_resolution.y + scaling - 1) / scaling);
+		if (m_low_resolution_framebuffer.get_element_count() != static_cast<size_t>(element_count))
+		{
+			m_low_resolution_framebuffer.resize(element_count);
+
+			m_render_data_buffers_invalidated = true;
+		}
+	}
+	else if (m_low_resolution_framebuffer.get_element_count() > 0)
+	{
+		m_low_resolution_framebuffer.free();
+
+		m_render_data_buffers_invalidated = true;
+	}
+}
+
+void GPURenderer::internal_update_render_grid_resolution()
+{
+	int2 render_grid_resolution = get_render_grid_resolution();
+	if (render_grid_resolution.x == m_render_grid_resolution.x && render_grid_resolution.y == m_render_grid_resolution.y)
+		return;
+
+	// The camera rays pass copies the G-buffer of the last frame into the G-buffer of the
+	// previous frame. Clearing the hits so that the temporal passes find no valid surface there
+	if (m_g_buffer.cameray_ray_hit.get_element_count() > 0)
+		m_g_buffer.cameray_ray_hit.upload_data(std::vector<unsigned char>(m_g_buffer.cameray_ray_hit.get_element_count(), 0));
+	m_render_data.render_settings.restir_di_settings.temporal_pass.temporal_buffer_clear_requested = true;
+
+	m_render_grid_resolution = render_grid_resolution;
+}
+
+void GPURenderer::internal_update_compact_AOV_buffers()
+{
+	if (m_render_data.render_settings.use_compact_AOVs)
+	{
+		if (m_packed_normals_AOV_buffer.get_element_count() == 0 || m_packed_albedo_AOV_buffer.get_element_count() == 0)
+		{
+			m_packed_normals_AOV_buffer.resize(m_render_resolution.x * m_render_resolution.y);
+			m_packed_albedo_AOV_buffer.resize(m_render_resolution.x * m_render_resolution.y);
+
+			m_render_data_buffers_invalidated = true;
+		}
+
+		// The full float AOV buffers are only a transient unpacking target when the AOVs
+		// are compact. Keeping them if something unpacked the AOVs since the last update
+		// (the denoiser or the AOV display views, which unpack every frame) and
+		// freeing them otherwise
+		if (!m_denoiser_AOVs_unpacked_since_last_update)
+		{
+			m_normals_AOV_buffer->free();
+			m_albedo_AOV_buffer->free();
+		}
+		m_denoiser_AOVs_unpacked_since_last_update = false;
+	}
+	else
+	{
+		if (m_packed_normals_AOV_buffer.get_element_count() > 0 || m_packed_albedo_AOV_buffer.get_element_count() > 0)
+			m_render_data_buffers_invalidated = true;
+
+		m_packed_normals_AOV_buffer.free();
+		m_packed_albedo_AOV_buffer.free();
+
+		// The path tracer accumulates directly in the full float buffers
+		if (m_normals_AOV_buffer->get_element_count() != m_render_resolution.x * m_render_resolution.y)
+		{
+			m_normals_AOV_buffer->resize(m_render_resolution.x * m_render_resolution.y);
+			m_albedo_AOV_buffer->resize(m_render_resolution.x * m_render_resolution.y);
+		}
+	}
+}
+
+void GPURenderer::internal_update_material_filter_buffer()
+{
+	if (m_render_data.render_settings.use_partial_material_reset)
+	{
+		if (m_pixels_material_filter_buffer.get_element_count() == 0)
+		{
+			// The filters are cleared by the reset of the render
+			m_pixels_material_filter_buffer.resize(m_render_resolution.x * m_render_resolution.y);
+
+			m_render_data_buffers_invalidated = true;
+		}
+	}
+	else if (m_pixels_material_filter_buffer.get_element_count() > 0)
+	{
+		m_pixels_material_filter_buffer.free();
+
+		m_render_data_buffers_invalidated = true;
+	}
+}
+
 void GPURenderer::internal_update_global_stack_buffer()
 {
 	if (needs_global_bvh_stack_buffer())
@@ -418,6 +603,12 @@ void GPURenderer::render()
 	nb_groups.y = std::ceil(m_render_resolution.y / (float)tile_size_y);
 
 	map_buffers_for_render();
+
+	ColorRGB32F* full_resolution_framebuffer = m_render_data.buffers.pixels;
+	if (m_render_data.render_settings.do_render_low_resolution())
+		// The render passes write in the compact framebuffer of the low
+		// resolution grid, upsampled at the end of the frame
+		m_render_data.buffers.pixels = m_low_resolution_framebuffer.get_device_pointer();
 	
 	oroEventRecord(m_frame_start_event, m_main_stream);
 
@@ -436,6 +627,7 @@ void GPURenderer::render()
 		launch_camera_rays();
 		launch_ReSTIR_DI();
 		launch_path_tracing();
+		launch_tile_convergence();
 
 		m_render_data.render_settings.sample_number++;
 		m_render_data.render_settings.denoiser_AOV_accumulation_counter++;
@@ -444,6 +636,8 @@ void GPURenderer::render()
 		// so we're setting the flag to false (it will be set to true again if we need to reset the render
 		// again)
 		m_render_data.render_settings.need_to_reset = false;
+		// Same for the pixels of the edited materials
+		m_render_data.render_settings.material_reset_filter = 0;
 		// If we had requested a temporal buffers clear, this has be done by this frame so we can
 		// now reset the flag
 		m_render_data.render_settings.restir_di_settings.temporal_pass.temporal_buffer_clear_requested = false;
@@ -452,6 +646,12 @@ void GPURenderer::render()
 		m_previous_frame_camera = m_camera;
 	}
 
+	if (m_render_data.render_settings.do_render_low_resolution())
+	{
+		m_render_data.buffers.pixels = full_resolution_framebuffer;
+		launch_low_resolution_upsampling();
+	}
+
 	// Recording GPU frame time stop timestamp and computing the frame time
 	oroEventRecord(m_frame_stop_event, m_main_stream);
 
@@ -465,10 +665,11 @@ void GPURenderer::render()
 
 void GPURenderer::launch_camera_rays()
 {
-	void* launch_args[] = { &m_render_data, &m_render_resolution };
+	int2 render_grid_resolution = get_render_grid_resolution();
+	void* launch_args[] = { &m_render_data, &render_grid_resolution };
 
 	m_render_data.random_seed = m_rng.xorshift32();
-	m_kernels[GPURenderer::CAMERA_RAYS_KERNEL_ID].launch_asynchronous(8, 8, m_render_resolution.x, m_render_resolution.y, launch_args, m_main_stream);
+	m_kernels[GPURenderer::CAMERA_RAYS_KERNEL_ID].launch_asynchronous(8, 8, render_grid_resolution.x, render_grid_resolution.y, launch_args, m_main_stream);
 }
 
 void GPURenderer::launch_ReSTIR_DI()
@@ -479,10 +680,31 @@ void GPURenderer::launch_ReSTIR_DI()
 
 void GPURenderer::launch_path_tracing()
 {
-	void* launch_args[] = { &m_render_data, &m_render_resolution };
+	int2 render_grid_resolution = get_render_grid_resolution();
+	void* launch_args[] = { &m_render_data, &render_grid_resolution };
 
 	m_render_data.random_seed = m_rng.xorshift32();
-	m_kernels[GPURenderer::PATH_TRACING_KERNEL_ID].launch_asynchronous(8, 8, m_render_resolution.x, m_render_resolution.y, launch_args, m_main_stream);
+	m_kernels[GPURenderer::PATH_TRACING_KERNEL_ID].launch_asynchronous(8, 8, render_grid_resolution.x, render_grid_resolution.y, launch_args, m_main_stream);
+}
+
+void GPURenderer::launch_low_resolution_upsampling()
+{
+	// One thread per pixel of the full resolution framebuffer
+	void* launch_args[] = { &m_render_data, &m_render_resolution };
+
+	m_kernels[GPURenderer::LOW_RESOLUTION_UPSAMPLING_KERNEL_ID].launch_asynchronous(8, 8, m_render_resolution.x, m_render_resolution.y, launch_args, m_main_stream);
+}
+
+void GPURenderer::launch_tile_convergence()
+{
+	if (!m_render_data.render_settings.use_tile_convergence || !m_render_data.render_settings.has_access_to_adaptive_sampling_buffers())
+		return;
+
+	void* launch_args[] = { &m_render_data, &m_render_resolution };
+
+	// One thread per tile
+	int2 tile_count = m_render_data.render_settings.get_convergence_tile_count(m_render_resolution);
+	m_kernels[GPURenderer::TILE_CONVERGENCE_KERNEL_ID].launch_asynchronous(8, 8, tile_count.x, tile_count.y, launch_args, m_main_stream);
 }
 
 void GPURenderer::synchronize_kernel()
@@ -514,6 +736,11 @@ bool GPURenderer::was_last_frame_low_resolution()
 	return m_was_last_frame_low_resolution;
 }
 
+int2 GPURenderer::get_render_grid_resolution()
+{
+	return m_render_data.render_settings.get_render_grid_resolution(m_render_resolution);
+}
+
 void GPURenderer::resize(int new_width, int new_height, bool also_resize_interop)
 {
 	// Needed so that this function can eventually be called from another thread
@@ -536,8 +763,19 @@ void GPURenderer::resize(int new_width, int new_height, bool also_resize_interop
 	{
 		m_pixels_squared_luminance_buffer.resize(new_width * new_height);
 		m_pixels_sample_count_buffer.resize(new_width * new_height);
+		m_pixels_color_sum_buffer.resize(new_width * new_height);
+		m_pixels_odd_color_sum_buffer.resize(new_width * new_height);
+	}
+
+	if (m_render_data.render_settings.use_compact_AOVs)
+	{
+		m_packed_normals_AOV_buffer.resize(new_width * new_height);
+		m_packed_albedo_AOV_buffer.resize(new_width * new_height);
 	}
 
+	if (m_render_data.render_settings.use_partial_material_reset)
+		m_pixels_material_filter_buffer.resize(new_width * new_height);
+
 	if (m_global_compiler_options->get_macro_value(GPUKernelCompilerOptions::DIRECT_LIGHT_SAMPLING_STRATEGY) == LSS_RESTIR_DI)
 		m_restir_di_render_pass.resize(new_width, new_height);
 
@@ -573,8 +811,13 @@ void GPURenderer::resize_interop_buffers(int new_width, int new_height)
 {
 	m_framebuffer->resize(new_width * new_height);
 	m_denoised_framebuffer->resize(new_width * new_height);
-	m_normals_AOV_buffer->resize(new_width * new_height);
-	m_albedo_AOV_buffer->resize(new_width * new_height);
+	if (!m_render_data.render_settings.use_compact_AOVs || m_normals_AOV_buffer->get_element_count() > 0)
+	{
+		// Only resizing the float AOV buffers if they are allocated when the AOVs are compact,
+		// unpack_denoiser_AOVs() allocates them otherwise
+		m_normals_AOV_buffer->resize(new_width * new_height);
+		m_albedo_AOV_buffer->resize(new_width * new_height);
+	}
 
 	if (m_render_data.render_settings.has_access_to_adaptive_sampling_buffers())
 		m_pixels_converged_sample_count_buffer->resize(new_width * new_height);
@@ -583,8 +826,18 @@ void GPURenderer::resize_interop_buffers(int new_width, int new_height)
 void GPURenderer::map_buffers_for_render()
 {
 	m_render_data.buffers.pixels = m_framebuffer->map_no_error();
-	m_render_data.aux_buffers.denoiser_normals = m_normals_AOV_buffer->map_no_error();
-	m_render_data.aux_buffers.denoiser_albedo = m_albedo_AOV_buffer->map_no_error();
+	if (m_render_data.render_settings.use_compact_AOVs)
+	{
+		// The path tracer accumulates in the packed buffers, the float
+		// ones may not even be allocated
+		m_render_data.aux_buffers.denoiser_normals = nullptr;
+		m_render_data.aux_buffers.denoiser_albedo = nullptr;
+	}
+	else
+	{
+		m_render_data.aux_buffers.denoiser_normals = m_normals_AOV_buffer->map_no_error();
+		m_render_data.aux_buffers.denoiser_albedo = m_albedo_AOV_buffer->map_no_error();
+	}
 	if (m_render_data.render_settings.has_access_to_adaptive_sampling_buffers())
 		m_render_data.aux_buffers.pixel_converged_sample_count = m_pixels_converged_sample_count_buffer->map_no_error();
 }
@@ -597,6 +850,35 @@ void GPURenderer::unmap_buffers()
 	m_pixels_converged_sample_count_buffer->unmap();
 }
 
+void GPURenderer::unpack_denoiser_AOVs()
+{
+	if (!m_render_data.render_settings.use_compact_AOVs || m_packed_albedo_AOV_buffer.get_element_count() == 0)
+		return;
+
+	ThreadManager::join_threads(ThreadManager::COMPILE_KERNELS_THREAD_KEY);
+
+	if (m_normals_AOV_buffer->get_element_count() != m_render_resolution.x * m_render_resolution.y)
+	{
+		// The float buffers are freed by internal_update_compact_AOV_buffers()
+		// when nothing unpacked the AOVs for a frame
+		m_normals_AOV_buffer->resize(m_render_resolution.x * m_render_resolution.y);
+		m_albedo_AOV_buffer->resize(m_render_resolution.x * m_render_resolution.y);
+	}
+	m_denoiser_AOVs_unpacked_since_last_update = true;
+
+	m_render_data.aux_buffers.denoiser_normals = m_normals_AOV_buffer->map_no_error();
+	m_render_data.aux_buffers.denoiser_albedo = m_albedo_AOV_buffer->map_no_error();
+
+	void* launch_args[] = { &m_render_data, &m_render_resolution };
+	m_unpack_denoiser_AOVs_kernel.launch_asynchronous(8, 8, m_render_resolution.x, m_render_resolution.y, launch_args, m_main_stream);
+	OROCHI_CHECK_ERROR(oroStreamSynchronize(m_main_stream));
+
+	m_normals_AOV_buffer->unmap();
+	m_albedo_AOV_buffer->unmap();
+	m_render_data.aux_buffers.denoiser_normals = nullptr;
+	m_render_data.aux_buffers.denoiser_albedo = nullptr;
+}
+
 
 std::shared_ptr<OpenGLInteropBuffer<ColorRGB32F>> GPURenderer::get_color_framebuffer()
 {
@@ -742,6 +1024,7 @@ void GPURenderer::recompile_kernels(bool use_cache)
 		m_restir_di_render_pass.recompile(m_hiprt_orochi_ctx, m_func_name_sets, true, use_cache);
 
 	m_ray_volume_state_byte_size_kernel.compile_silent(m_hiprt_orochi_ctx, m_func_name_sets, use_cache);
+	m_unpack_denoiser_AOVs_kernel.compile_silent(m_hiprt_orochi_ctx, m_func_name_sets, use_cache);
 
 	// The main thread is done with the compilation, we can release the other threads
 	// so that they can continue compiling (background compilation of shaders most likely)
@@ -919,6 +1202,10 @@ void GPURenderer::compute_render_pass_times()
 	m_render_pass_times[GPURenderer::CAMERA_RAYS_KERNEL_ID] = m_kernels[GPURenderer::CAMERA_RAYS_KERNEL_ID].get_last_execution_time();
 	m_restir_di_render_pass.compute_render_times(m_render_pass_times);
 	m_render_pass_times[GPURenderer::PATH_TRACING_KERNEL_ID] = m_kernels[GPURenderer::PATH_TRACING_KERNEL_ID].get_last_execution_time();
+	if (m_render_data.render_settings.use_tile_convergence)
+		m_render_pass_times[GPURenderer::TILE_CONVERGENCE_KERNEL_ID] = m_kernels[GPURenderer::TILE_CONVERGENCE_KERNEL_ID].get_last_execution_time();
+	else
+		m_render_pass_times[GPURenderer::TILE_CONVERGENCE_KERNEL_ID] = 0.0f;
 
 	// The total frame time is the sum of every passes
 	float sum = 0.0f;
@@ -948,6 +1235,8 @@ void GPURenderer::update_perf_metrics(std::shared_ptr<PerformanceMetricsComputer
 	perf_metrics->add_value(GPURenderer::CAMERA_RAYS_KERNEL_ID, m_render_pass_times[GPURenderer::CAMERA_RAYS_KERNEL_ID]);
 	m_restir_di_render_pass.update_perf_metrics(perf_metrics);
 	perf_metrics->add_value(GPURenderer::PATH_TRACING_KERNEL_ID, m_render_pass_times[GPURenderer::PATH_TRACING_KERNEL_ID]);
+	if (m_render_data.render_settings.use_tile_convergence)
+		perf_metrics->add_value(GPURenderer::TILE_CONVERGENCE_KERNEL_ID, m_render_pass_times[GPURenderer::TILE_CONVERGENCE_KERNEL_ID]);
 }
 
 void GPURenderer::reset(std::shared_ptr<ApplicationSettings> application_settings)
@@ -991,9 +1280,10 @@ void GPURenderer::update_render_data()
 		m_render_data.buffers.has_vertex_normals = reinterpret_cast<unsigned char*>(m_hiprt_scene.has_vertex_normals.get_device_pointer());
 		m_render_data.buffers.vertex_normals = reinterpret_cast<float3*>(m_hiprt_scene.vertex_normals.get_device_pointer());
 		m_render_data.buffers.material_indices = reinterpret_cast<int*>(m_hiprt_scene.material_indices.get_device_pointer());
-		m_render_data.buffers.materials_buffer = reinterpret_cast<RendererMaterial*>(m_hiprt_scene.materials_buffer.get_device_pointer());
+		m_render_data.buffers.materials_buffer = m_hiprt_scene.get_materials_soa();
 		m_render_data.buffers.emissive_triangles_count = m_hiprt_scene.emissive_triangles_count;
 		m_render_data.buffers.emissive_triangles_indices = reinterpret_cast<int*>(m_hiprt_scene.emissive_triangles_indices.get_device_pointer());
+		m_render_data.buffers.emissive_irradiance_estimate = m_hiprt_scene.emissive_irradiance_estimate;
 
 		m_render_data.bsdfs_data.sheen_ltc_parameters_texture = m_sheen_ltc_params.get_device_texture();
 		m_render_data.bsdfs_data.GGX_conductor_Ess = m_GGX_conductor_Ess.get_device_texture();
@@ -1026,11 +1316,29 @@ void GPURenderer::update_render_data()
 		{
 			m_render_data.aux_buffers.pixel_sample_count = m_pixels_sample_count_buffer.get_device_pointer();
 			m_render_data.aux_buffers.pixel_squared_luminance = m_pixels_squared_luminance_buffer.get_device_pointer();
+			m_render_data.aux_buffers.pixel_color_sum = m_pixels_color_sum_buffer.get_device_pointer();
+			m_render_data.aux_buffers.pixel_odd_color_sum = m_pixels_odd_color_sum_buffer.get_device_pointer();
+		}
+
+		if (m_render_data.render_settings.use_compact_AOVs)
+		{
+			m_render_data.aux_buffers.packed_denoiser_normals = m_packed_normals_AOV_buffer.get_device_pointer();
+			m_render_data.aux_buffers.packed_denoiser_albedo = m_packed_albedo_AOV_buffer.get_device_pointer();
+		}
+		else
+		{
+			m_render_data.aux_buffers.packed_denoiser_normals = nullptr;
+			m_render_data.aux_buffers.packed_denoiser_albedo = nullptr;
 		}
 
 		m_render_data.aux_buffers.pixel_active = m_pixel_active.get_device_pointer();
 		m_render_data.aux_buffers.still_one_ray_active = m_still_one_ray_active_buffer.get_device_pointer();
+		m_render_data.aux_buffers.adaptive_sampling_error_sums = m_adaptive_sampling_error_sums_buffer.get_device_pointer();
 		m_render_data.aux_buffers.stop_noise_threshold_converged_count = reinterpret_cast<AtomicType<unsigned int>*>(m_pixels_converged_count_buffer.get_device_pointer());
+		m_render_data.aux_buffers.tile_converged = m_tile_converged_buffer.get_device_pointer();
+		m_render_data.aux_buffers.pixel_material_filter = m_pixels_material_filter_buffer.get_device_pointer();
+		m_render_data.aux_buffers.low_resolution_pixels = m_low_resolution_framebuffer.get_device_pointer();
+		m_render_data.aux_buffers.converged_tile_count = reinterpret_cast<AtomicType<unsigned int>*>(m_converged_tile_count_buffer.get_device_pointer());
 
 		m_restir_di_render_pass.update_render_data();
 
@@ -1061,19 +1369,21 @@ void GPURenderer::set_hiprt_scene_from_scene(const Scene& scene)
 	// Uploading the materials after the textures have been parsed because texture
 	// parsing can modify the materials (emission of constant textures are stored in the
 	// material directly for example) so we need to wait for the end of texture parsing
-	// to upload the materials
-	ThreadManager::add_dependency(ThreadManager::RENDERER_UPLOAD_MATERIALS, ThreadManager::SCENE_TEXTURES_LOADING_THREAD_KEY);
+	// to upload the materials. The packing of the scalar textures also remaps
+	// the texture indices of the materials
+	ThreadManager::add_dependency(ThreadManager::RENDERER_UPLOAD_MATERIALS, ThreadManager::SCENE_TEXTURES_PACKING_THREAD_KEY);
 	ThreadManager::start_thread(ThreadManager::RENDERER_UPLOAD_MATERIALS, [this, &scene]() {
 		OROCHI_CHECK_ERROR(oroCtxSetCurrent(m_hiprt_orochi_ctx->orochi_ctx));
 
-		m_hiprt_scene.materials_buffer.resize(scene.materials.size());
-		m_hiprt_scene.materials_buffer.upload_data(scene.materials.data());
+		m_hiprt_scene.upload_materials(scene.materials);
+		m_original_materials = scene.materials;
+		m_current_materials = scene.materials;
 
 		m_hiprt_scene.texcoords_buffer.resize(scene.texcoords.size());
 		m_hiprt_scene.texcoords_buffer.upload_data(scene.texcoords.data());
 	});
 
-	ThreadManager::add_dependency(ThreadManager::RENDERER_UPLOAD_TEXTURES, ThreadManager::SCENE_TEXTURES_LOADING_THREAD_KEY);
+	ThreadManager::add_dependency(ThreadManager::RENDERER_UPLOAD_TEXTURES, ThreadManager::SCENE_TEXTURES_PACKING_THREAD_KEY);
 	ThreadManager::start_thread(ThreadManager::RENDERER_UPLOAD_TEXTURES, [this, &scene]() {
 		OROCHI_CHECK_ERROR(oroCtxSetCurrent(m_hiprt_orochi_ctx->orochi_ctx));
 
@@ -1114,6 +1424,7 @@ void GPURenderer::set_hiprt_scene_from_scene(const Scene& scene)
 	ThreadManager::add_dependency(ThreadManager::RENDERER_UPLOAD_EMISSIVE_TRIANGLES, ThreadManager::SCENE_LOADING_PARSE_EMISSIVE_TRIANGLES);
 	ThreadManager::start_thread(ThreadManager::RENDERER_UPLOAD_EMISSIVE_TRIANGLES, [this, &scene]() {
 		m_hiprt_scene.emissive_triangles_count = scene.emissive_triangle_indices.size();
+		m_hiprt_scene.emissive_irradiance_estimate = scene.compute_emissive_irradiance_estimate();
 		if (m_hiprt_scene.emissive_triangles_count > 0)
 		{
 			OROCHI_CHECK_ERROR(oroCtxSetCurrent(m_hiprt_orochi_ctx->orochi_ctx));
@@ -1126,10 +1437,9 @@ void GPURenderer::set_hiprt_scene_from_scene(const Scene& scene)
 
 void GPURenderer::set_scene(const Scene& scene)
 {
+	// The materials are copied by the material upload thread, once their textures are loaded and packed
 	set_hiprt_scene_from_scene(scene);
 
-	m_original_materials = scene.materials;
-	m_current_materials = scene.materials;
 	m_parsed_scene_metadata = scene.metadata;
 }
 
@@ -1163,12 +1473,11 @@ void GPURenderer::set_envmap(const Image32Bit& envmap_image, const std::string&
 #if EnvmapSamplingStrategy == ESS_BINARY_SEARCH
 		m_render_data.world_settings.envmap_cdf = m_envmap.get_orochi_envmap().get_cdf_device_pointer();
 
-		m_render_data.world_settings.alias_table_probas = nullptr;
-		m_render_data.world_settings.alias_table_alias = nullptr;
+		m_render_data.world_settings.alias_table = nullptr;
 #elif EnvmapSamplingStrategy == ESS_ALIAS_TABLE
 		m_render_data.world_settings.envmap_cdf = nullptr;
 
-		m_envmap.get_orochi_envmap().get_alias_table_device_pointers(m_render_data.world_settings.alias_table_probas, m_render_data.world_settings.alias_table_alias);
+		m_render_data.world_settings.alias_table = m_envmap.get_orochi_envmap().get_alias_table_device_pointer();
 #endif
 	});
 }
@@ -1193,10 +1502,43 @@ const std::vector<std::string>& GPURenderer::get_material_names()
 	return m_parsed_scene_metadata.material_names;
 }
 
-void GPURenderer::update_materials(std::vector<RendererMaterial>& materials)
+bool GPURenderer::update_materials(std::vector<RendererMaterial>& materials)
 {
+	HIPRTRenderSettings& render_settings = m_render_data.render_settings;
+
+	// Nothing to reset partially if the render is going to be reset anyways
+	bool partial_reset = render_settings.can_partially_reset_render() && render_settings.sample_number > 0 && !render_settings.need_to_reset;
+	partial_reset &= materials.size() == m_current_materials.size();
+
+	unsigned int edited_materials_filter = 0;
+	for (int material_index = 0; material_index < materials.size() && partial_reset; material_index++)
+	{
+		const RendererMaterial& new_material = materials[material_index];
+		const RendererMaterial& old_material = m_current_materials[material_index];
+		if (new_material.has_same_parameters(old_material))
+			continue;
+
+		// The emissive materials light pixels through light sampling, without being hit by
+		// their paths. The opacity changes the shadow rays of any pixel too
+		if (new_material.is_emissive() || old_material.is_emissive() || new_material.alpha_opacity != old_material.alpha_opacity)
+			partial_reset = false;
+
+		edited_materials_filter |= HIPRTRenderSettings::get_material_filter_bit(material_index);
+	}
+
 	m_current_materials = materials;
-	m_hiprt_scene.materials_buffer.upload_data(materials.data());
+	m_hiprt_scene.upload_materials(materials);
+
+	if (partial_reset)
+	{
+		render_settings.material_reset_filter |= edited_materials_filter;
+
+		// The reset pixels are going to be rendered again. Until the status buffers of the next
+		// frame are read, the render mustn't look converged, it wouldn't render that frame
+		internal_clear_m_status_buffers();
+	}
+
+	return partial_reset;
 }
 
 const std::vector<BoundingBox>& GPURenderer::get_mesh_bounding_boxes()
@@ -41,7 +41,10 @@ public:
 	 */
 	static const std::string CAMERA_RAYS_KERNEL_ID;
 	static const std::string PATH_TRACING_KERNEL_ID;
+	static const std::string TILE_CONVERGENCE_KERNEL_ID;
+	static const std::string LOW_RESOLUTION_UPSAMPLING_KERNEL_ID;
 	static const std::string RAY_VOLUME_STATE_SIZE_KERNEL_ID;
+	static const std::string UNPACK_DENOISER_AOVS_KERNEL_ID;
 
 	// List of compiler options that will be specific to each kernel. We don't want these options
 	// to be synchronized between kernels
@@ -141,6 +144,8 @@ public:
 	void launch_camera_rays();
 	void launch_ReSTIR_DI();
 	void launch_path_tracing();
+	void launch_tile_convergence();
+	void launch_low_resolution_upsampling();
 
 	/**
 	 * Blocking that waits for all the operations queued on
@@ -159,6 +164,12 @@ public:
 	 * False otherwise
 	 */
 	bool was_last_frame_low_resolution();
+	/**
+	 * Resolution of the grid of pixels that the render passes are launched on.
+	 * Smaller than the render resolution when rendering at low resolution.
+	 * See HIPRTRenderSettings::get_render_grid_resolution()
+	 */
+	int2 get_render_grid_resolution();
 
 	/**
 	 * Resizes all the buffers of the renderer to the given new width and height
@@ -190,6 +201,18 @@ public:
 	 */
 	void unmap_buffers();
 
+	/**
+	 * If render_settings.use_compact_AOVs is true, the path tracer accumulates the
+	 * denoiser AOVs in packed 32 bit buffers. This function decodes them into the
+	 * normals / albedo AOV buffers returned by get_denoiser_normals_AOV_buffer() and
+	 * get_denoiser_albedo_AOV_buffer(). Must be called before reading these buffers
+	 * (denoising, displaying the AOVs, ...). The normals / albedo buffers are allocated
+	 * on demand by this function when the AOVs are compact.
+	 *
+	 * Does nothing if the AOVs are not compact
+	 */
+	void unpack_denoiser_AOVs();
+
 	std::shared_ptr<OpenGLInteropBuffer<ColorRGB32F>> get_color_framebuffer();
 	std::shared_ptr<OpenGLInteropBuffer<ColorRGB32F>> get_denoised_framebuffer();
 	std::shared_ptr<OpenGLInteropBuffer<float3>> get_denoiser_normals_AOV_buffer();
@@ -225,7 +248,17 @@ public:
 	const std::vector<RendererMaterial>& get_original_materials();
 	const std::vector<RendererMaterial>& get_current_materials();
 	const std::vector<std::string>& get_material_names();
-	void update_materials(std::vector<RendererMaterial>& materials);
+	/**
+	 * Uploads the given materials.
+	 * 
+	 * Returns true if the accumulation of the pixels whose paths hit the edited materials
+	 * is going to be reset by the next pass (see render_settings.use_partial_material_reset).
+	 * Returns false if the whole render must be reset by the caller.
+	 * 
+	 * A render that was done because its pixels had converged resumes for the reset pixels.
+	 * It stays done if it reached the maximum sample count or render time
+	 */
+	bool update_materials(std::vector<RendererMaterial>& materials);
 
 	const std::vector<BoundingBox>& get_mesh_bounding_boxes();
 	const std::vector<std::string>& get_mesh_names();
@@ -352,6 +385,37 @@ private:
 	 */
 	void internal_update_global_stack_buffer();
 
+	/**
+	 * Allocates/frees the packed denoiser AOV buffers depending on render_settings.use_compact_AOVs.
+	 * The float AOV buffers are freed while the AOVs are compact and nothing unpacks them
+	 */
+	void internal_update_compact_AOV_buffers();
+
+	/**
+	 * Resizes the convergence tiles map to the tile size of the render settings.
+	 * Only allocated if render_settings.use_tile_convergence is true
+	 */
+	void internal_update_tile_convergence_buffers();
+
+	/**
+	 * Allocates/frees the per pixel filters of the materials
+	 * depending on render_settings.use_partial_material_reset
+	 */
+	void internal_update_material_filter_buffer();
+
+	/**
+	 * Allocates/frees the framebuffer of the low resolution rendering
+	 * depending on render_settings.allow_render_low_resolution
+	 */
+	void internal_update_low_resolution_buffers();
+
+	/**
+	 * Invalidates the temporal data of the previous frame (G-buffer of the previous
+	 * frame and ReSTIR DI temporal reservoirs) when the grid of pixels that the render
+	 * passes are launched on changes: that data is indexed with the width of the old grid
+	 */
+	void internal_update_render_grid_resolution();
+
 	//
 	// -------- Functions called by the update() method ---------
 
@@ -366,6 +430,9 @@ private:
 	// If true, the last call to render() rendered a frame where render_settings.render_low_resoltion was true.
 	// False otherwise
 	bool m_was_last_frame_low_resolution = false;
+	// Grid of pixels that the render passes of the last frame were launched on.
+	// See get_render_grid_resolution()
+	int2 m_render_grid_resolution = { 0, 0 };
 	// If true, the buffer pointers of m_render_data will be updated when update() is called.
 	// This boolean is mainly set to true when resizing the renderer since resizing re-creates the 
 	// buffers -> invalidates the pointer -> we need to set them back on render_data
@@ -390,6 +457,14 @@ private:
 	std::shared_ptr<OpenGLInteropBuffer<float3>> m_normals_AOV_buffer;
 	// Albedo G-buffer
 	std::shared_ptr<OpenGLInteropBuffer<ColorRGB32F>>m_albedo_AOV_buffer;
+	// RGB9E5 / octahedral encodings of the AOVs accumulated by the path tracer when
+	// render_settings.use_compact_AOVs is true. Unpacked into the two buffers above
+	// by unpack_denoiser_AOVs()
+	OrochiBuffer<unsigned int> m_packed_normals_AOV_buffer;
+	OrochiBuffer<unsigned int> m_packed_albedo_AOV_buffer;
+	// Whether unpack_denoiser_AOVs() was called since the last update(). The float AOV
+	// buffers are freed by internal_update_compact_AOV_buffers() if this is false
+	bool m_denoiser_AOVs_unpacked_since_last_update = false;
 
 	// G-buffers of the current frame (camera rays hits) and previous frame
 	GPURendererGBuffer m_g_buffer;
@@ -403,6 +478,21 @@ private:
 	// This buffer is necessary because with adaptive sampling, each pixel
 	// can have accumulated a different number of sample
 	OrochiBuffer<int> m_pixels_sample_count_buffer;
+	// Sum of the samples of each pixel. The framebuffer is resolved from this sum
+	// and the sample count of the pixel when adaptive sampling is used
+	OrochiBuffer<ColorRGB32F> m_pixels_color_sum_buffer;
+	// Sum of the odd samples only of each pixel, for the convergence of the tiles
+	OrochiBuffer<ColorRGB32F> m_pixels_odd_color_sum_buffer;
+	// Bloom filter of the materials hit by the paths of each pixel, for resetting only
+	// the pixels of the edited materials. Only allocated if render_settings.use_partial_material_reset is true
+	OrochiBuffer<unsigned int> m_pixels_material_filter_buffer;
+	// Whether or not each convergence tile has converged, see TileConvergence
+	OrochiBuffer<unsigned char> m_tile_converged_buffer;
+	// How many convergence tiles have converged
+	OrochiBuffer<unsigned int> m_converged_tile_count_buffer;
+	// The three sums of the noise of the pixels used in rotation by adaptive
+	// sampling to redistribute the samples of a pass
+	OrochiBuffer<float> m_adaptive_sampling_error_sums_buffer;
 	// A single boolean to indicate whether there is still a ray active in
 	// the kernel or not. Mostly useful when adaptive sampling is on and we
 	// want to know if all pixels have converged or not yet
@@ -413,6 +503,9 @@ private:
 	OrochiBuffer<unsigned int> m_pixels_converged_count_buffer;
 	// Whether or not the pixel at the given index is active and needs more samples
 	OrochiBuffer<unsigned char> m_pixel_active;
+	// Framebuffer of the render passes when rendering at low resolution. Upsampled
+	// into the full resolution framebuffer at the end of the frame
+	OrochiBuffer<ColorRGB32F> m_low_resolution_framebuffer;
 
 	// Structure that holds the values of the one-variable buffers of the renderer.
 	// These values are 'one_ray_active' or 'pixel_converged_count' for example.
@@ -453,6 +546,8 @@ private:
 
 	// Kernel used for retrieving the size of the RayVolumeState structure on the GPU
 	GPUKernel m_ray_volume_state_byte_size_kernel;
+	// Decodes the packed denoiser AOVs, see unpack_denoiser_AOVs()
+	GPUKernel m_unpack_denoiser_AOVs_kernel;
 
 	// Additional functions called on hits when tracing rays (alpha testing for example)
 	std::vector<hiprtFuncNameSet> m_func_name_sets;
@@ -6,7 +6,12 @@
 #include "Renderer/OpenImageDenoiser.h"
 #include "HIPRT-Orochi/OrochiBuffer.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <iostream>
+#include <mutex>
+#include <thread>
 
 OpenImageDenoiser::OpenImageDenoiser()
 {
@@ -43,12 +48,47 @@ void OpenImageDenoiser::resize(int new_width, int new_height)
     m_height = new_height;
 
     m_denoised_buffer = m_device.newBuffer(sizeof(ColorRGB32F) * new_width * new_height, oidn::Storage::Managed);
-    m_input_color_buffer_oidn = m_device.newBuffer(sizeof(ColorRGB32F) * new_width * new_height, oidn::Storage::Managed);
+    if (m_shared_color != nullptr)
+        // Wrapping the host buffer directly, no copy
+        m_input_color_buffer_oidn = m_device.newBuffer(m_shared_color, sizeof(ColorRGB32F) * new_width * new_height);
+    else
+        m_input_color_buffer_oidn = m_device.newBuffer(sizeof(ColorRGB32F) * new_width * new_height, oidn::Storage::Managed);
+}
+
+void OpenImageDenoiser::initialize(bool force_cpu_device)
+{
+    create_device(force_cpu_device);
+}
+
+void OpenImageDenoiser::set_shared_host_buffers(ColorRGB32F* color, float3* normals, ColorRGB32F* albedo)
+{
+    if (!check_valid_state())
+        return;
+
+    if (!m_cpu_device)
+    {
+        g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "Shared host buffers can only be used with a CPU OIDN device. Use initialize(true).");
+
+        return;
+    }
+
+    m_shared_color = color;
+    m_shared_normals = normals;
+    m_shared_albedo = albedo;
 }
 
-void OpenImageDenoiser::initialize()
+void OpenImageDenoiser::set_tiling(int tile_size, int tile_overlap, int parallel_tiles)
 {
-    create_device();
+    m_tile_size = hippt::max(0, tile_size);
+    m_parallel_tiles = hippt::max(1, parallel_tiles);
+    // The overlap must leave at least one pixel of progress between two tiles
+    m_tile_overlap = hippt::clamp(0, hippt::max(0, m_tile_size - 1), tile_overlap);
+}
+
+bool OpenImageDenoiser::is_tiling_enabled()
+{
+    // Only the shared host buffers can be read tile by tile
+    return m_tile_size > 0 && m_shared_color != nullptr;
 }
 
 void OpenImageDenoiser::finalize()
@@ -56,18 +96,36 @@ void OpenImageDenoiser::finalize()
     if (!check_valid_state())
         return;
 
+    if (is_tiling_enabled())
+    {
+        finalize_tiled();
+
+        return;
+    }
+    else
+        m_denoiser_tiles.clear();
+
     m_beauty_filter = m_device.newFilter("RT");
     m_beauty_filter.setImage("color", m_input_color_buffer_oidn, oidn::Format::Float3, m_width, m_height);
     m_beauty_filter.setImage("output", m_denoised_buffer, oidn::Format::Float3, m_width, m_height);
     m_beauty_filter.set("cleanAux", m_denoise_albedo && m_denoise_normals);
     m_beauty_filter.set("hdr", true);
 
+    if (m_use_normals && m_shared_normals != nullptr)
+        m_shared_normals_buffer_oidn = m_device.newBuffer(m_shared_normals, sizeof(float3) * m_width * m_height);
+    else
+        m_shared_normals_buffer_oidn = nullptr;
+
     if (m_use_normals)
     {
-        // Creating the buffers here instead of in resize() because we want the creation/destruction 
-        // to be dynamic in response to ImGui input so we cannot just wait for a window queue_resize event
-        // that would trigger OpenImageDenoiser::queue_resize()
-        m_normals_buffer_denoised_oidn = m_device.newBuffer(sizeof(float3) * m_width * m_height);
+        if (m_shared_normals_buffer_oidn && !m_denoise_normals)
+            // Nothing to prefilter, the beauty filter can read the shared buffer directly
+            m_normals_buffer_denoised_oidn = m_shared_normals_buffer_oidn;
+        else
+            // Creating the buffers here instead of in resize() because we want the creation/destruction 
+            // to be dynamic in response to ImGui input so we cannot just wait for a window queue_resize event
+            // that would trigger OpenImageDenoiser::queue_resize()
+            m_normals_buffer_denoised_oidn = m_device.newBuffer(sizeof(float3) * m_width * m_height);
         
         m_beauty_filter.setImage("normal", m_normals_buffer_denoised_oidn, oidn::Format::Float3, m_width, m_height);
     }
@@ -78,19 +136,30 @@ void OpenImageDenoiser::finalize()
     if (m_denoise_normals && m_use_normals)
     {
         m_normals_filter = m_device.newFilter("RT");
-        m_normals_filter.setImage("normal", m_normals_buffer_denoised_oidn, oidn::Format::Float3, m_width, m_height);
+        // Prefiltering from the shared host buffer if we have one. The GPU path
+        // copies the AOV to the output buffer first and prefilters in place
+        m_normals_filter.setImage("normal", m_shared_normals_buffer_oidn ? m_shared_normals_buffer_oidn : m_normals_buffer_denoised_oidn, oidn::Format::Float3, m_width, m_height);
         m_normals_filter.setImage("output", m_normals_buffer_denoised_oidn, oidn::Format::Float3, m_width, m_height);
         m_normals_filter.commit();
     }
     else
         m_normals_filter = nullptr;
 
+    if (m_use_albedo && m_shared_albedo != nullptr)
+        m_shared_albedo_buffer_oidn = m_device.newBuffer(m_shared_albedo, sizeof(ColorRGB32F) * m_width * m_height);
+    else
+        m_shared_albedo_buffer_oidn = nullptr;
+
     if (m_use_albedo)
     {
-        // Creating the buffers here instead of in resize() because we want the creation/destruction 
-        // to be dynamic in response to ImGui input so we cannot just wait for a window queue_resize event
-        // that would trigger OpenImageDenoiser::queue_resize()
-        m_albedo_buffer_denoised_oidn = m_device.newBuffer(sizeof(ColorRGB32F) * m_width * m_height, oidn::Storage::Managed);
+        if (m_shared_albedo_buffer_oidn && !m_denoise_albedo)
+            // Nothing to prefilter, the beauty filter can read the shared buffer directly
+            m_albedo_buffer_denoised_oidn = m_shared_albedo_buffer_oidn;
+        else
+            // Creating the buffers here instead of in resize() because we want the creation/destruction 
+            // to be dynamic in response to ImGui input so we cannot just wait for a window queue_resize event
+            // that would trigger OpenImageDenoiser::queue_resize()
+            m_albedo_buffer_denoised_oidn = m_device.newBuffer(sizeof(ColorRGB32F) * m_width * m_height, oidn::Storage::Managed);
 
         m_beauty_filter.setImage("albedo", m_albedo_buffer_denoised_oidn, oidn::Format::Float3, m_width, m_height);
     }
@@ -101,7 +170,7 @@ void OpenImageDenoiser::finalize()
     if (m_denoise_albedo && m_use_albedo)
     {
         m_albedo_filter = m_device.newFilter("RT");
-        m_albedo_filter.setImage("albedo", m_albedo_buffer_denoised_oidn, oidn::Format::Float3, m_width, m_height);
+        m_albedo_filter.setImage("albedo", m_shared_albedo_buffer_oidn ? m_shared_albedo_buffer_oidn : m_albedo_buffer_denoised_oidn, oidn::Format::Float3, m_width, m_height);
         m_albedo_filter.setImage("output", m_albedo_buffer_denoised_oidn, oidn::Format::Float3, m_width, m_height);
         m_albedo_filter.commit();
     }
@@ -111,22 +180,26 @@ void OpenImageDenoiser::finalize()
     m_beauty_filter.commit();
 }
 
-void OpenImageDenoiser::create_device()
+void OpenImageDenoiser::create_device(bool force_cpu_device)
 {
-    // Create an Open ImageRGB32F Denoise device on the GPU depending
-    // on whether we're running on an NVIDIA or AMD GPU
-    //
-    // -1 and nullptr correspond respectively to the default CUDA/HIP device
-    // and the default stream
+    if (!force_cpu_device)
+    {
+        // Create an Open ImageRGB32F Denoise device on the GPU depending
+        // on whether we're running on an NVIDIA or AMD GPU
+        //
+        // -1 and nullptr correspond respectively to the default CUDA/HIP device
+        // and the default stream
 #ifdef OROCHI_ENABLE_CUEW
-    m_device = oidn::newDevice(oidn::DeviceType::CUDA);
+        m_device = oidn::newDevice(oidn::DeviceType::CUDA);
 #else
-    m_device = oidn::newDevice(oidn::DeviceType::HIP);
+        m_device = oidn::newDevice(oidn::DeviceType::HIP);
 #endif
+    }
 
-    if (m_device.getError() == oidn::Error::UnsupportedHardware)
+    if (force_cpu_device || m_device.getError() == oidn::Error::UnsupportedHardware)
     {
-        g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_WARNING, "Could not create an OIDN GPU device. Falling back to CPU...");
+        if (!force_cpu_device)
+            g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_WARNING, "Could not create an OIDN GPU device. Falling back to CPU...");
 
         m_device = oidn::newDevice(oidn::DeviceType::CPU);
 
@@ -179,6 +252,13 @@ bool OpenImageDenoiser::check_buffer_sizes()
     size_t denoised_buffer_size = m_denoised_buffer.getSize() / sizeof(ColorRGB32F);
     size_t noisy_input_buffer_size = m_input_color_buffer_oidn.getSize() / sizeof(ColorRGB32F);
 
+    if (is_tiling_enabled())
+    {
+        // The tiled denoising doesn't use the full frame AOVs buffers
+        normals_buffer_size = m_width * m_height;
+        albedo_buffer_size = m_width * m_height;
+    }
+
     if (m_use_normals && normals_buffer_size != m_width * m_height)
     {
         g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "The denoiser normals buffer isn't the same size as the denoiser. Did you forget to call finalize() after a call to resize()?");
@@ -247,3 +327,296 @@ void OpenImageDenoiser::copy_denoised_data_to_buffer(std::shared_ptr<OpenGLInter
     OROCHI_CHECK_ERROR(oroMemcpy(buffer_pointer, m_denoised_buffer.getData(), sizeof(ColorRGB32F) * m_width * m_height, memcpyKind));
     out_buffer->unmap();
 }
+
+void OpenImageDenoiser::denoise_shared_buffers(bool prefilter_aux)
+{
+    if (!check_valid_state())
+        return;
+
+    if (!check_buffer_sizes())
+        return;
+
+    if (m_shared_color == nullptr)
+    {
+        g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "denoise_shared_buffers() called without shared host buffers. Did you forget to call set_shared_host_buffers()?");
+
+        return;
+    }
+
+    if (is_tiling_enabled())
+    {
+        // The prefiltered AOVs only live for the duration of their tile
+        // so they are always prefiltered with the tiled denoising
+        denoise_tiled();
+
+        return;
+    }
+
+    if (prefilter_aux)
+    {
+        if (m_normals_filter)
+            m_normals_filter.execute();
+
+        if (m_albedo_filter)
+            m_albedo_filter.execute();
+    }
+
+    m_beauty_filter.execute();
+
+    const char* error_message;
+    if (m_device.getError(error_message) != oidn::Error::None)
+        g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "Error while denoising: %s", error_message);
+}
+
+void OpenImageDenoiser::blend_denoised_data(const ColorRGB32F* noisy_data, float blend_factor, ColorRGB32F* out_blended)
+{
+    if (!check_valid_state())
+        return;
+
+    int pixel_count = m_width * m_height;
+
+    const ColorRGB32F* denoised_data;
+    std::vector<ColorRGB32F> denoised_data_host;
+    if (m_cpu_device)
+        // The buffers of a CPU device are in host memory, reading them directly
+        denoised_data = reinterpret_cast<const ColorRGB32F*>(m_denoised_buffer.getData());
+    else
+    {
+        denoised_data_host.resize(pixel_count);
+        m_denoised_buffer.read(0, sizeof(ColorRGB32F) * pixel_count, denoised_data_host.data());
+
+        denoised_data = denoised_data_host.data();
+    }
+
+#pragma omp parallel for
+    for (int i = 0; i < pixel_count; i++)
+        out_blended[i] = blend_factor * denoised_data[i] + (1.0f - blend_factor) * noisy_data[i];
+}
+
+void OpenImageDenoiser::finalize_tiled()
+{
+    // The full frame AOVs buffers of the non-tiled denoising aren't needed
+    m_beauty_filter = nullptr;
+    m_albedo_filter = nullptr;
+    m_normals_filter = nullptr;
+    m_normals_buffer_denoised_oidn = nullptr;
+    m_albedo_buffer_denoised_oidn = nullptr;
+
+    m_shared_normals_buffer_oidn = m_use_normals && m_shared_normals != nullptr ? m_device.newBuffer(m_shared_normals, sizeof(float3) * m_width * m_height) : nullptr;
+    m_shared_albedo_buffer_oidn = m_use_albedo && m_shared_albedo != nullptr ? m_device.newBuffer(m_shared_albedo, sizeof(ColorRGB32F) * m_width * m_height) : nullptr;
+
+    // All the tiles have the same size, the tiles at the borders of the
+    // frame are shifted inwards instead of being cropped. This way, the filters
+    // never have to be resized from one tile to the next
+    int tile_width = hippt::min(m_tile_size, m_width);
+    int tile_height = hippt::min(m_tile_size, m_height);
+
+    m_denoiser_tiles.resize(m_parallel_tiles);
+    for (DenoiserTile& tile : m_denoiser_tiles)
+    {
+        tile.output_buffer = m_device.newBuffer(sizeof(ColorRGB32F) * tile_width * tile_height);
+
+        tile.beauty_filter = m_device.newFilter("RT");
+        tile.beauty_filter.setImage("output", tile.output_buffer, oidn::Format::Float3, tile_width, tile_height);
+        tile.beauty_filter.set("cleanAux", m_denoise_albedo && m_denoise_normals);
+        tile.beauty_filter.set("hdr", true);
+
+        if (m_shared_normals_buffer_oidn && m_denoise_normals)
+        {
+            tile.normals_buffer = m_device.newBuffer(sizeof(float3) * tile_width * tile_height);
+
+            tile.normals_filter = m_device.newFilter("RT");
+            tile.normals_filter.setImage("output", tile.normals_buffer, oidn::Format::Float3, tile_width, tile_height);
+            tile.beauty_filter.setImage("normal", tile.normals_buffer, oidn::Format::Float3, tile_width, tile_height);
+        }
+        else
+        {
+            tile.normals_buffer = nullptr;
+            tile.normals_filter = nullptr;
+        }
+
+        if (m_shared_albedo_buffer_oidn && m_denoise_albedo)
+        {
+            tile.albedo_buffer = m_device.newBuffer(sizeof(ColorRGB32F) * tile_width * tile_height);
+
+            tile.albedo_filter = m_device.newFilter("RT");
+            tile.albedo_filter.setImage("output", tile.albedo_buffer, oidn::Format::Float3, tile_width, tile_height);
+            tile.beauty_filter.setImage("albedo", tile.albedo_buffer, oidn::Format::Float3, tile_width, tile_height);
+        }
+        else
+        {
+            tile.albedo_buffer = nullptr;
+            tile.albedo_filter = nullptr;
+        }
+    }
+
+    m_tiles_weights.resize(m_width * m_height);
+}
+
+float OpenImageDenoiser::compute_auto_exposure() const
+{
+    // Same as the autoexposure of OIDN (up to the luminance weights): geometric mean of the
+    // average luminance of blocks of 16x16 pixels, mapped to 0.18
+    const int block_size = 16;
+    const float key = 0.18f;
+    const float epsilon = 1.0e-8f;
+
+    int block_count_x = (m_width + block_size - 1) / block_size;
+    int block_count_y = (m_height + block_size - 1) / block_size;
+
+    double log_luminance_sum = 0.0;
+    int valid_block_count = 0;
+#pragma omp parallel for reduction(+:log_luminance_sum, valid_block_count)
+    for (int block_index = 0; block_index < block_count_x * block_count_y; block_index++)
+    {
+        int start_x = (block_index % block_count_x) * block_size;
+        int start_y = (block_index / block_count_x) * block_size;
+        int stop_x = hippt::min(start_x + block_size, m_width);
+        int stop_y = hippt::min(start_y + block_size, m_height);
+
+        float luminance_sum = 0.0f;
+        for (int y = start_y; y < stop_y; y++)
+            for (int x = start_x; x < stop_x; x++)
+                luminance_sum += m_shared_color[y * m_width + x].luminance();
+
+        float average_luminance = luminance_sum / ((stop_x - start_x) * (stop_y - start_y));
+        if (average_luminance > epsilon)
+        {
+            log_luminance_sum += std::log2(average_luminance);
+            valid_block_count++;
+        }
+    }
+
+    if (valid_block_count == 0)
+        return 1.0f;
+
+    return key / std::exp2(static_cast<float>(log_luminance_sum / valid_block_count));
+}
+
+void OpenImageDenoiser::denoise_tiled()
+{
+    int tile_width = hippt::min(m_tile_size, m_width);
+    int tile_height = hippt::min(m_tile_size, m_height);
+    int tile_overlap = hippt::min(m_tile_overlap, hippt::min(tile_width, tile_height) - 1);
+    int tile_stride_x = tile_width - tile_overlap;
+    int tile_stride_y = tile_height - tile_overlap;
+
+    int tile_count_x = m_width <= tile_width ? 1 : 1 + static_cast<int>(std::ceil((m_width - tile_width) / static_cast<float>(tile_stride_x)));
+    int tile_count_y = m_height <= tile_height ? 1 : 1 + static_cast<int>(std::ceil((m_height - tile_height) / static_cast<float>(tile_stride_y)));
+    int tile_count = tile_count_x * tile_count_y;
+
+    // Shared buffers means CPU device so the output is in host memory
+    ColorRGB32F* denoised_data = reinterpret_cast<ColorRGB32F*>(m_denoised_buffer.getData());
+    std::fill(denoised_data, denoised_data + m_width * m_height, ColorRGB32F(0.0f));
+    std::fill(m_tiles_weights.begin(), m_tiles_weights.end(), 0.0f);
+
+    // Same exposure for all the tiles
+    float input_scale = compute_auto_exposure();
+    for (DenoiserTile& tile : m_denoiser_tiles)
+        tile.beauty_filter.set("inputScale", input_scale);
+
+    std::atomic<int> next_tile_index = 0;
+    std::mutex accumulation_mutex;
+
+    auto denoise_tiles = [&](DenoiserTile& tile) {
+        int tile_index;
+        while ((tile_index = next_tile_index++) < tile_count)
+        {
+            int tile_x = tile_index % tile_count_x;
+            int tile_y = tile_index / tile_count_x;
+            // Shifting the last tiles inwards so that they don't go out of the frame
+            int tile_origin_x = hippt::min(tile_x * tile_stride_x, m_width - tile_width);
+            int tile_origin_y = hippt::min(tile_y * tile_stride_y, m_height - tile_height);
+
+            // The filters read the tile straight from the full frame
+            // shared buffers thanks to the offset & row stride
+            size_t tile_first_pixel = static_cast<size_t>(tile_origin_y) * m_width + tile_origin_x;
+            size_t color_offset = tile_first_pixel * sizeof(ColorRGB32F);
+            size_t normals_offset = tile_first_pixel * sizeof(float3);
+
+            if (m_shared_normals_buffer_oidn)
+            {
+                if (tile.normals_filter)
+                {
+                    tile.normals_filter.setImage("normal", m_shared_normals_buffer_oidn, oidn::Format::Float3, tile_width, tile_height, normals_offset, sizeof(float3), sizeof(float3) * m_width);
+                    tile.normals_filter.commit();
+                    tile.normals_filter.execute();
+                }
+                else
+                    tile.beauty_filter.setImage("normal", m_shared_normals_buffer_oidn, oidn::Format::Float3, tile_width, tile_height, normals_offset, sizeof(float3), sizeof(float3) * m_width);
+            }
+
+            if (m_shared_albedo_buffer_oidn)
+            {
+                if (tile.albedo_filter)
+                {
+                    tile.albedo_filter.setImage("albedo", m_shared_albedo_buffer_oidn, oidn::Format::Float3, tile_width, tile_height, color_offset, sizeof(ColorRGB32F), sizeof(ColorRGB32F) * m_width);
+                    tile.albedo_filter.commit();
+                    tile.albedo_filter.execute();
+                }
+                else
+                    tile.beauty_filter.setImage("albedo", m_shared_albedo_buffer_oidn, oidn::Format::Float3, tile_width, tile_height, color_offset, sizeof(ColorRGB32F), sizeof(ColorRGB32F) * m_width);
+            }
+
+            tile.beauty_filter.setImage("color", m_input_color_buffer_oidn, oidn::Format::Float3, tile_width, tile_height, color_offset, sizeof(ColorRGB32F), sizeof(ColorRGB32F) * m_width);
+            tile.beauty_filter.commit();
+            tile.beauty_filter.execute();
+
+            const ColorRGB32F* tile_output = reinterpret_cast<const ColorRGB32F*>(tile.output_buffer.getData());
+
+            // Feathering the borders of the tile over the overlap region. No feathering on the
+            // borders of the frame since there is no other tile to blend with there
+            bool feather_left = tile_origin_x > 0;
+            bool feather_right = tile_origin_x + tile_width < m_width;
+            bool feather_top = tile_origin_y > 0;
+            bool feather_bottom = tile_origin_y + tile_height < m_height;
+            auto feathering_weight = [tile_overlap](int local_coordinate, int tile_extent, bool feather_low, bool feather_high) {
+                if (tile_overlap == 0)
+                    return 1.0f;
+
+                float weight = 1.0f;
+                if (feather_low)
+                    weight = hippt::min(weight, (local_coordinate + 0.5f) / tile_overlap);
+                if (feather_high)
+                    weight = hippt::min(weight, (tile_extent - local_coordinate - 0.5f) / tile_overlap);
+
+                return weight;
+            };
+
+            std::lock_guard<std::mutex> lock(accumulation_mutex);
+            for (int y = 0; y < tile_height; y++)
+            {
+                float weight_y = feathering_weight(y, tile_height, feather_top, feather_bottom);
+
+                for (int x = 0; x < tile_width; x++)
+                {
+                    float weight = weight_y * feathering_weight(x, tile_width, feather_left, feather_right);
+                    int pixel_index = (tile_origin_y + y) * m_width + tile_origin_x + x;
+
+                    denoised_data[pixel_index] += tile_output[y * tile_width + x] * weight;
+                    m_tiles_weights[pixel_index] += weight;
+                }
+            }
+        }
+    };
+
+    if (m_denoiser_tiles.size() == 1)
+        denoise_tiles(m_denoiser_tiles[0]);
+    else
+    {
+        std::vector<std::thread> tile_threads;
+        for (DenoiserTile& tile : m_denoiser_tiles)
+            tile_threads.emplace_back(denoise_tiles, std::ref(tile));
+        for (std::thread& tile_thread : tile_threads)
+            tile_thread.join();
+    }
+
+#pragma omp parallel for
+    for (int i = 0; i < m_width * m_height; i++)
+        if (m_tiles_weights[i] > 0.0f)
+            denoised_data[i] = denoised_data[i] / m_tiles_weights[i];
+
+    const char* error_message;
+    if (m_device.getError(error_message) != oidn::Error::None)
+        g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "Error while denoising tiles: %s", error_message);
+}
@@ -22,7 +22,48 @@ public:
 	void set_use_normals(bool use_normal);
 	void set_denoise_normals(bool denoise_normals_or_not);
 
-	void initialize();
+	/**
+	 * Creates the OIDN device. A GPU device is used if possible unless
+	 * 'force_cpu_device' is true.
+	 * 
+	 * A CPU device is needed to use shared host buffers (see set_shared_host_buffers())
+	 */
+	void initialize(bool force_cpu_device = false);
+
+	/**
+	 * Makes the denoiser read its inputs directly from the given host buffers instead
+	 * of copying them to its own buffers first. The denoiser must use a CPU device.
+	 * 
+	 * The buffers must stay alive and be at least 'width * height' (as given to resize())
+	 * elements large as long as the denoiser uses them.
+	 * 
+	 * 'normals' and 'albedo' are only read if set_use_normals() / set_use_albedo()
+	 * was called with 'true'. If the denoising of the normals / albedo is enabled,
+	 * the prefiltered AOVs are written to buffers owned by the denoiser, the given
+	 * buffers are never modified.
+	 * 
+	 * This must be called before resize() and finalize()
+	 */
+	void set_shared_host_buffers(ColorRGB32F* color, float3* normals = nullptr, ColorRGB32F* albedo = nullptr);
+
+	/**
+	 * Enables the tiled denoising of the shared host buffers (see set_shared_host_buffers()).
+	 * 
+	 * The frame is denoised in tiles of 'tile_size' * 'tile_size' pixels that overlap each other by
+	 * 'tile_overlap' pixels. The overlapping regions are feathered to hide the seams.
+	 * 
+	 * The filters read the tiles directly from the shared buffers so, apart from the output, the
+	 * memory used by the denoiser only depends on the size of the tiles, not on the size of the frame.
+	 * This is what makes the denoising of very large frames possible.
+	 * 
+	 * 'parallel_tiles' tiles are in flight at the same time, each with its own filters and buffers.
+	 * OIDN serializes the executions on a given device but the feathering/accumulation of a tile then
+	 * overlaps with the filtering of the next one. A CPU device already uses all the cores for one tile
+	 * so 1 or 2 is usually enough.
+	 * 
+	 * A 'tile_size' of 0 disables the tiling. This must be called before finalize()
+	 */
+	void set_tiling(int tile_size, int tile_overlap, int parallel_tiles = 1);
 
 	/**
 	 * Resizes the buffers of this denoiser. Don't forget to call finalize() after calling resize()!
@@ -39,14 +80,44 @@ public:
 	void denoise(std::shared_ptr<OpenGLInteropBuffer<ColorRGB32F>> data_to_denoise, 
 				 std::shared_ptr<OpenGLInteropBuffer<float3>> normals_aov = nullptr, 
 				 std::shared_ptr<OpenGLInteropBuffer<ColorRGB32F>> albedo_aov = nullptr);
+	/**
+	 * Denoises the shared host buffers given to set_shared_host_buffers().
+	 * 
+	 * The AOVs only need to be prefiltered again if they changed since the last call.
+	 * 'prefilter_aux' can be set to false otherwise to only run the beauty filter
+	 */
+	void denoise_shared_buffers(bool prefilter_aux = true);
+
 	/**
 	 * Function used to copy the denoiser result after a call to denoise() to a given buffer
 	 */
 	void copy_denoised_data_to_buffer(std::shared_ptr<OpenGLInteropBuffer<ColorRGB32F>> out_buffer);
 
+	/**
+	 * Blends the result of the last denoising with the given noisy image
+	 * and writes the result in 'out_blended'.
+	 * 
+	 * A blend factor of 1.0f gives only the denoised image, 0.0f only the noisy one.
+	 * 
+	 * This is cheap compared to a denoising so denoising once and blending
+	 * as many times as needed is the way to go for multiple blend factors
+	 */
+	void blend_denoised_data(const ColorRGB32F* noisy_data, float blend_factor, ColorRGB32F* out_blended);
+
 
 private:
-	void create_device();
+	void create_device(bool force_cpu_device);
+
+	bool is_tiling_enabled();
+	void finalize_tiled();
+	void denoise_tiled();
+	/**
+	 * Exposure that OIDN would compute on its own for the full frame in 'm_shared_color'.
+	 *
+	 * Given as the "inputScale" of the filter of every tile so that the tiles
+	 * aren't auto-exposed separately, which gives seams between them
+	 */
+	float compute_auto_exposure() const;
 
 	bool check_valid_state();
 	bool check_device();
@@ -75,6 +146,38 @@ private:
 	oidn::BufferRef m_normals_buffer_denoised_oidn = nullptr;
 	oidn::BufferRef m_albedo_buffer_denoised_oidn = nullptr;
 	oidn::BufferRef m_denoised_buffer;
+
+	// Host buffers given to set_shared_host_buffers(), nullptr if not used
+	ColorRGB32F* m_shared_color = nullptr;
+	float3* m_shared_normals = nullptr;
+	ColorRGB32F* m_shared_albedo = nullptr;
+
+	// OIDN buffers wrapping the shared host normals/albedo buffers
+	oidn::BufferRef m_shared_normals_buffer_oidn = nullptr;
+	oidn::BufferRef m_shared_albedo_buffer_oidn = nullptr;
+
+	// Tiled denoising, see set_tiling()
+	int m_tile_size = 0;
+	int m_tile_overlap = 32;
+	int m_parallel_tiles = 1;
+
+	// Filters and tile-sized buffers of one of the 'm_parallel_tiles'
+	// tiles that can be denoised at the same time
+	struct DenoiserTile
+	{
+		oidn::FilterRef beauty_filter = nullptr;
+		oidn::FilterRef albedo_filter = nullptr;
+		oidn::FilterRef normals_filter = nullptr;
+
+		oidn::BufferRef albedo_buffer = nullptr;
+		oidn::BufferRef normals_buffer = nullptr;
+		oidn::BufferRef output_buffer = nullptr;
+	};
+	std::vector<DenoiserTile> m_denoiser_tiles;
+
+	// Sum of the feathering weights of the tiles that
+	// covered each pixel, for the normalization of the output
+	std::vector<float> m_tiles_weights;
 };
 
 #endif
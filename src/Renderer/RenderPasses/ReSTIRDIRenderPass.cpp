@@ -288,7 +288,7 @@ LightPresamplingParameters ReSTIRDIRenderPass::configure_light_presampling_pass(
 	parameters.triangles_indices = render_data->buffers.triangles_indices;
 	parameters.vertices_positions = render_data->buffers.vertices_positions;
 	parameters.material_indices = render_data->buffers.material_indices;
-	parameters.materials = render_data->buffers.materials_buffer;
+	parameters.materials = render_data->buffers.materials_buffer.hot;
 
 	// World settings for sampling the envmap
 	parameters.world_settings = render_data->world_settings;
@@ -322,8 +322,8 @@ void ReSTIRDIRenderPass::configure_initial_pass()
 
 void ReSTIRDIRenderPass::launch_initial_candidates_pass()
 {
-	int2 render_resolution = m_renderer->m_render_resolution;
-	void* launch_args[] = { &m_renderer->get_render_data(), &m_renderer->m_render_resolution };
+	int2 render_resolution = m_renderer->get_render_grid_resolution();
+	void* launch_args[] = { &m_renderer->get_render_data(), &render_resolution };
 
 	configure_initial_pass();
 	m_kernels[ReSTIRDIRenderPass::RESTIR_DI_INITIAL_CANDIDATES_KERNEL_ID].launch_asynchronous(8, 8, render_resolution.x, render_resolution.y, launch_args, m_renderer->get_main_stream());
@@ -366,7 +366,7 @@ void ReSTIRDIRenderPass::configure_temporal_pass()
 
 void ReSTIRDIRenderPass::launch_temporal_reuse_pass()
 {
-	int2 render_resolution = m_renderer->m_render_resolution;
+	int2 render_resolution = m_renderer->get_render_grid_resolution();
 	void* launch_args[] = { &m_renderer->get_render_data(), &render_resolution };
 
 	configure_temporal_pass();
@@ -456,8 +456,8 @@ void ReSTIRDIRenderPass::configure_spatial_pass_for_fused_spatiotemporal(int spa
 
 void ReSTIRDIRenderPass::launch_spatial_reuse_passes()
 {
-	int2 render_resolution = m_renderer->m_render_resolution;
-	void* launch_args[] = { &m_renderer->get_render_data(), &render_resolution};
+	int2 render_resolution = m_renderer->get_render_grid_resolution();
+	void* launch_args[] = { &m_renderer->get_render_data(), &render_resolution };
 
 	// Emitting an event for timing all the spatial reuse passes combined
 	OROCHI_CHECK_ERROR(oroEventRecord(spatial_reuse_time_start, m_renderer->get_main_stream()));
@@ -483,8 +483,8 @@ void ReSTIRDIRenderPass::configure_spatiotemporal_pass()
 
 void ReSTIRDIRenderPass::launch_spatiotemporal_pass()
 {
-	int2 render_resolution = m_renderer->m_render_resolution;
-	void* launch_args[] = { &m_renderer->get_render_data(), &m_renderer->m_render_resolution };
+	int2 render_resolution = m_renderer->get_render_grid_resolution();
+	void* launch_args[] = { &m_renderer->get_render_data(), &render_resolution };
 
 	configure_spatiotemporal_pass();
 	m_kernels[ReSTIRDIRenderPass::RESTIR_DI_SPATIOTEMPORAL_REUSE_KERNEL_ID].launch_asynchronous(8, 8, render_resolution.x, render_resolution.y, launch_args, m_renderer->get_main_stream());
@@ -6,7 +6,10 @@
 #ifndef RENDERER_ANIMATION_STATE_H
 #define RENDERER_ANIMATION_STATE_H
 
+#include "Utils/Utils.h"
+
 #include <filesystem>
+#include <sstream>
 
 struct RendererAnimationState
 {
@@ -26,6 +29,12 @@ struct RendererAnimationState
 	int frames_rendered_so_far = 0;
 	// How many frames to render for the frame sequence
 	int number_of_animation_frames = 100;
+	// Duration of one frame of a frame sequence in milliseconds.
+	// 
+	// When accumulating, the animations step by that duration per frame instead of by the
+	// time it took to render the last frame: the frame N of a sequence then always
+	// looks the same, whatever the time the renderer took for the frames before it
+	float frame_sequence_frame_time = 1000.0f / 30.0f;
 
 	std::string frames_output_folder = "FrameSequence";
 
@@ -34,6 +43,14 @@ struct RendererAnimationState
 		return frames_output_folder + "/" + std::to_string(frames_rendered_so_far) + ".png";
 	}
 
+	/**
+	 * Time in milliseconds by which the animations should step forward
+	 */
+	float get_animation_step_time(bool accumulating, float last_frame_time) const
+	{
+		return accumulating ? frame_sequence_frame_time : last_frame_time;
+	}
+
 	void ensure_output_folder_exists()
 	{
 		if (!std::filesystem::exists(frames_output_folder)) 
@@ -61,7 +61,7 @@ void RendererEnvmap::do_animation(GPURenderer* renderer)
 
 	if (animate && renderer->get_animation_state().do_animations && can_step_animation)
 	{
-		float renderer_delta_time = renderer->get_last_frame_time();
+		float renderer_delta_time = renderer->get_animation_state().get_animation_step_time(renderer->get_render_settings().accumulate, renderer->get_last_frame_time());
 
 		rotation_X += animation_speed_X / 360.0f / (1000.0f / renderer_delta_time);
 		rotation_Y += animation_speed_Y / 360.0f / (1000.0f / renderer_delta_time);
@@ -113,23 +113,21 @@ void RendererEnvmap::update_renderer(GPURenderer* renderer)
 	{
 		world_settings.envmap_cdf = nullptr;
 
-		world_settings.alias_table_probas = nullptr;
-		world_settings.alias_table_alias = nullptr;
+		world_settings.alias_table = nullptr;
 	}
 	else if (renderer->get_global_compiler_options()->get_macro_value(GPUKernelCompilerOptions::ENVMAP_SAMPLING_STRATEGY) == ESS_BINARY_SEARCH)
 	{
 		world_settings.envmap_cdf = m_orochi_envmap.get_cdf_device_pointer();
 		world_settings.envmap_total_sum = m_orochi_envmap.get_luminance_total_sum();
 
-		world_settings.alias_table_probas = nullptr;
-		world_settings.alias_table_alias = nullptr;
+		world_settings.alias_table = nullptr;
 	}
 	else if (renderer->get_global_compiler_options()->get_macro_value(GPUKernelCompilerOptions::ENVMAP_SAMPLING_STRATEGY) == ESS_ALIAS_TABLE)
 	{
 		world_settings.envmap_cdf = nullptr;
 		world_settings.envmap_total_sum = m_orochi_envmap.get_luminance_total_sum();
 
-		m_orochi_envmap.get_alias_table_device_pointers(world_settings.alias_table_probas, world_settings.alias_table_alias);
+		world_settings.alias_table = m_orochi_envmap.get_alias_table_device_pointer();
 	}
 }
 
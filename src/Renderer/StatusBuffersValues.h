@@ -18,6 +18,10 @@ struct StatusBuffersValues
 	// (according to the adaptive sampling or the
 	// pixel noise threshold for example)
 	unsigned int pixel_converged_count = 0;
+
+	// How many convergence tiles have converged in the image
+	// (if render_settings.use_tile_convergence is true)
+	unsigned int converged_tile_count = 0;
 };
 
 #endif
@@ -116,6 +116,16 @@ void Camera::look_at_object(const BoundingBox& object_bounding_box)
     m_rotation = glm::quat(rot_mat);
 }
 
+void Camera::look_at(const glm::vec3& position, const glm::vec3& target, const glm::vec3& up)
+{
+    // Same as for the camera of the scene files: glm::lookAt gives the world->view
+    // matrix so it's inversed to get the orientation of the camera in world space
+    glm::mat4x4 view_to_world = glm::inverse(glm::lookAt(position, target, up));
+
+    m_translation = position;
+    m_rotation = glm::normalize(glm::quat_cast(glm::mat3x3(view_to_world)));
+}
+
 void Camera::rotate(glm::vec3 rotation_angles_rad)
 {
     glm::quat qx = glm::angleAxis(rotation_angles_rad.x, glm::vec3(1.0f, 0.0f, 0.0f));
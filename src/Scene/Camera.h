@@ -58,6 +58,10 @@ struct Camera
     void zoom(float offset);
 
     void look_at_object(const BoundingBox& object_bounding_box);
+    /**
+     * Places the camera at 'position', looking at 'target'
+     */
+    void look_at(const glm::vec3& position, const glm::vec3& target, const glm::vec3& up = glm::vec3(0.0f, 1.0f, 0.0f));
 
     void rotate(glm::vec3 rotation_angles);
     void rotate(float3 rotation_angles);
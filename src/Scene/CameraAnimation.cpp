@@ -39,7 +39,7 @@ void CameraAnimation::do_rotation_animation(GPURenderer* renderer)
                 // Converting 'm_rotation_value' so that the camera
                 // rotates at such a speed that it will rotate 360.0f
                 // degrees in 'm_rotation_value' seconds
-                rotation_angle_y_deg = 360.0f / m_rotation_value * (renderer->get_last_frame_time() / 1000.0f);
+                rotation_angle_y_deg = 360.0f / m_rotation_value * (renderer->get_animation_state().get_animation_step_time(renderer->get_render_settings().accumulate, renderer->get_last_frame_time()) / 1000.0f);
                 break;
 
             case DEGREES_PER_FRAME:
@@ -52,8 +52,13 @@ void CameraAnimation::do_rotation_animation(GPURenderer* renderer)
                 break;
         }
 
-        float rotation_angle_y_rad = rotation_angle_y_deg / 180.0f * M_PI;
-
-        m_camera->rotate_around_point(m_rotate_around_point, make_float3(0.0f, rotation_angle_y_rad, 0.0f));
+        rotation_step(rotation_angle_y_deg);
     }
 }
+
+void CameraAnimation::rotation_step(float rotation_angle_y_deg)
+{
+    float rotation_angle_y_rad = rotation_angle_y_deg / 180.0f * M_PI;
+
+    m_camera->rotate_around_point(m_rotate_around_point, make_float3(0.0f, rotation_angle_y_rad, 0.0f));
+}
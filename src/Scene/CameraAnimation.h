@@ -20,6 +20,12 @@ public:
 
     void animation_step(GPURenderer* renderer);
     void do_rotation_animation(GPURenderer* renderer);
+    /**
+     * Rotates the camera by 'rotation_angle_y_deg' around the Y axis going
+     * through 'm_rotate_around_point'. Doesn't need a renderer so this is
+     * also used to place the views of a turntable
+     */
+    void rotation_step(float rotation_angle_y_deg);
 
     // Public attributes here because we want them to be
     // easily accessible and having to use getter/setters
@@ -80,6 +80,10 @@ void SceneParser::parse_scene_file(const std::string& scene_filepath, Assimp::Im
     assign_material_texture_indices(parsed_scene.materials, material_texture_indices, texture_indices_offsets);
     dispatch_texture_loading(parsed_scene, scene_filepath, options.nb_texture_threads, texture_paths, material_indices);
 
+    // Packing the scalar maps of the materials together once they are all loaded
+    ThreadManager::add_dependency(ThreadManager::SCENE_TEXTURES_PACKING_THREAD_KEY, ThreadManager::SCENE_TEXTURES_LOADING_THREAD_KEY);
+    ThreadManager::start_thread(ThreadManager::SCENE_TEXTURES_PACKING_THREAD_KEY, ThreadFunctions::pack_scene_scalar_textures, std::ref(parsed_scene));
+
     parse_camera(scene, parsed_scene, options.override_aspect_ratio);
 
     // Used to quickly check whether we've already seen a material based on its
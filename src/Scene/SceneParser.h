@@ -115,6 +115,38 @@ struct Scene
         return sphere;
     }
 
+    /**
+     * Returns the power emitted by the emissive triangles (in luminance) divided by the area of the
+     * whole scene i.e. the average irradiance that a surface of the scene receives directly from the
+     * emissive geometry, occlusion ignored.
+     * 
+     * Emissive textures aren't taken into account
+     */
+    float compute_emissive_irradiance_estimate() const
+    {
+        auto triangle_area = [this](int triangle_index) {
+            float3 vertex_A = vertices_positions[triangle_indices[triangle_index * 3 + 0]];
+            float3 vertex_B = vertices_positions[triangle_indices[triangle_index * 3 + 1]];
+            float3 vertex_C = vertices_positions[triangle_indices[triangle_index * 3 + 2]];
+
+            return hippt::length(hippt::cross(vertex_B - vertex_A, vertex_C - vertex_A)) * 0.5f;
+        };
+
+        double scene_area = 0.0;
+        for (int i = 0; i < triangle_indices.size() / 3; i++)
+            scene_area += triangle_area(i);
+
+        double emitted_power = 0.0;
+        for (int emissive_triangle_index : emissive_triangle_indices)
+            // Exitance of a lambertian emitter is PI * radiance
+            emitted_power += M_PI * materials[material_indices[emissive_triangle_index]].get_emission().luminance() * triangle_area(emissive_triangle_index);
+
+        if (scene_area == 0.0)
+            return 0.0f;
+
+        return static_cast<float>(emitted_power / scene_area);
+    }
+
     std::vector<Triangle> get_triangles()
     {
         std::vector<Triangle> triangles;
@@ -6,7 +6,6 @@
  #version 430
 
 uniform sampler2D u_texture;
-uniform int u_resolution_scaling;
 
 #ifdef COMPUTE_SCREENSHOTER
 uniform layout(binding = 2, rgba8ui) writeonly uimage2D u_output_image;
@@ -27,9 +26,9 @@ void main()
 	if (thread_id.x >= dims.x || thread_id.y >= dims.y)							
 		return;
 
-	uvec4 ucolor = uvec4(texelFetch(u_texture, thread_id / u_resolution_scaling, 0) * 255);
+	uvec4 ucolor = uvec4(texelFetch(u_texture, thread_id, 0) * 255);
 	imageStore(u_output_image, thread_id, ucolor);
 #else
-	out_color = texture(u_texture, vs_tex_coords / u_resolution_scaling);
+	out_color = texture(u_texture, vs_tex_coords);
 #endif
 };
\ No newline at end of file
@@ -16,7 +16,6 @@ uniform sampler2D u_texture_2;
 uniform int u_sample_number_1;
 uniform int u_sample_number_2;
 
-uniform int u_resolution_scaling;
 
 uniform float u_gamma;
 uniform float u_exposure;
@@ -41,11 +40,11 @@ void main()
 	if (thread_id.x >= dims.x || thread_id.y >= dims.y)							
 		return;
 
-	vec4 hdr_color_1 = texelFetch(u_texture_1, thread_id / u_resolution_scaling, 0);
-	vec4 hdr_color_2 = texelFetch(u_texture_2, thread_id / u_resolution_scaling, 0);
+	vec4 hdr_color_1 = texelFetch(u_texture_1, thread_id, 0);
+	vec4 hdr_color_2 = texelFetch(u_texture_2, thread_id, 0);
 #else
-	vec4 hdr_color_1 = texture(u_texture_1, vs_tex_coords / u_resolution_scaling);
-	vec4 hdr_color_2 = texture(u_texture_2, vs_tex_coords / u_resolution_scaling);
+	vec4 hdr_color_1 = texture(u_texture_1, vs_tex_coords);
+	vec4 hdr_color_2 = texture(u_texture_2, vs_tex_coords);
 #endif
 
 	vec4 final_color_1 = hdr_color_1;
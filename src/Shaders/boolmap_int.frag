@@ -8,9 +8,14 @@
 // This is a 'scalar' texture, containing data only in the red channel
 // In this shader, it represents the sample count per pixel
 uniform isampler2D u_texture;
-uniform int u_resolution_scaling;
 uniform float u_threshold_val;
 
+// When the last frame was rendered at low resolution, the buffer of the texture is indexed
+// with the stride of the low resolution grid: the pixel (x, y) of the grid is at the linear
+// index x + y * u_render_grid_width. See HIPRTRenderSettings::get_render_grid_resolution()
+uniform int u_resolution_scaling;
+uniform int u_render_grid_width;
+
 #ifdef COMPUTE_SCREENSHOTER
 uniform layout(binding = 2, rgba8ui) writeonly uimage2D u_output_image;
 #else
@@ -18,6 +23,14 @@ in vec2 vs_tex_coords;
 out vec4 out_color;
 #endif // COMPUTE_SCREENSHOTER
 
+ivec2 get_render_grid_texel(ivec2 pixel, ivec2 dims)
+{
+	ivec2 grid_pixel = pixel / u_resolution_scaling;
+	int linear_index = grid_pixel.x + grid_pixel.y * u_render_grid_width;
+
+	return ivec2(linear_index % dims.x, linear_index / dims.x);
+}
+
 #ifdef COMPUTE_SCREENSHOTER
 layout(local_size_x = 8, local_size_y = 8) in;
 #endif // COMPUTE_SCREENSHOTER
@@ -32,9 +45,12 @@ void main()
 	// We're using abs() here because the sampling count can be negative if 
 	// the pixel isn't being sampled anymore (it has converged and has been 
 	// excluded by the adaptive sampling)
-	float scalar = texelFetch(u_texture, thread_id / u_resolution_scaling, 0).r;
+	float scalar = texelFetch(u_texture, get_render_grid_texel(thread_id, dims), 0).r;
 #else
-	float scalar = texture(u_texture, vs_tex_coords / u_resolution_scaling).r;
+	ivec2 dims = textureSize(u_texture, 0);
+	ivec2 pixel = clamp(ivec2(vs_tex_coords * vec2(dims)), ivec2(0), dims - ivec2(1));
+
+	float scalar = texelFetch(u_texture, get_render_grid_texel(pixel, dims), 0).r;
 #endif
 	
 	vec4 final_color = vec4(0.0f);
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+/**
+ * Unbounded lock-free multiple-producers / single-consumer queue.
+ *
+ * This is the intrusive "stub node" queue from Dmitry Vyukov:
+ *	- Producers only do a single atomic exchange on 'm_head' and then link
+ *	the previous head to their node so pushing never blocks, even if many
+ *	threads are pushing at the same time
+ *	- The consumer walks the list from 'm_tail' and never contends with the
+ *	producers
+ *
+ * 'push()' can be called from any thread. 'try_pop()' must only ever be called
+ * from one thread at a time.
+ *
+ * A push that is in the middle of linking its node (between the exchange and the
+ * store of 'next') makes the queue look empty to the consumer until the link is done.
+ * This is fine for our use case since the consumer will just pick the item up
+ * on its next call to 'try_pop()'
+ */
+template <typename T>
+class MPSCQueue
+{
+public:
+	MPSCQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+
+	~MPSCQueue()
+	{
+		T discarded;
+		while (try_pop(discarded));
+
+		// The last popped node is still acting as the stub of the queue
+		if (m_tail != &m_stub)
+			delete m_tail;
+	}
+
+	MPSCQueue(const MPSCQueue& other) = delete;
+	MPSCQueue& operator=(const MPSCQueue& other) = delete;
+
+	void push(T&& value)
+	{
+		Node* node = new Node(std::move(value));
+
+		Node* previous_head = m_head.exchange(node, std::memory_order_acq_rel);
+		previous_head->next.store(node, std::memory_order_release);
+	}
+
+	/**
+	 * Returns true and moves the oldest item of the queue into 'out_value'
+	 * if the queue wasn't empty. Returns false otherwise
+	 */
+	bool try_pop(T& out_value)
+	{
+		Node* tail = m_tail;
+		Node* next = tail->next.load(std::memory_order_acquire);
+		if (next == nullptr)
+			return false;
+
+		out_value = std::move(next->value);
+
+		// 'next' becomes the new stub node of the queue
+		m_tail = next;
+		if (tail != &m_stub)
+			delete tail;
+
+		return true;
+	}
+
+	bool empty() const
+	{
+		return m_tail->next.load(std::memory_order_acquire) == nullptr;
+	}
+
+private:
+	struct Node
+	{
+		Node() = default;
+		Node(T&& node_value) : value(std::move(node_value)) {}
+
+		std::atomic<Node*> next = nullptr;
+		T value;
+	};
+
+	// Producers side
+	std::atomic<Node*> m_head;
+	// Consumer side, only accessed by the consumer thread
+	Node* m_tail;
+
+	Node m_stub;
+};
+
+#endif
@@ -6,6 +6,11 @@
 #include "Image/Image.h"
 #include "Compiler/GPUKernel.h"
 #include "Threads/ThreadFunctions.h"
+#include "UI/ImGui/ImGuiLogger.h"
+
+#include <unordered_set>
+
+extern ImGuiLogger g_imgui_logger;
 
 void ThreadFunctions::compile_kernel(GPUKernel& kernel, std::shared_ptr<HIPRTOrochiCtx> hiprt_orochi_ctx, const std::vector<hiprtFuncNameSet>& func_name_sets)
 {
@@ -104,6 +109,10 @@ void ThreadFunctions::load_scene_texture(Scene& parsed_scene, std::string scene_
         }
         else
         {
+            if (type == aiTextureType_BASE_COLOR || type == aiTextureType_DIFFUSE)
+                // The alpha of the texture won't have to be read by the filter function if it's opaque
+                parsed_scene.materials[material_indices[thread_index]].base_color_texture_opaque = texture.is_fully_opaque();
+
             // If not emissive texture special case, we can actually read the texture
             parsed_scene.textures_dims[thread_index] = make_int2(texture.width, texture.height);
             parsed_scene.textures[thread_index] = texture;
@@ -113,6 +122,98 @@ void ThreadFunctions::load_scene_texture(Scene& parsed_scene, std::string scene_
     }
 }
 
+void ThreadFunctions::pack_scene_scalar_textures(Scene& parsed_scene)
+{
+    // The renderer only reads the UV set 0 so the maps of a material
+    // can be packed together as long as they have the same resolution
+    int packed_maps_count = 0;
+    int packed_textures_count = 0;
+    for (RendererMaterial& material : parsed_scene.materials)
+    {
+        // Scalar maps of the material that are candidate for packing, in the order
+        // of RendererMaterial::ScalarTextureProperty
+        std::vector<RendererMaterial::ScalarTextureProperty> properties_to_pack;
+        std::unordered_set<int> seen_texture_indices;
+        for (int i = 0; i < RendererMaterial::SCALAR_TEXTURE_PROPERTY_COUNT; i++)
+        {
+            RendererMaterial::ScalarTextureProperty property = static_cast<RendererMaterial::ScalarTextureProperty>(i);
+            int texture_index = material.get_scalar_texture_index(property);
+            if (texture_index < 0 || parsed_scene.textures[texture_index].channels != 1)
+                continue;
+            else if (!seen_texture_indices.insert(texture_index).second)
+                // Not packing a texture that is already used by another property
+                continue;
+
+            properties_to_pack.push_back(property);
+        }
+
+        while (!properties_to_pack.empty())
+        {
+            // Gathering up to 4 maps that have the resolution of the first remaining one
+            int2 dims = parsed_scene.textures_dims[material.get_scalar_texture_index(properties_to_pack.front())];
+
+            std::vector<RendererMaterial::ScalarTextureProperty> pack;
+            for (auto it = properties_to_pack.begin(); it != properties_to_pack.end() && pack.size() < 4;)
+            {
+                int2 property_dims = parsed_scene.textures_dims[material.get_scalar_texture_index(*it)];
+                if (property_dims.x == dims.x && property_dims.y == dims.y)
+                {
+                    pack.push_back(*it);
+                    it = properties_to_pack.erase(it);
+                }
+                else
+                    it++;
+            }
+
+            if (pack.size() == 3)
+            {
+                // 3-channel textures aren't supported on the GPU and an RGBA texture would use more
+                // memory than the 3 separate maps. Packing 2 of them in an RG texture, the third
+                // one stays on its own
+                properties_to_pack.insert(properties_to_pack.begin(), pack.back());
+                pack.pop_back();
+            }
+
+            if (pack.size() == 1)
+                // Nothing to share the texture with
+                continue;
+
+            // The packed texture takes the slot of the first map of the pack.
+            // 2 or 4 channels so that the packed texture uses as much memory as the separate maps
+            int packed_texture_index = material.get_scalar_texture_index(pack.front());
+            int packed_channels = pack.size();
+
+            Image8Bit packed_texture(dims.x, dims.y, packed_channels);
+            std::vector<unsigned char>& packed_data = packed_texture.data();
+            for (int channel = 0; channel < pack.size(); channel++)
+            {
+                int& texture_index = material.get_scalar_texture_index(pack[channel]);
+
+                const std::vector<unsigned char>& scalar_data = parsed_scene.textures[texture_index].data();
+                for (size_t texel = 0; texel < static_cast<size_t>(dims.x) * dims.y; texel++)
+                    packed_data[texel * packed_channels + channel] = scalar_data[texel];
+
+                if (texture_index != packed_texture_index)
+                {
+                    parsed_scene.textures[texture_index].free();
+                    parsed_scene.textures_dims[texture_index] = make_int2(0, 0);
+                }
+
+                texture_index = packed_texture_index;
+                material.set_scalar_texture_channel(pack[channel], channel);
+            }
+
+            parsed_scene.textures[packed_texture_index] = packed_texture;
+
+            packed_maps_count += pack.size();
+            packed_textures_count++;
+        }
+    }
+
+    if (packed_textures_count > 0)
+        g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_INFO, "Packed %d scalar material textures into %d RG/RGBA textures", packed_maps_count, packed_textures_count);
+}
+
 void ThreadFunctions::load_scene_parse_emissive_triangles(const aiScene* scene, Scene& parsed_scene)
 {
     // Looping over all the meshes
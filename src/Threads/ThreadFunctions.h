@@ -17,6 +17,22 @@ public:
 
 	static void load_scene_texture(Scene& parsed_scene, std::string scene_path, const std::vector<std::pair<aiTextureType, std::string>>& tex_paths, const std::vector<int>& material_indices, int thread_index, int nb_threads);
 
+	/**
+	 * Packs the single channel scalar maps (roughness, metallic, specular, coat, ...) of each
+	 * material that have the same resolution into the channels of shared RG or RGBA textures so
+	 * that they can be read with a single fetch. The texture indices and the channels of the packed
+	 * properties are remapped in the materials (see RendererMaterial::ScalarTextureProperty).
+	 *
+	 * Only packs of 2 or 4 maps are made so that the packed textures never use more memory
+	 * than the separate maps. Out of 3 maps of the same resolution, the third one isn't packed.
+	 *
+	 * The texture slots of the maps that have been packed are freed but kept in
+	 * parsed_scene.textures so that the other texture indices don't change.
+	 *
+	 * Must be called once all the textures of the scene are loaded
+	 */
+	static void pack_scene_scalar_textures(Scene& parsed_scene);
+
 	/**
 	 * Frees the memory allocated by the aiScene needed when parsing the scene
 	 */
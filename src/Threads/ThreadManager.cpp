@@ -29,6 +29,7 @@ std::string ThreadManager::RENDERER_PRECOMPILE_KERNELS = "RendererPrecompileKern
 std::string ThreadManager::RESTIR_DI_PRECOMPILE_KERNELS = "ReSTIRDIPrecompileKernel";
 
 std::string ThreadManager::SCENE_TEXTURES_LOADING_THREAD_KEY = "TextureThreadsKey";
+std::string ThreadManager::SCENE_TEXTURES_PACKING_THREAD_KEY = "TexturePackingKey";
 std::string ThreadManager::SCENE_LOADING_PARSE_EMISSIVE_TRIANGLES = "ParseEmissiveTrianglesKey";
 std::string ThreadManager::ENVMAP_LOAD_FROM_DISK_THREAD = "EnvmapLoadThreadsKey";
 
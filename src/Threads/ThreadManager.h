@@ -55,6 +55,7 @@ public:
 	static std::string RESTIR_DI_PRECOMPILE_KERNELS;
 		
 	static std::string SCENE_TEXTURES_LOADING_THREAD_KEY;
+	static std::string SCENE_TEXTURES_PACKING_THREAD_KEY;
 	static std::string SCENE_LOADING_PARSE_EMISSIVE_TRIANGLES;
 	static std::string ENVMAP_LOAD_FROM_DISK_THREAD;
 
@@ -203,8 +203,15 @@ void DisplayViewSystem::update_display_program_uniforms(const DisplayViewSystem*
 	HIPRTRenderSettings render_settings = renderer->get_render_settings();
 	render_settings.sample_number = std::max(1, render_settings.sample_number); 
 
-	bool display_low_resolution = display_view_system->get_render_low_resolution();
-	int render_low_resolution_scaling = display_low_resolution ? render_settings.render_low_resolution_scaling : 1;
+	// The per pixel buffers that aren't upsampled after a low resolution frame (the sample
+	// counts of the pixels for example) are still indexed on the low resolution grid
+	int resolution_scaling = 1;
+	int render_grid_width = renderer->m_render_resolution.x;
+	if (renderer->was_last_frame_low_resolution())
+	{
+		resolution_scaling = render_settings.render_low_resolution_scaling;
+		render_grid_width = renderer->get_render_grid_resolution().x;
+	}
 
 	program->use();
 
@@ -221,7 +228,6 @@ void DisplayViewSystem::update_display_program_uniforms(const DisplayViewSystem*
 		program->set_uniform("u_texture", DisplayViewSystem::DISPLAY_TEXTURE_UNIT_1);
 		program->set_uniform("u_sample_number", sample_number);
 		program->set_uniform("u_do_tonemapping", display_settings.do_tonemapping);
-		program->set_uniform("u_resolution_scaling", render_low_resolution_scaling);
 		program->set_uniform("u_gamma", display_settings.tone_mapping_gamma);
 		program->set_uniform("u_exposure", display_settings.tone_mapping_exposure);
 
@@ -239,7 +245,6 @@ void DisplayViewSystem::update_display_program_uniforms(const DisplayViewSystem*
 		program->set_uniform("u_texture", DisplayViewSystem::DISPLAY_TEXTURE_UNIT_1);
 		program->set_uniform("u_sample_number", sample_number);
 		program->set_uniform("u_do_tonemapping", display_settings.do_tonemapping);
-		program->set_uniform("u_resolution_scaling", render_low_resolution_scaling);
 		program->set_uniform("u_gamma", display_settings.tone_mapping_gamma);
 		program->set_uniform("u_exposure", display_settings.tone_mapping_exposure);
 		program->set_uniform("u_use_low_threshold", display_settings.white_furnace_display_use_low_threshold);
@@ -265,7 +270,6 @@ void DisplayViewSystem::update_display_program_uniforms(const DisplayViewSystem*
 		program->set_uniform("u_sample_number_1", noisy_sample_number);
 		program->set_uniform("u_sample_number_2", denoised_sample_number);
 		program->set_uniform("u_do_tonemapping", display_settings.do_tonemapping);
-		program->set_uniform("u_resolution_scaling", render_low_resolution_scaling);
 		program->set_uniform("u_gamma", display_settings.tone_mapping_gamma);
 		program->set_uniform("u_exposure", display_settings.tone_mapping_exposure);
 
@@ -275,14 +279,12 @@ void DisplayViewSystem::update_display_program_uniforms(const DisplayViewSystem*
 	case DisplayViewType::DISPLAY_ALBEDO:
 	case DisplayViewType::DISPLAY_DENOISED_ALBEDO:
 		program->set_uniform("u_texture", DisplayViewSystem::DISPLAY_TEXTURE_UNIT_1);
-		program->set_uniform("u_resolution_scaling", render_low_resolution_scaling);
 
 		break;
 
 	case DisplayViewType::DISPLAY_NORMALS:
 	case DisplayViewType::DISPLAY_DENOISED_NORMALS:
 		program->set_uniform("u_texture", DisplayViewSystem::DISPLAY_TEXTURE_UNIT_1);
-		program->set_uniform("u_resolution_scaling", render_low_resolution_scaling);
 		program->set_uniform("u_do_tonemapping", display_settings.do_tonemapping);
 		program->set_uniform("u_gamma", display_settings.tone_mapping_gamma);
 		program->set_uniform("u_exposure", display_settings.tone_mapping_exposure);
@@ -301,7 +303,8 @@ void DisplayViewSystem::update_display_program_uniforms(const DisplayViewSystem*
 		float max_val = std::max((float)render_settings.sample_number, min_val);
 
 		program->set_uniform("u_texture", DisplayViewSystem::DISPLAY_TEXTURE_UNIT_1);
-		program->set_uniform("u_resolution_scaling", render_low_resolution_scaling);
+		program->set_uniform("u_resolution_scaling", resolution_scaling);
+		program->set_uniform("u_render_grid_width", render_grid_width);
 		program->set_uniform("u_color_stops", 3, (float*)color_stops.data());
 		program->set_uniform("u_nb_stops", 3);
 		program->set_uniform("u_min_val", min_val);
@@ -318,7 +321,8 @@ void DisplayViewSystem::update_display_program_uniforms(const DisplayViewSystem*
 		float threshold_val = std::max((float)render_settings.sample_number, min_val);
 
 		program->set_uniform("u_texture", DisplayViewSystem::DISPLAY_TEXTURE_UNIT_1);
-		program->set_uniform("u_resolution_scaling", render_low_resolution_scaling);
+		program->set_uniform("u_resolution_scaling", resolution_scaling);
+		program->set_uniform("u_render_grid_width", render_grid_width);
 		program->set_uniform("u_threshold_val", threshold_val);
 		break;
 	}
@@ -345,10 +349,12 @@ void DisplayViewSystem::upload_relevant_buffers_to_texture()
 		break;
 
 	case DisplayViewType::DISPLAY_ALBEDO:
+		m_renderer->unpack_denoiser_AOVs();
 		internal_upload_buffer_to_texture(m_renderer->get_denoiser_albedo_AOV_buffer(), m_display_texture_1, DisplayViewSystem::DISPLAY_TEXTURE_UNIT_1);
 		break;
 
 	case DisplayViewType::DISPLAY_NORMALS:
+		m_renderer->unpack_denoiser_AOVs();
 		internal_upload_buffer_to_texture(m_renderer->get_denoiser_normals_AOV_buffer(), m_display_texture_1, DisplayViewSystem::DISPLAY_TEXTURE_UNIT_1);
 		break;
 
@@ -383,16 +389,6 @@ void DisplayViewSystem::queue_display_view_change(DisplayViewType display_view)
 	m_queued_display_view_change = display_view;
 }
 
-void DisplayViewSystem::set_render_low_resolution(bool low_resolution_or_not)
-{
-	m_displaying_low_resolution = low_resolution_or_not;
-}
-
-bool DisplayViewSystem::get_render_low_resolution() const
-{
-	return m_displaying_low_resolution;
-}
-
 void DisplayViewSystem::resize(int new_render_width, int new_render_height)
 {
 	resize_framebuffer();
@@ -59,13 +59,6 @@ public:
 	 */
 	void queue_display_view_change(DisplayViewType display_view);
 
-	bool get_render_low_resolution() const;
-	/**
-	 * Sets whether or not thje next display() call will display the given texture
-	 * as a low render resolution texture or not
-	 */
-	void set_render_low_resolution(bool low_resolution_or_not);
-
 	void resize(int new_render_width, int new_render_height);
 
 	/**
@@ -123,9 +116,6 @@ private:
 	//		- This is why we need to queue the change so that the texture change is only made when a kernel frame is completed.
 	DisplayViewType m_queued_display_view_change = DisplayViewType::UNDEFINED;
 
-	// Whether or not the DisplayView used is going to be displaying at low resolution or not
-	bool m_displaying_low_resolution = false;
-
 	// Display textures & their display type
 	// 
 	// The display type is the format of the texel of the texture used by the display program.
@@ -106,6 +106,12 @@ void ImGuiAnimationWindow::draw_frame_sequence_rendering_panel()
 		if (ImGui::InputInt("Number of frames to render", &animation_state.number_of_animation_frames))
 			animation_state.reset();
 
+		float frames_per_second = 1000.0f / animation_state.frame_sequence_frame_time;
+		if (ImGui::InputFloat("Frame sequence FPS", &frames_per_second))
+			animation_state.frame_sequence_frame_time = 1000.0f / std::max(1.0f, frames_per_second);
+		ImGuiRenderer::show_help_marker("The animations step by 1 / FPS seconds between two frames of the sequence, "
+										"whatever the time it took to render the frame.");
+
 		ImGui::BeginDisabled(!m_renderer->get_render_settings().accumulate);
 		std::string start_rendering_animation_text = animation_state.is_rendering_frame_sequence ? "Stop rendering frame sequence" : "Start rendering frame sequence";
 		if (ImGui::Button(start_rendering_animation_text.c_str()))
@@ -1,5 +1,18 @@
 #include "UI/ImGui/ImGuiLogger.h"
 
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+// Return address of the current function, i.e. the call site of add_line()
+#define IMGUI_LOGGER_CALL_SITE() _ReturnAddress()
+#else
+#define IMGUI_LOGGER_CALL_SITE() __builtin_return_address(0)
+#endif
+
 ImGuiLogger g_imgui_logger;
 
 const char* ImGuiLogger::BACKGROUND_KERNEL_PARSING_LINE_NAME = "BackgroundKernelParsingLineName";
@@ -8,18 +21,26 @@ const char* ImGuiLogger::BACKGROUND_KERNEL_COMPILATION_LINE_NAME = "BackgroundKe
 ImGuiLogger::ImGuiLogger()
 {
     clear();
+
+    m_consumer_thread = std::thread(&ImGuiLogger::consumer_thread_function, this);
 }
 
 ImGuiLogger::~ImGuiLogger()
 {
     m_destroyed = true;
+    m_stop_consumer = true;
+
+    // The consumer drains the queue one last time before exiting
+    // so that we don't lose the last lines
+    if (m_consumer_thread.joinable())
+        m_consumer_thread.join();
 }
 
 void ImGuiLogger::add_line_with_name(ImGuiLoggerSeverity severity, const char* line_name, const char* fmt, ...)
 {
     va_list args;
     va_start(args, fmt);
-    add_line_internal(severity, line_name, fmt, args);
+    add_line_internal(severity, IMGUI_LOGGER_CALL_SITE(), line_name, fmt, args);
     va_end(args);
 }
 
@@ -27,7 +48,7 @@ void ImGuiLogger::add_line(ImGuiLoggerSeverity severity, const char* fmt, ...)
 {
     va_list args;
     va_start(args, fmt);
-    add_line_internal(severity, nullptr, fmt, args);
+    add_line_internal(severity, IMGUI_LOGGER_CALL_SITE(), nullptr, fmt, args);
     va_end(args);
 }
 
@@ -59,10 +80,14 @@ void ImGuiLogger::draw(const char* title, bool* p_open)
 
     ImGui::Separator();
 
+    if (clear_button)
+        clear();
+
+    // Lines are being added by the consumer thread
+    std::lock_guard<std::mutex> lock(m_lines_mutex);
+
     if (ImGui::BeginChild("scrolling", ImVec2(0, 0), ImGuiChildFlags_None, ImGuiWindowFlags_HorizontalScrollbar))
     {
-        if (clear_button)
-            clear();
         if (copy)
             ImGui::LogToClipboard();
         if (m_log_lines.size() == 0)
@@ -147,6 +172,8 @@ void ImGuiLogger::draw(const char* title, bool* p_open)
 
 void ImGuiLogger::clear()
 {
+    std::lock_guard<std::mutex> lock(m_lines_mutex);
+
     m_log_lines.clear();
     m_actual_lines.clear();
     m_index_in_actual_lines.clear();
@@ -157,41 +184,21 @@ void ImGuiLogger::clear()
 
 void ImGuiLogger::update_line(const char* line_name, const char* fmt, ...)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-
     if (m_destroyed)
         return;
 
-    auto find = m_names_to_lines.find(line_name);
-    if (find == m_names_to_lines.end())
-    {
-        add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_ERROR, "Cannot update line with name %s. There is no such line. Did you forget to call add_line(severity, LINE_NAME, ...)?", line_name);
-        return;
-    }
-
-    std::shared_ptr<ImGuiLoggerLine> line = find->second;
-    std::string prefix = ImGuiLogger::get_severity_prefix(line->severity);
+    ImGuiLoggerMessage message;
+    message.type = IMGUI_LOGGER_MESSAGE_UPDATE_LINE;
+    message.line_name = line_name;
 
+    // The severity prefix is only known by the consumer thread
+    // which is the one that knows the line being updated
     va_list args;
     va_start(args, fmt);
-    std::string formatted_string = prefix + compute_formatted_string(fmt, args) + "\n";
+    message.string = compute_formatted_string("", fmt, args);
     va_end(args);
 
-    // Updating the line
-    line->string = formatted_string;
-
-    // Updating the actual lines
-    int nb_actual_lines_before_update = m_actual_lines[m_index_in_actual_lines[line]].size();
-    compute_actual_lines(line);
-
-    // Updating a line invalidates the cache if the number of actual lines
-    // changed
-    int nb_actual_lines_after_update = m_actual_lines[m_index_in_actual_lines[line]].size();
-    if (nb_actual_lines_before_update != nb_actual_lines_after_update)
-        m_index_to_line_cache.clear();
-
-    m_total_number_of_lines -= nb_actual_lines_before_update;
-    m_total_number_of_lines += nb_actual_lines_after_update;
+    m_message_queue.push(std::move(message));
 }
 
 ImU32 ImGuiLogger::get_severity_color(ImGuiLoggerSeverity severity)
@@ -212,7 +219,7 @@ ImU32 ImGuiLogger::get_severity_color(ImGuiLoggerSeverity severity)
     }
 }
 
-std::string ImGuiLogger::get_severity_prefix(ImGuiLoggerSeverity severity)
+const char* ImGuiLogger::get_severity_prefix(ImGuiLoggerSeverity severity)
 {
     switch (severity)
     {
@@ -230,26 +237,218 @@ std::string ImGuiLogger::get_severity_prefix(ImGuiLoggerSeverity severity)
     }
 }
 
-void ImGuiLogger::add_line_internal(ImGuiLoggerSeverity severity, const char* line_name, const char* fmt, va_list args)
+void ImGuiLogger::add_line_internal(ImGuiLoggerSeverity severity, const void* call_site, const char* line_name, const char* fmt, va_list args)
+{
+    if (m_destroyed)
+        return;
+
+    // Named lines are meant to be updated later so they are never rate limited
+    RateLimiterSlot* claimed_slot = nullptr;
+    if (line_name == nullptr && rate_limit(call_site, claimed_slot))
+        return;
+
+    ImGuiLoggerMessage message;
+    message.type = IMGUI_LOGGER_MESSAGE_ADD_LINE;
+    message.severity = severity;
+    message.line_name = line_name;
+    message.string = compute_formatted_string(ImGuiLogger::get_severity_prefix(severity), fmt, args);
+
+    if (claimed_slot != nullptr)
+    {
+        std::lock_guard<std::mutex> lock(m_rate_limiter_slots_mutex);
+        claimed_slot->first_message = message.string;
+    }
+
+    if (severity == IMGUI_LOGGER_ERROR)
+    {
+        // Errors are printed right away, the caller may break
+        // into the debugger before the consumer thread runs
+        std::lock_guard<std::mutex> lock(m_stdout_mutex);
+        std::cout << message.string << std::flush;
+
+        message.already_printed = true;
+    }
+
+    m_message_queue.push(std::move(message));
+}
+
+bool ImGuiLogger::rate_limit(const void* call_site, RateLimiterSlot*& claimed_slot)
+{
+    claimed_slot = nullptr;
+
+    // Fibonacci hashing of the address of the call site
+    std::uint64_t hash = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(call_site)) * 11400714819323198485ull;
+    RateLimiterSlot& slot = m_rate_limiter_slots[hash >> 56];
+
+    const void* slot_call_site = slot.call_site.load(std::memory_order_relaxed);
+    if (slot_call_site == nullptr)
+    {
+        // Under the lock so that the consumer thread doesn't free the slot while we claim it
+        std::lock_guard<std::mutex> lock(m_rate_limiter_slots_mutex);
+
+        slot_call_site = slot.call_site.load(std::memory_order_relaxed);
+        if (slot_call_site == nullptr)
+        {
+            slot.call_site.store(call_site, std::memory_order_relaxed);
+            slot.lines_in_window.store(0, std::memory_order_relaxed);
+            slot.dropped_lines.store(0, std::memory_order_relaxed);
+
+            slot_call_site = call_site;
+            claimed_slot = &slot;
+        }
+    }
+
+    if (slot_call_site != call_site)
+        // The slot is already used by another call site, not rate limiting this one
+        return false;
+
+    if (slot.lines_in_window.fetch_add(1, std::memory_order_relaxed) < ImGuiLogger::RATE_LIMIT_MAX_LINES_PER_WINDOW)
+        return false;
+
+    slot.dropped_lines.fetch_add(1, std::memory_order_relaxed);
+
+    return true;
+}
+
+void ImGuiLogger::reset_rate_limiter_window()
+{
+    std::lock_guard<std::mutex> lock(m_rate_limiter_slots_mutex);
+
+    for (RateLimiterSlot& slot : m_rate_limiter_slots)
+    {
+        if (slot.call_site.load(std::memory_order_relaxed) == nullptr)
+            continue;
+
+        unsigned int dropped_lines = slot.dropped_lines.exchange(0, std::memory_order_relaxed);
+        unsigned int lines_in_window = slot.lines_in_window.exchange(0, std::memory_order_relaxed);
+
+        if (dropped_lines > 0)
+        {
+            // The first message already ends with its '\n'
+            std::string first_message = slot.first_message;
+            if (!first_message.empty() && first_message.back() == '\n')
+                first_message.pop_back();
+
+            // Not going through add_line() so that the summary isn't rate limited itself
+            ImGuiLoggerMessage summary;
+            summary.severity = IMGUI_LOGGER_WARNING;
+            summary.string = std::string(ImGuiLogger::get_severity_prefix(IMGUI_LOGGER_WARNING)) 
+                + std::to_string(dropped_lines) + " lines dropped in the last " + std::to_string(ImGuiLogger::RATE_LIMIT_WINDOW_MS) 
+                + "ms, logged from the same place as: \"" + first_message + "\"\n";
+
+            consume_add_line(summary);
+        }
+        else if (lines_in_window == 0)
+        {
+            // Nothing logged from that call site during the whole window, giving the slot back
+            slot.call_site.store(nullptr, std::memory_order_relaxed);
+            slot.first_message.clear();
+        }
+    }
+}
+
+void ImGuiLogger::consumer_thread_function()
+{
+    auto window_start = std::chrono::steady_clock::now();
+
+    while (!m_stop_consumer)
+    {
+        bool consumed_something = consume_messages();
+
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - window_start).count() >= ImGuiLogger::RATE_LIMIT_WINDOW_MS)
+        {
+            reset_rate_limiter_window();
+
+            window_start = now;
+        }
+
+        if (!consumed_something)
+            std::this_thread::sleep_for(std::chrono::milliseconds(ImGuiLogger::CONSUMER_POLL_INTERVAL_MS));
+    }
+
+    // Last lines that may have been pushed before the logger was destroyed
+    consume_messages();
+    reset_rate_limiter_window();
+}
+
+bool ImGuiLogger::consume_messages()
+{
+    bool consumed_something = false;
+
+    ImGuiLoggerMessage message;
+    while (m_message_queue.try_pop(message))
+    {
+        if (message.type == IMGUI_LOGGER_MESSAGE_ADD_LINE)
+            consume_add_line(message);
+        else
+            consume_update_line(message);
+
+        consumed_something = true;
+    }
+
+    return consumed_something;
+}
+
+void ImGuiLogger::consume_add_line(ImGuiLoggerMessage& message)
 {
-    // For logger's thread safety
-    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!message.already_printed)
+    {
+        // Also printing to the console
+        std::lock_guard<std::mutex> stdout_lock(m_stdout_mutex);
+        std::cout << message.string;
+    }
 
-    std::string prefix = ImGuiLogger::get_severity_prefix(severity);
-    std::string formatted_string = prefix + compute_formatted_string(fmt, args) + "\n";
-    std::cout << formatted_string; // Also printing to the console
+    std::lock_guard<std::mutex> lock(m_lines_mutex);
 
     int line_index = m_log_lines.size();
 
-    std::shared_ptr<ImGuiLoggerLine> logger_line = std::make_shared<ImGuiLoggerLine>(formatted_string, severity);
+    std::shared_ptr<ImGuiLoggerLine> logger_line = std::make_shared<ImGuiLoggerLine>(std::move(message.string), message.severity);
     m_log_lines.push_back(logger_line);
     m_index_in_actual_lines[logger_line] = line_index;
 
     compute_actual_lines(logger_line);
     m_total_number_of_lines += m_actual_lines[line_index].size();
 
-    if (line_name != nullptr)
-        set_line_name(logger_line, line_name);
+    if (message.line_name != nullptr)
+        set_line_name(logger_line, message.line_name);
+}
+
+void ImGuiLogger::consume_update_line(ImGuiLoggerMessage& message)
+{
+    std::unique_lock<std::mutex> lock(m_lines_mutex);
+
+    auto find = m_names_to_lines.find(message.line_name);
+    if (find == m_names_to_lines.end())
+    {
+        lock.unlock();
+
+        ImGuiLoggerMessage error_message;
+        error_message.severity = IMGUI_LOGGER_ERROR;
+        error_message.string = std::string(ImGuiLogger::get_severity_prefix(IMGUI_LOGGER_ERROR)) 
+            + "Cannot update line with name " + message.line_name + ". There is no such line. Did you forget to call add_line(severity, LINE_NAME, ...)?\n";
+        consume_add_line(error_message);
+
+        return;
+    }
+
+    std::shared_ptr<ImGuiLoggerLine> line = find->second;
+
+    // Updating the line
+    line->string = std::string(ImGuiLogger::get_severity_prefix(line->severity)) + message.string;
+
+    // Updating the actual lines
+    int nb_actual_lines_before_update = m_actual_lines[m_index_in_actual_lines[line]].size();
+    compute_actual_lines(line);
+
+    // Updating a line invalidates the cache if the number of actual lines
+    // changed
+    int nb_actual_lines_after_update = m_actual_lines[m_index_in_actual_lines[line]].size();
+    if (nb_actual_lines_before_update != nb_actual_lines_after_update)
+        m_index_to_line_cache.clear();
+
+    m_total_number_of_lines -= nb_actual_lines_before_update;
+    m_total_number_of_lines += nb_actual_lines_after_update;
 }
 
 void ImGuiLogger::set_line_name(std::shared_ptr<ImGuiLoggerLine> line, const char* line_name)
@@ -257,23 +456,35 @@ void ImGuiLogger::set_line_name(std::shared_ptr<ImGuiLoggerLine> line, const cha
     m_names_to_lines[line_name] = line;
 }
 
-std::string ImGuiLogger::compute_formatted_string(const char* fmt, va_list args)
+std::string ImGuiLogger::compute_formatted_string(const char* prefix, const char* fmt, va_list args)
 {
+    // Each thread formats in its own buffer so formatting
+    // never needs to be synchronized
+    thread_local std::vector<char> string_buffer(256);
+
     // Copying the arg list because the first call to vsnprintf modifies args
     // and so if we use args again in the second call to vsnprintf, we're going
     // to get garbage in the formatted output 
     va_list args_copy;
     va_copy(args_copy, args);
-
-    // Calculating formatted string length by calling with NULL. + 1 for the '\0'
-    int string_length = vsnprintf(NULL, 0, fmt, args_copy) + 1;
-
+    // + 1 for the '\0'
+    int string_length = vsnprintf(string_buffer.data(), string_buffer.size(), fmt, args_copy) + 1;
     va_end(args_copy);
 
-    std::vector<char> string_buffer(string_length);
-    vsnprintf(string_buffer.data(), string_length, fmt, args);
+    if (string_length > string_buffer.size())
+    {
+        // The buffer wasn't large enough, growing it and formatting again
+        string_buffer.resize(string_length);
+        vsnprintf(string_buffer.data(), string_length, fmt, args);
+    }
+
+    std::string formatted_string;
+    formatted_string.reserve(strlen(prefix) + string_length);
+    formatted_string.append(prefix);
+    formatted_string.append(string_buffer.data(), string_length - 1);
+    formatted_string.push_back('\n');
 
-    return std::string(string_buffer.data());
+    return formatted_string;
 }
 
 void ImGuiLogger::compute_actual_lines(std::shared_ptr<ImGuiLoggerLine> logger_line)
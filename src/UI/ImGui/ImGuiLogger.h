@@ -6,21 +6,43 @@
 #ifndef IMGUI_LOGGER_H
 #define IMGUI_LOGGER_H
 
-#include "UI/ImGui/ImGuiLoggerSeverity.h"
+#include "Threads/MPSCQueue.h"
 #include "UI/ImGui/ImGuiLoggerLine.h"
+#include "UI/ImGui/ImGuiLoggerMessage.h"
+#include "UI/ImGui/ImGuiLoggerSeverity.h"
 
 #include "imgui.h"
 
+#include <array>
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
 /**
  * Class derived from imgui_demo.cpp "ExampleAppLog"
+ * 
+ * Adding/updating lines never takes a lock in the common case: the calling thread formats
+ * the line in a thread-local buffer and pushes it in a lock-free queue.
+ * A single consumer thread owned by the logger then pops the lines, prints them
+ * to stdout and stores them for the ImGui window.
+ * 
+ * Unnamed lines that are logged from the same call site too often (more than
+ * RATE_LIMIT_MAX_LINES_PER_WINDOW per RATE_LIMIT_WINDOW_MS) are dropped, whatever their
+ * severity, and a summary line with the number of dropped lines is logged instead.
+ * This is mainly for per-pixel messages of the CPU renderer (NaNs, invalid reservoirs, ...).
+ * The call sites that log nothing during a whole window give their rate limiter slot back.
+ * 
+ * Error lines that aren't dropped are printed to stdout synchronously by the thread that logs
+ * them: they are often followed by a debugbreak() that would stop the program before the
+ * consumer thread gets to print them
  */
 
 class ImGuiLogger
@@ -42,17 +64,77 @@ public:
 
     static ImU32 get_severity_color(ImGuiLoggerSeverity severity);
 
+    static constexpr unsigned int RATE_LIMIT_MAX_LINES_PER_WINDOW = 16;
+    static constexpr int RATE_LIMIT_WINDOW_MS = 1000;
+    // How long the consumer thread sleeps when there's nothing in the queue
+    static constexpr int CONSUMER_POLL_INTERVAL_MS = 5;
+
 private:
-    void add_line_internal(ImGuiLoggerSeverity severity, const char* line_name, const char* fmt, va_list args);
+    struct RateLimiterSlot
+    {
+        // Return address of the call to add_line() that owns this slot. nullptr if the slot is free
+        std::atomic<const void*> call_site = nullptr;
+        std::atomic<unsigned int> lines_in_window = 0;
+        std::atomic<unsigned int> dropped_lines = 0;
+
+        // First line logged from the call site, quoted in the summary of the
+        // dropped lines. Protected by m_rate_limiter_slots_mutex
+        std::string first_message;
+    };
+
+    static constexpr int RATE_LIMITER_SLOT_COUNT = 256;
+
+    void add_line_internal(ImGuiLoggerSeverity severity, const void* call_site, const char* line_name, const char* fmt, va_list args);
+
+    /**
+     * Returns true if a line logged from the given call site should be dropped
+     * because too many lines were logged from that call site recently.
+     * 
+     * 'claimed_slot' is set to the slot of the call site if this call claimed it, nullptr otherwise
+     */
+    bool rate_limit(const void* call_site, RateLimiterSlot*& claimed_slot);
+    /**
+     * Logs the number of lines that were dropped during the last window, resets
+     * the windows of all the rate limiter slots and frees the slots of the call
+     * sites that didn't log anything during the last window
+     */
+    void reset_rate_limiter_window();
+
+    void consumer_thread_function();
+    /**
+     * Pops everything there is in the queue and returns true
+     * if at least one message was consumed
+     */
+    bool consume_messages();
+    void consume_add_line(ImGuiLoggerMessage& message);
+    void consume_update_line(ImGuiLoggerMessage& message);
 
     void set_line_name(std::shared_ptr<ImGuiLoggerLine> line, const char* line_name);
 
-    std::string compute_formatted_string(const char* fmt, va_list args);
+    /**
+     * Formats in a thread-local buffer that is reused across calls
+     * so that formatting doesn't allocate in the common case
+     */
+    static std::string compute_formatted_string(const char* prefix, const char* fmt, va_list args);
     void compute_actual_lines(std::shared_ptr<ImGuiLoggerLine> logger_line);
 
     std::pair<std::shared_ptr<ImGuiLoggerLine>, std::string_view*> get_line_from_index(int index);
 
-    static std::string get_severity_prefix(ImGuiLoggerSeverity severity);
+    static const char* get_severity_prefix(ImGuiLoggerSeverity severity);
+
+    MPSCQueue<ImGuiLoggerMessage> m_message_queue;
+    std::array<RateLimiterSlot, RATE_LIMITER_SLOT_COUNT> m_rate_limiter_slots;
+
+    // Only taken to claim or free a rate limiter slot, not when
+    // a call site that already has its slot logs a line
+    std::mutex m_rate_limiter_slots_mutex;
+
+    // Serializes the writes to stdout of the consumer thread and of
+    // the threads that print their error lines synchronously
+    std::mutex m_stdout_mutex;
+
+    std::thread m_consumer_thread;
+    std::atomic<bool> m_stop_consumer = false;
 
     // Each time you call add_log(), one entry is added in there with the whole text
     // and severity.
@@ -88,12 +170,13 @@ private:
 
     bool m_auto_scroll = true;  // Keep scrolling if already at the bottom.
 
-    // For logger thread safety
-    std::mutex m_mutex;
+    // Protects the lines above. Only contended by the consumer thread and
+    // the thread drawing the logger, never by the threads adding lines
+    std::mutex m_lines_mutex;
 
     // Used for threads that may still want to access this logger after
     // it's been destroyed by another thread
-    bool m_destroyed = false;
+    std::atomic<bool> m_destroyed = false;
 };
 
 #endif
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+#ifndef IMGUI_LOGGER_MESSAGE_H
+#define IMGUI_LOGGER_MESSAGE_H
+
+#include "UI/ImGui/ImGuiLoggerSeverity.h"
+
+#include <string>
+
+enum ImGuiLoggerMessageType
+{
+    IMGUI_LOGGER_MESSAGE_ADD_LINE,
+    IMGUI_LOGGER_MESSAGE_UPDATE_LINE
+};
+
+/**
+ * What producer threads push in the logger queue.
+ *
+ * The string is already formatted (and prefixed with the severity) by the
+ * producer thread so that the consumer thread only has to store it / print it
+ */
+struct ImGuiLoggerMessage
+{
+    ImGuiLoggerMessageType type = IMGUI_LOGGER_MESSAGE_ADD_LINE;
+    ImGuiLoggerSeverity severity = IMGUI_LOGGER_INFO;
+
+    // nullptr if the line isn't named
+    const char* line_name = nullptr;
+    std::string string;
+
+    // Error lines are printed to stdout by the producer thread itself,
+    // the consumer thread then only stores them for the ImGui window
+    bool already_printed = false;
+};
+
+#endif
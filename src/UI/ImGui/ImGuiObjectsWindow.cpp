@@ -521,7 +521,7 @@ void ImGuiObjectsWindow::draw_global_objects_panel()
 
 				case 7:
 					ImGui::BeginDisabled(kernel_options->get_macro_value(GPUKernelCompilerOptions::INTERIOR_STACK_STRATEGY) != ISS_WITH_PRIORITIES);
-					material_override_changed |= draw_material_override_line("Dielectric priority", override_state.override_dielectric_priority, material_override.dielectric_priority, 1, StackPriorityEntry::PRIORITY_MAXIMUM);
+					material_override_changed |= draw_material_override_line("Dielectric priority", override_state.override_dielectric_priority, material_override.dielectric_priority, 1, StackEntry::PRIORITY_MAXIMUM);
 					if (kernel_options->get_macro_value(GPUKernelCompilerOptions::INTERIOR_STACK_STRATEGY) != ISS_WITH_PRIORITIES)
 						ImGuiRenderer::show_help_marker("Disabled because not using nested dielectrics with priorities.");
 					ImGui::EndDisabled();
@@ -795,8 +795,10 @@ void ImGuiObjectsWindow::draw_global_objects_panel()
 		apply_material_override(override_state.override_strong_energy_conservation, &SimplifiedRendererMaterial::enforce_strong_energy_conservation, material_override.enforce_strong_energy_conservation, overriden_materials);
 		apply_material_override(override_state.override_energy_conservation_samples, &SimplifiedRendererMaterial::energy_preservation_monte_carlo_samples, material_override.energy_preservation_monte_carlo_samples, overriden_materials);
 
-		m_renderer->update_materials(overriden_materials);
-		m_render_window->set_render_dirty(true);
+		// A partial reset resumes a render that had converged. It is still done here only if it reached
+		// its maximum sample count or render time, the reset pixels wouldn't get any sample
+		if (!m_renderer->update_materials(overriden_materials) || m_render_window->is_rendering_done())
+			m_render_window->set_render_dirty(true);
 	}
 
 	ImGui::Dummy(ImVec2(0.0f, 20.0f));
@@ -823,6 +825,32 @@ void ImGuiObjectsWindow::draw_objects_panel()
 	bool material_changed = false;
 	static int currently_selected_material = 0;
 
+	HIPRTRenderSettings& render_settings = m_renderer->get_render_settings();
+	if (ImGui::Checkbox("Only reset the pixels of the edited materials", &render_settings.use_partial_material_reset))
+		// The filters of the pixels are only filled from the next reset
+		m_render_window->set_render_dirty(true);
+	ImGuiRenderer::show_help_marker("If enabled, the materials hit by the paths of each pixel are recorded "
+		"and editing a material only resets the accumulation of the pixels whose paths hit that material. "
+		"The other pixels keep converging.\n\n"
+		"Editing an emissive material or the opacity of a material still resets the whole render.\n\n"
+		"Only used if adaptive sampling, the pixel noise threshold or the tile convergence is enabled "
+		"and if the temporal reprojection is disabled.");
+	if (render_settings.use_partial_material_reset)
+	{
+		ImGui::TreePush("Partial material reset tree");
+		if (ImGui::SliderInt("Tracked bounces", &render_settings.partial_material_reset_bounces, 1, render_settings.nb_bounces + 1))
+		{
+			render_settings.partial_material_reset_bounces = std::max(1, render_settings.partial_material_reset_bounces);
+
+			m_render_window->set_render_dirty(true);
+		}
+		ImGuiRenderer::show_help_marker("How many bounces of the paths record the material they hit. 1 is the "
+			"camera ray hit only. The indirect lighting of a material seen only deeper than that in the paths "
+			"of a pixel isn't updated when the material is edited.");
+		ImGui::TreePop();
+	}
+	ImGui::Dummy(ImVec2(0.0f, 20.0f));
+
 	if (ImGui::CollapsingHeader("All objects"))
 	{
 		ImGui::TreePush("All objects tree");
@@ -1040,7 +1068,7 @@ void ImGuiObjectsWindow::draw_objects_panel()
 			ImGuiRenderer::show_help_marker("Abbe number for the dispersion of the glass. The lower the number, the stronger the dispersion.");
 			material_changed |= ImGui::SliderFloat("Dispersion scale", &material.dispersion_scale, 0.0f, 1.0f);
 			ImGui::BeginDisabled(kernel_options->get_macro_value(GPUKernelCompilerOptions::INTERIOR_STACK_STRATEGY) != ISS_WITH_PRIORITIES);
-			material_changed |= ImGui::SliderInt("Dielectric priority", &material.dielectric_priority, 1, StackPriorityEntry::PRIORITY_MAXIMUM);
+			material_changed |= ImGui::SliderInt("Dielectric priority", &material.dielectric_priority, 1, StackEntry::PRIORITY_MAXIMUM);
 			if (kernel_options->get_macro_value(GPUKernelCompilerOptions::INTERIOR_STACK_STRATEGY) != ISS_WITH_PRIORITIES)
 				ImGuiRenderer::show_help_marker("Disabled because not using nested dielectrics with priorities.");
 			ImGui::EndDisabled();
@@ -1159,8 +1187,10 @@ void ImGuiObjectsWindow::draw_objects_panel()
 			material.make_safe();
 			material.precompute_properties();
 
-			m_renderer->update_materials(materials);
-			m_render_window->set_render_dirty(true);
+			// A partial reset resumes a render that had converged. It is still done here only if it reached
+			// its maximum sample count or render time, the reset pixels wouldn't get any sample
+			if (!m_renderer->update_materials(materials) || m_render_window->is_rendering_done())
+				m_render_window->set_render_dirty(true);
 		}
 	}
 
@@ -244,6 +244,46 @@ void ImGuiSettingsWindow::draw_render_settings_panel()
 				}
 			}
 			ImGui::BeginDisabled(!render_settings.accumulate); // Cannot use stopping condition if not accumulating
+			ImGui::SeparatorText("Tile Convergence");
+			if (ImGui::Checkbox("Use tile convergence", &render_settings.use_tile_convergence))
+				m_render_window->set_render_dirty(true);
+			ImGuiRenderer::show_help_marker("If enabled, the image is split in tiles whose noise is estimated by comparing "
+				"the average of all the samples of their pixels with the average of half of the samples. "
+				"The tiles that have converged aren't sampled anymore and the render stops when all the "
+				"tiles have converged.\n\n"
+				"This replaces the \"Pixel proportion\" stopping condition.");
+
+			ImGui::BeginDisabled(!render_settings.use_tile_convergence);
+			{
+				if (ImGui::InputInt("Tile size", &render_settings.convergence_tile_size, 8, 8))
+				{
+					// Multiple of 8 so that the tiles are made of whole GPU blocks
+					render_settings.convergence_tile_size = std::max(8, render_settings.convergence_tile_size / 8 * 8);
+
+					m_render_window->set_render_dirty(true);
+				}
+				if (ImGui::InputFloat("Tile noise threshold", &render_settings.tile_convergence_threshold))
+				{
+					render_settings.tile_convergence_threshold = std::max(0.0f, render_settings.tile_convergence_threshold);
+
+					m_render_window->set_render_dirty(true);
+				}
+				ImGuiRenderer::show_help_marker("Error of a tile, relative to its luminance, under which the tile has converged.");
+				if (ImGui::InputInt("Tile minimum samples", &render_settings.tile_convergence_min_samples))
+				{
+					render_settings.tile_convergence_min_samples = std::max(2, render_settings.tile_convergence_min_samples);
+
+					m_render_window->set_render_dirty(true);
+				}
+
+				if (render_settings.use_tile_convergence)
+				{
+					int2 tile_count = render_settings.get_convergence_tile_count(m_renderer->m_render_resolution);
+					ImGui::Text("Tiles converged: %u / %d", m_renderer->get_status_buffer_values().converged_tile_count, tile_count.x * tile_count.y);
+				}
+			}
+			ImGui::EndDisabled();
+
 			ImGui::SeparatorText("Pixel Stop Noise Threshold");
 			ImGui::Checkbox("Use pixel stop noise threshold stopping condition", &render_settings.enable_pixel_stop_noise_threshold);
 			ImGuiRenderer::show_help_marker("If enabled, stops the renderer after a certain proportion "
@@ -252,7 +292,7 @@ void ImGuiSettingsWindow::draw_render_settings_panel()
 				"enabled, \"converged\" is defined by the \"Pixel noise threshold\" variance "
 				"threshold below.");
 
-			ImGui::BeginDisabled(!render_settings.enable_pixel_stop_noise_threshold);
+			ImGui::BeginDisabled(!render_settings.enable_pixel_stop_noise_threshold || render_settings.use_tile_convergence);
 			{
 				if (ImGui::InputFloat("Pixel proportion", &render_settings.stop_pixel_percentage_converged))
 					render_settings.stop_pixel_percentage_converged = std::max(0.0f, std::min(render_settings.stop_pixel_percentage_converged, 100.0f));
@@ -769,6 +809,26 @@ void ImGuiSettingsWindow::draw_sampling_panel()
 
 				m_render_window->set_render_dirty(true);
 			}
+			// ReSTIR DI needs exactly one sample per pixel per frame, see redistributed_sample_count()
+			bool using_ReSTIR_DI = m_renderer->get_global_compiler_options()->get_macro_value(GPUKernelCompilerOptions::DIRECT_LIGHT_SAMPLING_STRATEGY) == LSS_RESTIR_DI;
+			ImGui::BeginDisabled(using_ReSTIR_DI);
+			if (ImGui::Checkbox("Redistribute samples", &render_settings.adaptive_sampling_redistribute_samples))
+				m_render_window->set_render_dirty(true);
+			ImGuiRenderer::show_help_marker("If checked, the noisiest pixels get several samples per frame and the "
+				"pixels that are almost converged get fewer, for the same total number of samples per frame.\n\n"
+				"If unchecked, adaptive sampling only stops sampling the pixels that have converged.\n\n"
+				"Not available with ReSTIR DI: the additional samples of a pixel would all reuse "
+				"the first hit and the reservoir of the pixel for that frame.");
+			ImGui::BeginDisabled(!render_settings.adaptive_sampling_redistribute_samples);
+			if (ImGui::InputInt("Max samples per pixel per frame", &render_settings.adaptive_sampling_max_samples_per_pass))
+			{
+				render_settings.adaptive_sampling_max_samples_per_pass = std::max(1, std::min(255, render_settings.adaptive_sampling_max_samples_per_pass));
+
+				m_render_window->set_render_dirty(true);
+			}
+			ImGui::EndDisabled();
+			// !ReSTIR DI
+			ImGui::EndDisabled();
 
 			// !Cannot use adaptive sampling without accumulation
 			ImGui::EndDisabled();
@@ -1509,6 +1569,17 @@ void ImGuiSettingsWindow::draw_sampling_panel()
 					m_render_window->set_render_dirty(true);
 				}
 				ImGuiRenderer::show_help_marker("");
+
+				const char* selection_items[] = { "- Sample both", "- Scene power", "- Per hit estimate" };
+				if (ImGui::Combo("Envmap / emissives selection", global_kernel_options->get_raw_pointer_to_macro_value(GPUKernelCompilerOptions::DIRECT_LIGHT_UNIFIED_SELECTION), selection_items, IM_ARRAYSIZE(selection_items)))
+				{
+					m_renderer->recompile_kernels();
+					m_render_window->set_render_dirty(true);
+				}
+				ImGuiRenderer::show_help_marker("How to choose between the envmap and the emissive geometry of the scene "
+					"when sampling direct lighting. Only the chosen one is sampled, which saves its shadow rays.\n\n"
+					"\"Scene power\" compares the envmap to the average power of the emissive geometry.\n"
+					"\"Per hit estimate\" compares the envmap to one random emissive triangle seen from the shading point.");
 			}
 
 			ImGui::Dummy(ImVec2(0.0f, 20.0f));
@@ -1812,6 +1883,19 @@ void ImGuiSettingsWindow::draw_denoiser_panel()
 			m_render_window_denoiser->finalize();
 		}
 		ImGui::EndDisabled();
+
+		HIPRTRenderSettings& render_settings = m_renderer->get_render_settings();
+		if (ImGui::Checkbox("Compact AOVs", &render_settings.use_compact_AOVs))
+			m_render_window->set_render_dirty(true);
+		ImGuiRenderer::show_help_marker("Accumulates the albedo (RGB9E5) and normals (octahedral) AOVs "
+										"in 32 bit per pixel instead of 96 bit per pixel. This reduces "
+										"the memory traffic of the path tracer.\n"
+										"\n"
+										"The AOVs are decoded only when they are needed by the denoiser "
+										"or the display.\n"
+										"\n"
+										"The running average of the AOVs is quantized so it stops improving "
+										"after a few hundred samples. This is invisible after denoising.");
 		ImGui::TreePop();
 	}
 	DisplaySettings& display_settings = m_render_window->get_display_view_system()->get_display_settings();
@@ -2112,6 +2196,8 @@ void ImGuiSettingsWindow::draw_performance_metrics_panel()
 		}
 	}
 	draw_perf_metric_specific_panel(m_render_window_perf_metrics, GPURenderer::PATH_TRACING_KERNEL_ID, "Path Tracing Pass");
+	if (render_settings.use_tile_convergence)
+		draw_perf_metric_specific_panel(m_render_window_perf_metrics, GPURenderer::TILE_CONVERGENCE_KERNEL_ID, "Tile Convergence Pass");
 	ImGui::Separator();
 	draw_perf_metric_specific_panel(m_render_window_perf_metrics, GPURenderer::FULL_FRAME_TIME_KEY, "Total Sample Time");
 
@@ -599,7 +599,14 @@ bool RenderWindow::is_rendering_done()
 	// stop noise threshold feature) --> (enabled & adaptive sampling enabled)
 	bool use_proportion_stopping_condition = (render_settings.stop_pixel_noise_threshold > 0.0f && render_settings.enable_pixel_stop_noise_threshold) 
 		|| (render_settings.enable_pixel_stop_noise_threshold && render_settings.enable_adaptive_sampling);
-	rendering_done |= proportion_converged > render_settings.stop_pixel_percentage_converged && use_proportion_stopping_condition;
+	if (render_settings.use_tile_convergence && render_settings.has_access_to_adaptive_sampling_buffers())
+	{
+		// All the tiles of the image have converged. This replaces the proportion of pixels converged
+		int2 tile_count = render_settings.get_convergence_tile_count(m_renderer->m_render_resolution);
+		rendering_done |= m_renderer->get_status_buffer_values().converged_tile_count == static_cast<unsigned int>(tile_count.x * tile_count.y);
+	}
+	else
+		rendering_done |= proportion_converged > render_settings.stop_pixel_percentage_converged && use_proportion_stopping_condition;
 
 	// Max sample count
 	rendering_done |= (m_application_settings->max_sample_count != 0 && render_settings.sample_number + 1 > m_application_settings->max_sample_count);
@@ -777,13 +784,6 @@ void RenderWindow::render()
 			//// We upload the data to the OpenGL textures for displaying
 			m_display_view_system->upload_relevant_buffers_to_texture();
 
-			// We want the next frame to be displayed with the same 'wants_render_low_resolution' setting
-			// as it was queued with. This is only useful for first frames when getting in low resolution
-			// (when we start moving the camera for example) or first frames when getting out of low resolution
-			// (when we stop moving the camera). In such situations, the last kernel launch in the GPU queue is
-			// a "first frame" that was queued with the corresponding wants_render_low_resolution (getting in or out of low resolution).
-			// and so we want to display it the same way.
-			m_display_view_system->set_render_low_resolution(m_renderer->was_last_frame_low_resolution());
 			// Updating the uniforms so that next time we display, we display correctly
 			m_display_view_system->update_current_display_program_uniforms();
 
@@ -835,7 +835,6 @@ void RenderWindow::render()
 				buffer_upload_necessary = false;
 			}
 
-			m_display_view_system->set_render_low_resolution(m_renderer->was_last_frame_low_resolution());
 			// Updating the uniforms if the user touches the post processing parameters
 			// or something else (denoiser blend, ...)
 			m_display_view_system->update_current_display_program_uniforms();
@@ -850,14 +849,24 @@ void RenderWindow::render()
 				// with this frame
 				renderer_animation_state.frames_rendered_so_far++;
 				if (renderer_animation_state.frames_rendered_so_far == renderer_animation_state.number_of_animation_frames)
+				{
 					// We just rendered the last frame, deactivating rendering frame sequence state
 					renderer_animation_state.is_rendering_frame_sequence = false;
+
+					// The frames are written in the background while the next ones render,
+					// only waiting for the last ones to be on disk once the sequence is done
+					m_screenshoter->wait_for_pending_writes();
+				}
 				else
 				{
 					// Not the last frame
 					renderer_animation_state.can_step_animation = true;
 
 					set_render_dirty(true);
+
+					// The next frame of the sequence is queued right away by the next call to render(),
+					// no sleeping: the PNG of this frame is encoded in the background meanwhile
+					return;
 				}
 
 			}
@@ -946,6 +955,10 @@ bool RenderWindow::denoise()
 			std::shared_ptr<OpenGLInteropBuffer<float3>> normals_buffer = nullptr;
 			std::shared_ptr<OpenGLInteropBuffer<ColorRGB32F>> albedo_buffer = nullptr;
 
+			if (m_application_settings->denoiser_use_normals || m_application_settings->denoiser_use_albedo)
+				// Decoding the AOVs if they were accumulated packed
+				m_renderer->unpack_denoiser_AOVs();
+
 			if (m_application_settings->denoiser_use_normals)
 				normals_buffer = m_renderer->get_denoiser_normals_AOV_buffer();
 
@@ -4,7 +4,6 @@
  */
 
 #include "GL/glew.h"
-#include "stb_image_write.h"
 #include "UI/ImGui/ImGuiLogger.h"
 #include "UI/RenderWindow.h"
 #include "UI/Screenshoter.h"
@@ -160,8 +159,12 @@ void Screenshoter::write_to_png(const char* filepath)
 	std::vector<unsigned char> mapped_data(width * height * 4);
 	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA_INTEGER, GL_UNSIGNED_BYTE, mapped_data.data());
 
-	stbi_flip_vertically_on_write(true);
-	if (stbi_write_png(filepath, width, height, 4, mapped_data.data(), width * sizeof(unsigned char) * 4))
-		g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_INFO, "Screenshot written to \"%s\"", filepath);
+	// The pool takes ownership of the pixels, this may block if too many screenshots are already waiting to be written
+	m_image_writer_pool.write_png(std::move(mapped_data), width, height, 4, filepath, /* flipY */ true);
+}
+
+void Screenshoter::wait_for_pending_writes()
+{
+	m_image_writer_pool.wait_idle();
 }
 
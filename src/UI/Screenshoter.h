@@ -7,6 +7,7 @@
 #define SCREENSHOTER_H
 
 #include "GL/glew.h"
+#include "Image/ImageWriterPool.h"
 #include "OpenGL/OpenGLProgram.h"
 #include "Renderer/GPURenderer.h"
 
@@ -33,11 +34,19 @@ public:
 	 * 03.17.2024 1024sp @ 1280x720.png
 	 * 
 	 * for example
+	 * 
+	 * The image is read back from the GPU synchronously but the PNG encoding
+	 * and the writing to disk happen asynchronously in 'm_image_writer_pool'
 	 */
 	void write_to_png();
 	void write_to_png(const char* filepath);
 	void write_to_png(std::string filepath);
 
+	/**
+	 * Blocks until all the screenshots taken so far are written to disk
+	 */
+	void wait_for_pending_writes();
+
 private:
 	std::shared_ptr<GPURenderer> m_renderer = nullptr;
 	RenderWindow* m_render_window = nullptr;
@@ -54,6 +63,12 @@ private:
 	GLuint m_output_image = 0;
 	int m_compute_output_image_width = -1;
 	int m_compute_output_image_height = -1;
+
+	/**
+	 * Encodes and writes the screenshots in the background so that, when rendering
+	 * frame sequences, the next frame is rendered while the last one is being written
+	 */
+	ImageWriterPool m_image_writer_pool;
 };
 
 #endif
\ No newline at end of file
@@ -29,6 +29,36 @@ CommandlineArguments CommandlineArguments::process_command_line_args(int argc, c
             arguments.render_height = std::atoi(string_argv.substr(4).c_str());
         else if (string_argv.starts_with("--height="))
             arguments.render_height = std::atoi(string_argv.substr(9).c_str());
+        else if (string_argv.starts_with("--preview-denoise-samples="))
+            arguments.preview_denoise_every_n_samples = std::atoi(string_argv.substr(26).c_str());
+        else if (string_argv.starts_with("--preview-denoise-seconds="))
+            arguments.preview_denoise_every_n_seconds = std::atof(string_argv.substr(26).c_str());
+        else if (string_argv.starts_with("--denoise-tile-size="))
+            arguments.denoise_tile_size = std::atoi(string_argv.substr(20).c_str());
+        else if (string_argv.starts_with("--denoise-tile-overlap="))
+            arguments.denoise_tile_overlap = std::atoi(string_argv.substr(23).c_str());
+        else if (string_argv.starts_with("--tonemap="))
+            arguments.tone_map_operator = string_argv.substr(10);
+        else if (string_argv.starts_with("--exposure="))
+            arguments.exposure = std::atof(string_argv.substr(11).c_str());
+        else if (string_argv == "--exr")
+            arguments.write_exr = true;
+        else if (string_argv.starts_with("--exr-compression="))
+            arguments.exr_compression = string_argv.substr(18);
+        else if (string_argv == "--exr-full-float")
+            arguments.exr_full_float = true;
+        else if (string_argv.starts_with("--batch="))
+            arguments.batch_job_file_path = string_argv.substr(8);
+        else if (string_argv.starts_with("--turntable="))
+            arguments.turntable_views = std::atoi(string_argv.substr(12).c_str());
+        else if (string_argv == "--compact-aovs")
+            arguments.compact_AOVs = true;
+        else if (string_argv == "--bake-luts-cpu")
+            arguments.bake_luts_on_cpu = true;
+        else if (string_argv.starts_with("--bake-target-error="))
+            arguments.bake_target_error = std::atof(string_argv.substr(20).c_str());
+        else if (string_argv == "--bake-error-maps")
+            arguments.bake_error_maps = true;
         else
             //Assuming scene file path
             arguments.scene_file_path = string_argv;
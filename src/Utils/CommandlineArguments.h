@@ -24,6 +24,53 @@ struct CommandlineArguments
 
     int render_samples = 64;
     int bounces = 8;
+
+    // If > 0, the CPU renderer hands a snapshot of the framebuffer to a background
+    // denoiser every N samples / seconds. The latest denoised snapshot is written
+    // to disk as a preview while the render continues
+    int preview_denoise_every_n_samples = 0;
+    float preview_denoise_every_n_seconds = 0.0f;
+
+    // If > 0, the final denoising of the CPU renderer is done in tiles
+    // of that size, see OpenImageDenoiser::set_tiling()
+    int denoise_tile_size = 0;
+    int denoise_tile_overlap = 32;
+
+    // Tonemapping of the images written by the CPU renderer.
+    // "none", "exponential", "reinhard" or "aces"
+    std::string tone_map_operator = "exponential";
+    float exposure = 1.0f;
+
+    // If true, the CPU renderer also writes the beauty, the denoised
+    // beauty and the AOVs as the layers of a single EXR file
+    bool write_exr = false;
+    // "none", "zip" or "piz"
+    std::string exr_compression = "zip";
+    // Half float channels if false
+    bool exr_full_float = false;
+
+    // If true, the denoiser AOVs are accumulated in their 32 bit
+    // encodings. See HIPRTRenderSettings::use_compact_AOVs
+    bool compact_AOVs = false;
+
+    // If not empty, the CPU renderer renders all the views of this batch
+    // job file (see BatchRenderJob) instead of the camera of the scene
+    std::string batch_job_file_path = "";
+    // If > 0 and no batch job file is given, the CPU renderer renders that many
+    // views turning around the scene, starting from the camera of the scene
+    int turntable_views = 0;
+
+    // If true, the BRDFs LUTs used by the renderers are baked on the CPU
+    // in the working directory and the application exits without rendering.
+    // Doesn't need a GPU.
+    bool bake_luts_on_cpu = false;
+    // Standard error under which a texel of the LUTs baked on the CPU
+    // is considered converged. 0 to bake with the fixed number of samples
+    // per texel of the bake settings, as the GPU does
+    float bake_target_error = 0.0f;
+    // If true, the standard error of each texel of the LUTs baked
+    // on the CPU is written in a "error_<LUT>" map next to the LUT
+    bool bake_error_maps = false;
 };
 
 #endif
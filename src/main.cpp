@@ -3,9 +3,15 @@
  * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
  */
 
+#include "Image/DisplayPipeline.h"
 #include "Image/Image.h"
+#include "Image/ImageWriterPool.h"
+#include "Image/MultiLayerEXRWriter.h"
+#include "Renderer/Baker/CPUBaker.h"
+#include "Renderer/BatchRenderJob.h"
 #include "Renderer/BVH.h"
 #include "Renderer/CPURenderer.h"
+#include "Renderer/FrameSequencePipeline.h"
 #include "Renderer/GPURenderer.h"
 #include "Scene/Camera.h"
 #include "Scene/SceneParser.h"
@@ -29,6 +35,23 @@ int main(int argc, char* argv[])
 {   
     CommandlineArguments cmd_arguments = CommandlineArguments::process_command_line_args(argc, argv);
 
+    if (cmd_arguments.bake_luts_on_cpu)
+    {
+        // Only rebuilding the LUTs, no scene, no GPU
+        BakeConvergenceSettings convergence_settings;
+        if (cmd_arguments.bake_target_error > 0.0f)
+        {
+            convergence_settings.use_convergence = true;
+            convergence_settings.target_standard_error = cmd_arguments.bake_target_error;
+        }
+        convergence_settings.write_error_maps = cmd_arguments.bake_error_maps;
+
+        CPUBaker cpu_baker(convergence_settings);
+        cpu_baker.bake_all_renderer_luts();
+
+        return 0;
+    }
+
     const int width = cmd_arguments.render_width;
     const int height = cmd_arguments.render_height;
 
@@ -81,23 +104,109 @@ int main(int argc, char* argv[])
     CPURenderer cpu_renderer(width, height);
     cpu_renderer.get_render_settings().nb_bounces = cmd_arguments.bounces;
     cpu_renderer.get_render_settings().samples_per_frame = cmd_arguments.render_samples;
+    cpu_renderer.get_render_settings().use_compact_AOVs = cmd_arguments.compact_AOVs;
     cpu_renderer.set_envmap(envmap_image);
     cpu_renderer.set_camera(parsed_scene.camera);
     cpu_renderer.set_scene(parsed_scene);
 
+    // Only reads the HDR buffers, the framebuffer keeps its accumulated samples
+    DisplayPipelineSettings display_settings;
+    display_settings.exposure = cmd_arguments.exposure;
+    if (!DisplayPipeline::parse_tone_map_operator(cmd_arguments.tone_map_operator, display_settings.tone_map_operator))
+        g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_WARNING, "Unknown tonemapping operator \"%s\". Using exponential.", cmd_arguments.tone_map_operator.c_str());
+    DisplayPipeline display_pipeline(display_settings);
+
+    std::shared_ptr<BackgroundDenoiser> background_denoiser = nullptr;
+    if (cmd_arguments.preview_denoise_every_n_samples > 0 || cmd_arguments.preview_denoise_every_n_seconds > 0.0f)
+    {
+        background_denoiser = std::make_shared<BackgroundDenoiser>(width, height, /* use albedo */ true, /* use normals */ true);
+        background_denoiser->set_denoised_callback([&display_pipeline](const Image32Bit& denoised, int sample_number) {
+            // The denoised snapshots are already divided by their sample count
+            std::vector<unsigned char> tonemapped = display_pipeline.process_to_8bit(reinterpret_cast<const ColorRGB32F*>(denoised.data().data()), denoised.width, denoised.height, 1.0f);
+
+            // Same orientation as the final images. Flipping our own copy, this callback runs
+            // on the thread of the denoiser while other threads may be writing images too
+            flip_image_rows(tonemapped, denoised.width, denoised.height, 3);
+            stbi_write_png("CPU_RT_output_denoised_preview.png", denoised.width, denoised.height, 3, tonemapped.data(), denoised.width * 3);
+        });
+
+        cpu_renderer.set_background_denoiser(background_denoiser, cmd_arguments.preview_denoise_every_n_samples, cmd_arguments.preview_denoise_every_n_seconds);
+    }
+
     stop_full = std::chrono::high_resolution_clock::now();
     std::cout << "Full scene & textures parsed in " << std::chrono::duration_cast<std::chrono::milliseconds>(stop_full - start_full).count() << "ms" << std::endl;
-    cpu_renderer.render();
-    cpu_renderer.tonemap(2.2f, 1.0f);
-
-    Image32Bit image_denoised_1 = Utils::OIDN_denoise(cpu_renderer.get_framebuffer(), width, height, 1.0f);
-    Image32Bit image_denoised_075 = Utils::OIDN_denoise(cpu_renderer.get_framebuffer(), width, height, 0.75f);
-    Image32Bit image_denoised_05 = Utils::OIDN_denoise(cpu_renderer.get_framebuffer(), width, height, 0.5f);
 
-    cpu_renderer.get_framebuffer().write_image_png("CPU_RT_output.png");
-    image_denoised_1.write_image_png("CPU_RT_output_denoised_1.png");
-    image_denoised_075.write_image_png("CPU_RT_output_denoised_075.png");
-    image_denoised_05.write_image_png("CPU_RT_output_denoised_05.png");
+    // Several views of the scene rendered one after the other if a batch
+    // job was given. The scene and the BVH are only loaded / built once
+    BatchRenderJob batch_job;
+    bool batch_rendering = false;
+    if (!cmd_arguments.batch_job_file_path.empty())
+        batch_rendering = BatchRenderJob::load_from_file(cmd_arguments.batch_job_file_path, parsed_scene.camera, parsed_scene.metadata.scene_bounding_box.get_center(), batch_job);
+    else if (cmd_arguments.turntable_views > 0)
+    {
+        batch_job.add_turntable_views(parsed_scene.camera, cmd_arguments.turntable_views, parsed_scene.metadata.scene_bounding_box.get_center());
+        batch_rendering = true;
+    }
+
+    if (!batch_rendering)
+    {
+        BatchRenderView single_view;
+        single_view.name = "CPU_RT_output";
+        single_view.camera = parsed_scene.camera;
+
+        batch_job.add_view(single_view);
+    }
+    else
+        batch_job.get_animation_state().ensure_output_folder_exists();
+
+    FrameSequenceOutputSettings output_settings;
+    output_settings.write_exr = cmd_arguments.write_exr;
+    if (!MultiLayerEXRWriter::parse_compression(cmd_arguments.exr_compression, output_settings.exr_compression))
+    {
+        g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_WARNING, "Unknown EXR compression \"%s\". Using ZIP.", cmd_arguments.exr_compression.c_str());
+        output_settings.exr_compression = MultiLayerEXRWriter::Compression::ZIP;
+    }
+    output_settings.exr_pixel_type = cmd_arguments.exr_full_float ? MultiLayerEXRWriter::PixelType::FLOAT : MultiLayerEXRWriter::PixelType::HALF;
+    output_settings.denoise_tile_size = cmd_arguments.denoise_tile_size;
+    output_settings.denoise_tile_overlap = cmd_arguments.denoise_tile_overlap;
+
+    // The 4 PNGs of a view are encoded in parallel. The pool waits for
+    // all of them to be written when destroyed, after the frame pipeline
+    ImageWriterPool image_writer_pool(/* worker count */ 4);
+    // Denoising, tonemapping and EXR writing of view N while view N + 1 renders
+    FrameSequencePipeline frame_pipeline(width, height, display_pipeline, image_writer_pool, output_settings);
+
+    // The cameras of all the views are already computed by the
+    // batch job so there's nothing to prepare between two views
+    RendererAnimationState& batch_state = batch_job.get_animation_state();
+    for (batch_state.frames_rendered_so_far = 0; batch_state.frames_rendered_so_far < batch_state.number_of_animation_frames; batch_state.frames_rendered_so_far++)
+    {
+        const BatchRenderView& view = batch_job.get_views()[batch_state.frames_rendered_so_far];
+        // The images of a single view are written in the working directory, as they always have been
+        std::string output_prefix = batch_rendering ? batch_job.get_view_filepath("") : view.name;
+
+        if (batch_rendering)
+            g_imgui_logger.add_line(ImGuiLoggerSeverity::IMGUI_LOGGER_INFO, "Rendering view \"%s\" (%d/%d)", view.name.c_str(), batch_state.frames_rendered_so_far + 1, batch_state.number_of_animation_frames);
+
+        Camera view_camera = view.camera;
+        cpu_renderer.set_camera(view_camera);
+        cpu_renderer.get_render_settings().samples_per_frame = view.samples > 0 ? view.samples : cmd_arguments.render_samples;
+        cpu_renderer.get_render_settings().nb_bounces = view.bounces >= 0 ? view.bounces : cmd_arguments.bounces;
+        cpu_renderer.reset();
+
+        cpu_renderer.render();
+        if (background_denoiser != nullptr)
+            // Letting the last preview of this view finish
+            background_denoiser->flush();
+
+        // Only copies the buffers of the renderer, the next view can start rendering right away
+        frame_pipeline.submit_frame(cpu_renderer, output_prefix);
+    }
+
+    frame_pipeline.flush();
+
+    if (background_denoiser != nullptr)
+        cpu_renderer.set_background_denoiser(nullptr, 0, 0.0f);
 #endif
 
     return 0;
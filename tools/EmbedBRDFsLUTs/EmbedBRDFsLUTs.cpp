@@ -0,0 +1,93 @@
+/*
+ * Copyright 2024 Tom Clabault. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+ */
+
+/**
+ * Small build-time tool that converts .hdr LUTs into a C++ header
+ * with one aligned constant array per LUT.
+ *
+ * Usage:
+ *	EmbedBRDFsLUTs <output_header> <array_name> <input.hdr> [<array_name> <input.hdr> ...]
+ *
+ * The LUTs are read with 1 channel and flipped vertically exactly as
+ * Image32Bit::read_image_hdr(filepath, 1, true) would do at runtime.
+ *
+ * For each LUT, the header defines:
+ *	- <array_name>_width
+ *	- <array_name>_height
+ *	- <array_name>[<array_name>_width * <array_name>_height]
+ */
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+static bool write_lut(std::ofstream& output, const std::string& array_name, const std::string& input_filepath)
+{
+	stbi_set_flip_vertically_on_load(true);
+
+	int width, height, read_channels;
+	float* pixels = stbi_loadf(input_filepath.c_str(), &width, &height, &read_channels, 1);
+	if (!pixels)
+	{
+		std::cerr << "Error reading LUT " << input_filepath << ": " << stbi_failure_reason() << std::endl;
+
+		return false;
+	}
+
+	output << "// From " << input_filepath << "\n";
+	output << "static constexpr int " << array_name << "_width = " << width << ";\n";
+	output << "static constexpr int " << array_name << "_height = " << height << ";\n";
+	output << "alignas(64) static constexpr float " << array_name << "[" << width * height << "] =\n{";
+
+	char value_string[32];
+	for (int i = 0; i < width * height; i++)
+	{
+		if (i % 8 == 0)
+			output << "\n\t";
+
+		// 9 significant digits so that the floats round-trip exactly
+		std::snprintf(value_string, sizeof(value_string), "%#.9gf, ", pixels[i]);
+		output << value_string;
+	}
+	output << "\n};\n\n";
+
+	stbi_image_free(pixels);
+
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 4 || (argc - 2) % 2 != 0)
+	{
+		std::cerr << "Usage: " << argv[0] << " <output_header> <array_name> <input.hdr> [<array_name> <input.hdr> ...]" << std::endl;
+
+		return 1;
+	}
+
+	std::ofstream output(argv[1]);
+	if (!output.is_open())
+	{
+		std::cerr << "Unable to open " << argv[1] << " for writing" << std::endl;
+
+		return 1;
+	}
+
+	output << "// Generated by EmbedBRDFsLUTs at build time. Do not edit.\n\n";
+	output << "#ifndef EMBEDDED_BRDFS_LUTS_H\n";
+	output << "#define EMBEDDED_BRDFS_LUTS_H\n\n";
+
+	for (int i = 2; i < argc; i += 2)
+		if (!write_lut(output, argv[i], argv[i + 1]))
+			return 1;
+
+	output << "#endif\n";
+
+	return 0;
+}